@@ -1,8 +1,6 @@
 #include "window.h"
 
-#if QT_VERSION >= 0x060000
-#include <QtOpenGL/QOpenGLVersionFunctionsFactory>
-#endif
+#include <glfunctions.h>
 
 #include <QtGui/QKeyEvent>
 #include <QtCore/QDebug>
@@ -14,23 +12,11 @@ Window::Window()
 
 void Window::initializeGL()
 {
-    if (!context()) {
-        qCritical() << "Can't get OGL context";
-        close();
-        return;
-    }
-
-#if QT_VERSION >= 0x060000
-    m_funcs = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(context());
-#else
-    m_funcs = context()->versionFunctions<QOpenGLFunctions_3_3_Core>();
-#endif
+    m_funcs = resolveCoreFunctions();
     if (!m_funcs) {
-        qCritical() << "Can't get OGL 3.3";
         close();
         return;
     }
-    m_funcs->initializeOpenGLFunctions();
 
     qInfo() << "real OGL version" << reinterpret_cast<const char *>(m_funcs->glGetString(GL_VERSION));
 }
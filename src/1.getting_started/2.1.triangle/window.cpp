@@ -1,11 +1,8 @@
 #include "window.h"
 
-#if QT_VERSION >= 0x060000
-#include <QtOpenGL/QOpenGLVersionFunctionsFactory>
-#endif
+#include <glfunctions.h>
 
 #include <QtGui/QKeyEvent>
-#include <QtCore/QDebug>
 
 const char* const vertexShaderSource =
 "#version 330 core \n"
@@ -35,23 +32,11 @@ Window::Window()
 
 void Window::initializeGL()
 {
-    if (!context()) {
-        qCritical() << "Can't get OGL context";
-        close();
-        return;
-    }
-
-#if QT_VERSION >= 0x060000
-    m_funcs = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(context());
-#else
-    m_funcs = context()->versionFunctions<QOpenGLFunctions_3_3_Core>();
-#endif
+    m_funcs = resolveCoreFunctions();
     if (!m_funcs) {
-        qCritical() << "Can't get OGL 3.2";
         close();
         return;
     }
-    m_funcs->initializeOpenGLFunctions();
 
     initializeGeometry();
     initializeShaders();
@@ -75,7 +60,7 @@ void Window::paintGL()
 
     m_program->bind();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
-    m_funcs->glDrawArrays(GL_TRIANGLES, 0, 3);
+    m_triangle.draw();
     m_program->release();
 }
 
@@ -93,13 +78,7 @@ void Window::initializeGeometry()
     m_vao.create();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
 
-    m_vbo.create();
-    m_vbo.bind();
-    m_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_vbo.allocate(vertices, sizeof(vertices));
-
-    m_funcs->glEnableVertexAttribArray(0);
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), nullptr);
+    m_triangle.create(m_funcs, {3}, vertices);
 }
 
 void Window::initializeShaders()
@@ -1,11 +1,8 @@
 #include "window.h"
 
-#if QT_VERSION >= 0x060000
-#include <QtOpenGL/QOpenGLVersionFunctionsFactory>
-#endif
+#include <glfunctions.h>
 
 #include <QtGui/QKeyEvent>
-#include <QtCore/QDebug>
 
 const char* const vertexShaderSource =
 "#version 330 core \n"
@@ -35,23 +32,11 @@ Window::Window()
 
 void Window::initializeGL()
 {
-    if (!context()) {
-        qCritical() << "Can't get OGL context";
-        close();
-        return;
-    }
-
-#if QT_VERSION >= 0x060000
-    m_funcs = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(context());
-#else
-    m_funcs = context()->versionFunctions<QOpenGLFunctions_3_3_Core>();
-#endif
+    m_funcs = resolveCoreFunctions();
     if (!m_funcs) {
-        qCritical() << "Can't get OGL 3.2";
         close();
         return;
     }
-    m_funcs->initializeOpenGLFunctions();
 
     initializeGeometry();
     initializeShaders();
@@ -75,7 +60,7 @@ void Window::paintGL()
 
     m_program->bind();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
-    m_funcs->glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+    m_rect.draw();
     m_program->release();
 }
 
@@ -89,7 +74,7 @@ void Window::initializeGeometry()
         -0.5f, -0.5f, 0.0f,  // Bottom left corner
         -0.5f,  0.5f, 0.0f   // Top left corner
     };
-    GLuint indices[] = {  // Zero-based indexation
+    GLushort indices[] = {  // Zero-based indexation
         0, 1, 3,   // First triangle
         1, 2, 3    // Second triangle
     };
@@ -97,18 +82,7 @@ void Window::initializeGeometry()
     m_vao.create();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
 
-    m_vbo.create();
-    m_vbo.bind();
-    m_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_vbo.allocate(vertices, sizeof(vertices));
-
-    m_ibo.create();
-    m_ibo.bind();
-    m_ibo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_ibo.allocate(indices, sizeof(indices));
-
-    m_funcs->glEnableVertexAttribArray(0);
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), nullptr);
+    m_rect.create(m_funcs, {3}, vertices, indices);
 }
 
 void Window::initializeShaders()
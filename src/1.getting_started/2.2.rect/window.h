@@ -1,13 +1,14 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
-#include <QOpenGLBuffer>
 #include <QOpenGLFunctions>
 #include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLWindow>
 
+#include <mesh.h>
+
 #include <memory>
 
 class Window : public QOpenGLWindow
@@ -27,8 +28,7 @@ private:
 
 private:
     QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
-    QOpenGLBuffer m_vbo {QOpenGLBuffer::VertexBuffer};
-    QOpenGLBuffer m_ibo {QOpenGLBuffer::IndexBuffer};
+    Mesh m_rect;
     QOpenGLVertexArrayObject m_vao;
     std::unique_ptr<QOpenGLShaderProgram> m_program;
 };
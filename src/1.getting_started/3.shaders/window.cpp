@@ -1,11 +1,9 @@
 #include "window.h"
 
-#if QT_VERSION >= 0x060000
-#include <QtOpenGL/QOpenGLVersionFunctionsFactory>
-#endif
+#include <glfunctions.h>
+#include <programcache.h>
 
 #include <QtGui/QKeyEvent>
-#include <QtCore/QDebug>
 
 Window::Window()
 {
@@ -14,25 +12,12 @@ Window::Window()
 
 void Window::initializeGL()
 {
-    if (!context()) {
-        qCritical() << "Can't get OGL context";
-        close();
-        return;
-    }
-
-#if QT_VERSION >= 0x060000
-    m_funcs = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(context());
-#else
-    m_funcs = context()->versionFunctions<QOpenGLFunctions_3_3_Core>();
-#endif
+    m_funcs = resolveCoreFunctions();
     if (!m_funcs) {
-        qCritical() << "Can't get OGL 3.2";
         close();
         return;
     }
 
-    m_funcs->initializeOpenGLFunctions();
-
     initializeGeometry();
     initializeShaders();
 }
@@ -55,7 +40,7 @@ void Window::paintGL()
 
     m_program->bind();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
-    m_funcs->glDrawArrays(GL_TRIANGLES, 0, 3);
+    m_triangle.draw();
     m_program->release();
 }
 
@@ -73,25 +58,16 @@ void Window::initializeGeometry()
     m_vao.create();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
 
-    m_vbo.create();
-    m_vbo.bind();
-    m_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_vbo.allocate(vertices, sizeof(vertices));
-
-    // Vertexes attribute
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), nullptr);
-    m_funcs->glEnableVertexAttribArray(0);
-    // Colors attribute
-    m_funcs->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), reinterpret_cast<GLvoid *>(3* sizeof(GLfloat)));
-    m_funcs->glEnableVertexAttribArray(1);
+    m_triangle.create(m_funcs, {3, 3}, vertices);
 }
 
 void Window::initializeShaders()
 {
     m_program = std::make_unique<QOpenGLShaderProgram>();
-    m_program->addShaderFromSourceFile(QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl"));
-    m_program->addShaderFromSourceFile(QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl"));
-    m_program->link();
+    ProgramCache::link(m_program.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl")},
+    });
 }
 
 void Window::keyPressEvent(QKeyEvent *event)
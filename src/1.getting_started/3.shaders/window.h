@@ -1,12 +1,13 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
-#include <QOpenGLBuffer>
 #include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLWindow>
 
+#include <mesh.h>
+
 #include <memory>
 
 class Window : public QOpenGLWindow
@@ -26,7 +27,7 @@ private:
 
 private:
     QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
-    QOpenGLBuffer m_vbo {QOpenGLBuffer::VertexBuffer};
+    Mesh m_triangle;
     QOpenGLVertexArrayObject m_vao;
     std::unique_ptr<QOpenGLShaderProgram> m_program;
 };
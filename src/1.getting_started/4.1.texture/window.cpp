@@ -1,8 +1,8 @@
 #include "window.h"
 
-#if QT_VERSION >= 0x060000
-#include <QtOpenGL/QOpenGLVersionFunctionsFactory>
-#endif
+#include <glfunctions.h>
+#include <ktxfile.h>
+#include <programcache.h>
 
 #include <QtGui/QKeyEvent>
 #include <QtCore/QDebug>
@@ -16,25 +16,12 @@ Window::Window()
 
 void Window::initializeGL()
 {
-    if (!context()) {
-        qCritical() << "Can't get OGL context";
-        close();
-        return;
-    }
-
-#if QT_VERSION >= 0x060000
-    m_funcs = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(context());
-#else
-    m_funcs = context()->versionFunctions<QOpenGLFunctions_3_3_Core>();
-#endif
+    m_funcs = resolveCoreFunctions();
     if (!m_funcs) {
-        qCritical() << "Can't get OGL 3.2";
         close();
         return;
     }
 
-    m_funcs->initializeOpenGLFunctions();
-
     initializeGeometry();
     initializeShaders();
     initializeTextures();
@@ -63,7 +50,7 @@ void Window::paintGL()
     m_program->setUniformValue("ourTexture", 0);
 
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
-    m_funcs->glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    m_rect.draw();
 
     // release resources
     m_program->release();
@@ -82,7 +69,7 @@ void Window::initializeGeometry()
         -0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f    // Top left
     };
 
-    GLuint indices[] = {
+    GLushort indices[] = {
         // Zero-based indexation
         0, 1, 3,   // First triangle
         1, 2, 3    // Second triangle
@@ -91,39 +78,23 @@ void Window::initializeGeometry()
     m_vao.create();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
 
-    m_vbo.create();
-    m_vbo.bind();
-    m_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_vbo.allocate(vertices, sizeof(vertices));
-
-    m_ibo.create();
-    m_ibo.bind();
-    m_ibo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_ibo.allocate(indices, sizeof(indices));
-
-    // Vertexes attribute
-    m_funcs->glEnableVertexAttribArray(0);
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), nullptr);
-
-    // Colors attribute
-    m_funcs->glEnableVertexAttribArray(1);
-    m_funcs->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<GLvoid *>(3* sizeof(GLfloat)));
-
-    // Texture attribute
-    m_funcs->glEnableVertexAttribArray(2);
-    m_funcs->glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<GLvoid *>(6 * sizeof(GLfloat)));
+    m_rect.create(m_funcs, {3, 3, 2}, vertices, indices);
 }
 
 void Window::initializeShaders()
 {
     m_program = std::make_unique<QOpenGLShaderProgram>();
-    m_program->addShaderFromSourceFile(QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl"));
-    m_program->addShaderFromSourceFile(QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl"));
-    m_program->link();
+    ProgramCache::link(m_program.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl")},
+    });
 }
 
 void Window::initializeTextures()
 {
+    if (initializeBakedTexture())
+        return;
+
     QImage image(":/container.jpg");
     if (image.isNull()) {
         qCritical() << "Can't load image";
@@ -139,6 +110,27 @@ void Window::initializeTextures()
     m_funcs->glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+bool Window::initializeBakedTexture()
+{
+    KtxFile file;
+    if (!file.open(KtxFile::bakedFileName(":/container.jpg"))
+            || file.format() != KtxFile::Format::RGBA8
+            || file.orientation() != KtxFile::Orientation::Down) {
+        return false;
+    }
+
+    // the mip chain is baked, so there is nothing to decode or generate
+    m_funcs->glGenTextures(1, &m_texture);
+    m_funcs->glBindTexture(GL_TEXTURE_2D, m_texture);
+    for (int i = 0; i < file.levelCount(); ++i) {
+        const auto level = file.level(i);
+        m_funcs->glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, level.data);
+    }
+    m_funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, file.levelCount() - 1);
+    m_funcs->glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
 void Window::keyPressEvent(QKeyEvent *event)
 {
     if (event->key() == Qt::Key_Escape) {
@@ -1,12 +1,13 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
-#include <QOpenGLBuffer>
 #include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLWindow>
 
+#include <mesh.h>
+
 #include <memory>
 
 class Window : public QOpenGLWindow
@@ -24,11 +25,11 @@ private:
     void initializeGeometry();
     void initializeShaders();
     void initializeTextures();
+    bool initializeBakedTexture();
 
 private:
     QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
-    QOpenGLBuffer m_vbo {QOpenGLBuffer::VertexBuffer};
-    QOpenGLBuffer m_ibo {QOpenGLBuffer::IndexBuffer};
+    Mesh m_rect;
     QOpenGLVertexArrayObject m_vao;
     std::unique_ptr<QOpenGLShaderProgram> m_program;
     GLuint m_texture {0};
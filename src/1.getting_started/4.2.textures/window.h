@@ -1,13 +1,15 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
-#include <QOpenGLBuffer>
 #include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLTexture>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLWindow>
 
+#include <mesh.h>
+#include <textureloader.h>
+
 #include <memory>
 
 class Window : public QOpenGLWindow
@@ -29,12 +31,12 @@ private:
 
 private:
     QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
-    QOpenGLBuffer m_vbo {QOpenGLBuffer::VertexBuffer};
-    QOpenGLBuffer m_ibo {QOpenGLBuffer::IndexBuffer};
+    Mesh m_rect;
     QOpenGLVertexArrayObject m_vao;
     std::unique_ptr<QOpenGLShaderProgram> m_program;
-    std::unique_ptr<QOpenGLTexture> m_texture1;
-    std::unique_ptr<QOpenGLTexture> m_texture2;
+    TextureLoader m_textureLoader;
+    QOpenGLTexture *m_texture1 {nullptr};
+    QOpenGLTexture *m_texture2 {nullptr};
 };
 
 #endif // WINDOW_H
@@ -1,13 +1,16 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
-#include <QOpenGLBuffer>
 #include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLTexture>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLWindow>
 
+#include <framescheduler.h>
+#include <mesh.h>
+#include <textureloader.h>
+
 #include <memory>
 
 class Window : public QOpenGLWindow
@@ -21,7 +24,6 @@ protected:
     void resizeGL(int w, int h) override;
     void paintGL() override;
     void keyPressEvent(QKeyEvent *event) override;
-    void timerEvent(QTimerEvent *event) override;
 
 private:
     void initializeGeometry();
@@ -30,13 +32,13 @@ private:
 
 private:
     QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
-    QOpenGLBuffer m_vbo {QOpenGLBuffer::VertexBuffer};
-    QOpenGLBuffer m_ibo {QOpenGLBuffer::IndexBuffer};
+    Mesh m_rect;
     QOpenGLVertexArrayObject m_vao;
     std::unique_ptr<QOpenGLShaderProgram> m_program;
-    std::unique_ptr<QOpenGLTexture> m_texture1;
-    std::unique_ptr<QOpenGLTexture> m_texture2;
-    int m_timer {0};
+    TextureLoader m_textureLoader;
+    QOpenGLTexture *m_texture1 {nullptr};
+    QOpenGLTexture *m_texture2 {nullptr};
+    FrameScheduler m_scheduler;
 };
 
 #endif // WINDOW_H
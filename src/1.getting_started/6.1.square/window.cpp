@@ -1,50 +1,37 @@
 #include "window.h"
 
-#if QT_VERSION >= 0x060000
-#include <QtOpenGL/QOpenGLVersionFunctionsFactory>
-#endif
+#include <glfunctions.h>
+#include <programcache.h>
 
 #include <QtGui/QKeyEvent>
-#include <QtCore/QDebug>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QTime>
 
-Window::Window()
+Window::Window() :
+    m_textureLoader(this),
+    m_scheduler(this, QCoreApplication::arguments())
 {
     resize(640, 480);
 
-    m_timer = startTimer(40);
+    m_scheduler.start();
 }
 
 Window::~Window()
 {
     makeCurrent();
-    m_texture1.reset();
-    m_texture2.reset();
+    m_textureLoader.destroy();
+    m_rect.destroy();
     doneCurrent();
 }
 
 void Window::initializeGL()
 {
-    if (!context()) {
-        qCritical() << "Can't get OGL context";
-        close();
-        return;
-    }
-
-#if QT_VERSION >= 0x060000
-    m_funcs = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(context());
-#else
-    m_funcs = context()->versionFunctions<QOpenGLFunctions_3_3_Core>();
-#endif
+    m_funcs = resolveCoreFunctions();
     if (!m_funcs) {
-        qCritical() << "Can't get OGL 3.2";
         close();
         return;
     }
 
-    m_funcs->initializeOpenGLFunctions();
-
     initializeGeometry();
     initializeShaders();
     initializeTextures();
@@ -64,6 +51,8 @@ void Window::paintGL()
     if (!m_funcs)
         return;
 
+    m_textureLoader.update(m_funcs);
+
     m_funcs->glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     m_funcs->glClear(GL_COLOR_BUFFER_BIT);
 
@@ -82,7 +71,7 @@ void Window::paintGL()
     m_program->setUniformValue("projection", m_projection);
 
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
-    m_funcs->glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    m_rect.draw();
 
     // release resources
     m_program->release();
@@ -99,14 +88,6 @@ void Window::keyPressEvent(QKeyEvent *event)
     QOpenGLWindow::keyPressEvent(event);
 }
 
-void Window::timerEvent(QTimerEvent *event)
-{
-    if (event->timerId() == m_timer) {
-        update();
-    }
-    QOpenGLWindow::timerEvent(event);
-}
-
 void Window::initializeGeometry()
 {
     // setup vertex data
@@ -119,7 +100,7 @@ void Window::initializeGeometry()
         -0.5f,  0.5f, 0.0f, 0.0f, 1.0f    // Top left
     };
 
-    GLuint indices[] = {
+    GLushort indices[] = {
         // Zero-based indexation
         0, 1, 3,   // First triangle
         1, 2, 3    // Second triangle
@@ -128,37 +109,22 @@ void Window::initializeGeometry()
     m_vao.create();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
 
-    m_vbo.create();
-    m_vbo.bind();
-    m_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_vbo.allocate(vertices, sizeof(vertices));
-
-    m_ibo.create();
-    m_ibo.bind();
-    m_ibo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_ibo.allocate(indices, sizeof(indices));
-
-    // Vertexes attribute
-    m_funcs->glEnableVertexAttribArray(0);
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), nullptr);
-
-    // Texture attribute
-    m_funcs->glEnableVertexAttribArray(1);
-    m_funcs->glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), reinterpret_cast<GLvoid *>(3 * sizeof(GLfloat)));
+    m_rect.create(m_funcs, {3, 2}, vertices, indices);
 }
 
 void Window::initializeShaders()
 {
     m_program = std::make_unique<QOpenGLShaderProgram>();
-    m_program->addShaderFromSourceFile(QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl"));
-    m_program->addShaderFromSourceFile(QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl"));
-    m_program->link();
+    ProgramCache::link(m_program.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl")},
+    });
 }
 
 void Window::initializeTextures()
 {
-    m_texture1 = std::make_unique<QOpenGLTexture>(QImage(":/container.jpg"));
-    m_texture2 = std::make_unique<QOpenGLTexture>(QImage(":/awesomeface.png"));
+    m_texture1 = m_textureLoader.load(QStringLiteral(":/container.jpg"));
+    m_texture2 = m_textureLoader.load(QStringLiteral(":/awesomeface.png"));
 }
 
 void Window::initializeMatrixes()
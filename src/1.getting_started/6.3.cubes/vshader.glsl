@@ -2,15 +2,18 @@
 
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec2 texCoord;
+layout (location = 3) in mat4 instanceModel;
 
 out vec2 TexCoord;
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform bool instanced;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(position, 1.0f);
+    mat4 cubeModel = instanced ? instanceModel : model;
+    gl_Position = projection * view * cubeModel * vec4(position, 1.0f);
     TexCoord = vec2(texCoord.x, 1.0f - texCoord.y);
 }
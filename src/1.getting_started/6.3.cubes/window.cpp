@@ -1,49 +1,38 @@
 #include "window.h"
 
-#if QT_VERSION >= 0x060000
-#include <QtOpenGL/QOpenGLVersionFunctionsFactory>
-#endif
+#include <glfunctions.h>
+#include <programcache.h>
 
 #include <QtGui/QKeyEvent>
-#include <QtCore/QDebug>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QTime>
 
-Window::Window()
+Window::Window() :
+    m_textureLoader(this),
+    m_scheduler(this, QCoreApplication::arguments()),
+    m_cubeField(QCoreApplication::arguments())
 {
     resize(640, 480);
 
-    m_timer = startTimer(40);
+    m_scheduler.start();
 }
 
 Window::~Window()
 {
     makeCurrent();
-    m_texture1.reset();
-    m_texture2.reset();
+    m_textureLoader.destroy();
+    m_cubeField.destroy();
+    m_cube.destroy();
     doneCurrent();
 }
 
 void Window::initializeGL()
 {
-    if (!context()) {
-        qCritical() << "Can't get OGL context";
-        close();
-        return;
-    }
-
-#if QT_VERSION >= 0x060000
-    m_funcs = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(context());
-#else
-    m_funcs = context()->versionFunctions<QOpenGLFunctions_3_3_Core>();
-#endif
+    m_funcs = resolveCoreFunctions();
     if (!m_funcs) {
-        qCritical() << "Can't get OGL 3.2";
         close();
         return;
     }
-
-    m_funcs->initializeOpenGLFunctions();
     m_funcs->glEnable(GL_DEPTH_TEST);
 
     initializeGeometry();
@@ -65,6 +54,8 @@ void Window::paintGL()
     if (!m_funcs)
         return;
 
+    m_textureLoader.update(m_funcs);
+
     m_funcs->glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     m_funcs->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -78,17 +69,18 @@ void Window::paintGL()
     m_texture2->bind();
     m_program->setUniformValue("ourTexture2", 1);
 
-    for (int i = 0; i < 10; i++) {
-        QMatrix4x4 model;
-        model.translate(m_cubePositions[i]);
-        model.rotate(20.0 * i, {1.0f, 0.3f, 0.5f});
-
-        m_program->setUniformValue("model", model);
-        m_program->setUniformValue("view", m_view);
-        m_program->setUniformValue("projection", m_projection);
+    m_program->setUniformValue("view", m_view);
+    m_program->setUniformValue("projection", m_projection);
+    m_program->setUniformValue("instanced", m_cubeField.isInstanced());
 
-        QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
-        m_funcs->glDrawArrays(GL_TRIANGLES, 0, 36);
+    QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
+    if (m_cubeField.isInstanced()) {
+        m_cube.drawInstanced(m_cubeField.count());
+    } else {
+        for (const auto &model: m_cubeField.models()) {
+            m_program->setUniformValue("model", model);
+            m_cube.draw();
+        }
     }
 
     // release resources
@@ -102,18 +94,12 @@ void Window::keyPressEvent(QKeyEvent *event)
 {
     if (event->key() == Qt::Key_Escape) {
         close();
+    } else if (event->key() == Qt::Key_I) {
+        m_cubeField.setInstanced(!m_cubeField.isInstanced());
     }
     QOpenGLWindow::keyPressEvent(event);
 }
 
-void Window::timerEvent(QTimerEvent *event)
-{
-    if (event->timerId() == m_timer) {
-        update();
-    }
-    QOpenGLWindow::timerEvent(event);
-}
-
 void Window::initializeGeometry()
 {
     // setup vertex data
@@ -166,46 +152,25 @@ void Window::initializeGeometry()
     m_vao.create();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
 
-    m_vbo.create();
-    m_vbo.bind();
-    m_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_vbo.allocate(vertices, sizeof(vertices));
-
-    // Vertexes attribute
-    m_funcs->glEnableVertexAttribArray(0);
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), nullptr);
-
-    // Texture attribute
-    m_funcs->glEnableVertexAttribArray(1);
-    m_funcs->glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), reinterpret_cast<GLvoid *>(3 * sizeof(GLfloat)));
-    m_vbo.release();
-
-    m_cubePositions = {
-        {0.0f,  0.0f,  0.0f},
-        {2.0f,  5.0f, -15.0f},
-        {-1.5f, -2.2f, -2.5f},
-        {-3.8f, -2.0f, -12.3f},
-        {2.4f, -0.4f, -3.5f},
-        {-1.7f,  3.0f, -7.5f},
-        {1.3f, -2.0f, -2.5f},
-        {1.5f,  2.0f, -2.5f},
-        {1.5f,  0.2f, -1.5f},
-        {-1.3f,  1.0f, -1.5f}
-    };
+    m_cube.create(m_funcs, {3, 2}, vertices);
+
+    // Instance model matrices
+    m_cubeField.createInstanceBuffer(m_funcs, 3);
 }
 
 void Window::initializeShaders()
 {
     m_program = std::make_unique<QOpenGLShaderProgram>();
-    m_program->addShaderFromSourceFile(QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl"));
-    m_program->addShaderFromSourceFile(QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl"));
-    m_program->link();
+    ProgramCache::link(m_program.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl")},
+    });
 }
 
 void Window::initializeTextures()
 {
-    m_texture1 = std::make_unique<QOpenGLTexture>(QImage(":/container.jpg"));
-    m_texture2 = std::make_unique<QOpenGLTexture>(QImage(":/awesomeface.png"));
+    m_texture1 = m_textureLoader.load(QStringLiteral(":/container.jpg"));
+    m_texture2 = m_textureLoader.load(QStringLiteral(":/awesomeface.png"));
 }
 
 void Window::initializeMatrixes()
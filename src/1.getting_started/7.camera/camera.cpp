@@ -34,7 +34,6 @@ Camera::Camera(QObjectPointer parent)
     : QObject(parent)
 {
     CheckIfProcessTrusted();
-    m_timer = startTimer(25);
 }
 
 void Camera::setWindow(QWindowPointer window)
@@ -97,6 +96,9 @@ bool Camera::eventFilter(QObject *watched, QEvent *event)
         case QEvent::FocusOut:
             focusOutEvent(static_cast<QFocusEvent *>(event));
             break;
+        case QEvent::MouseButtonPress:
+            mousePressEvent(static_cast<QMouseEvent *>(event));
+            break;
         case QEvent::MouseMove:
             mouseMoveEvent(static_cast<QMouseEvent *>(event));
             break;
@@ -110,15 +112,51 @@ bool Camera::eventFilter(QObject *watched, QEvent *event)
     return false;
 }
 
-void Camera::timerEvent(QTimerEvent *event)
+QVector3D Camera::rayDirection(const QPointF &windowPosition) const
 {
-    if (event->timerId() == m_timer) {
-        updateMatrixes();
-        if (m_window) {
-            m_window->requestUpdate();
-        }
+    if (!m_window)
+        return m_cameraFront;
+
+    // window y points down, NDC y points up
+    const auto x = 2.0f * float(windowPosition.x()) / m_window->width() - 1.0f;
+    const auto y = 1.0f - 2.0f * float(windowPosition.y()) / m_window->height();
+    const auto inverse = (m_projection * m_view).inverted();
+    const auto nearPoint = inverse.map(QVector3D(x, y, -1.0f));
+    const auto farPoint = inverse.map(QVector3D(x, y, 1.0f));
+    return (farPoint - nearPoint).normalized();
+}
+
+void Camera::advance(float seconds)
+{
+    m_previousPos = m_cameraPos;
+
+    const QVector3D cameraUp {0.0f, 1.0f,  0.0f};
+    const auto distance = m_cameraSpeed * seconds;
+
+    if (m_keyPressed[Forward]) {
+        m_cameraPos += distance * m_cameraFront;
+    }
+    if (m_keyPressed[Backward]) {
+        m_cameraPos -= distance * m_cameraFront;
+    }
+    if (m_keyPressed[Left]) {
+        m_cameraPos -= QVector3D::crossProduct(m_cameraFront, cameraUp).normalized() * distance;
+    }
+    if (m_keyPressed[Right]) {
+        m_cameraPos += QVector3D::crossProduct(m_cameraFront, cameraUp).normalized() * distance;
+    }
+    if (m_keyPressed[Up]) {
+        m_cameraPos += distance * cameraUp;
+    }
+    if (m_keyPressed[Down]) {
+        m_cameraPos -= distance * cameraUp;
     }
-    QObject::timerEvent(event);
+}
+
+void Camera::interpolate(float alpha)
+{
+    m_viewPos = m_previousPos + (m_cameraPos - m_previousPos) * alpha;
+    updateMatrixes();
 }
 
 void Camera::keyPressEvent(QKeyEvent *event)
@@ -173,6 +211,12 @@ void Camera::focusOutEvent(QFocusEvent *event)
     }
 }
 
+void Camera::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+        emit clicked(m_viewPos, rayDirection(event->position()));
+}
+
 void Camera::mouseMoveEvent(QMouseEvent *event)
 {
     if (!m_blockMove) {
@@ -218,27 +262,6 @@ void Camera::updateMatrixes()
         return;
     }
 
-    QVector3D cameraUp {0.0f, 1.0f,  0.0f};
-
-    if (m_keyPressed[Forward]) {
-        m_cameraPos += m_cameraSpeed * m_cameraFront;
-    }
-    if (m_keyPressed[Backward]) {
-        m_cameraPos -= m_cameraSpeed * m_cameraFront;
-    }
-    if (m_keyPressed[Left]) {
-        m_cameraPos -= QVector3D::crossProduct(m_cameraFront, cameraUp).normalized() * m_cameraSpeed;
-    }
-    if (m_keyPressed[Right]) {
-        m_cameraPos += QVector3D::crossProduct(m_cameraFront, cameraUp).normalized() * m_cameraSpeed;
-    }
-    if (m_keyPressed[Up]) {
-        m_cameraPos += m_cameraSpeed * cameraUp;
-    }
-    if (m_keyPressed[Down]) {
-        m_cameraPos -= m_cameraSpeed * cameraUp;
-    }
-
-    m_view.lookAt(m_cameraPos, m_cameraPos + m_cameraFront, {0.0f, 1.0f, 0.0f});
+    m_view.lookAt(m_viewPos, m_viewPos + m_cameraFront, {0.0f, 1.0f, 0.0f});
     m_projection.perspective(m_fov, 1.0 * m_window->width() / m_window->height(), 0.1, 100.0);
 }
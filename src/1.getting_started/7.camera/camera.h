@@ -8,6 +8,7 @@ class QWindow;
 class QKeyEvent;
 class QFocusEvent;
 class QMouseEvent;
+class QPointF;
 class QWheelEvent;
 
 using QObjectPointer = QObject *;
@@ -41,24 +42,32 @@ public:
     float sensitivity() const noexcept { return m_sensitivity; }
     void setSensitivity(float sensitivity);
 
-    QVector3D position() const noexcept { return m_cameraPos; }
+    QVector3D position() const noexcept { return m_viewPos; }
     QVector3D front() const noexcept { return m_cameraFront; }
 
+    // Normalized world-space direction of the ray from position() through a point of the window
+    QVector3D rayDirection(const QPointF &windowPosition) const;
+
+    // Moves the camera by cameraSpeed units per second, connect to FrameScheduler::step
+    void advance(float seconds);
+    // Interpolates the view between the last two positions, connect to FrameScheduler::frame
+    void interpolate(float alpha);
+
     bool eventFilter(QObject *watched, QEvent *event) override;
 
 signals:
     void windowChanged(QWindowPointer window);
     void cameraSpeedChanged(float);
     void sensitivityChanged(float);
-
-protected:
-    void timerEvent(QTimerEvent *event) override;
+    // Emitted on a left click with the ray through the cursor, e.g. for picking
+    void clicked(const QVector3D &origin, const QVector3D &direction);
 
 private:
     void keyPressEvent(QKeyEvent *event);
     void keyReleaseEvent(QKeyEvent *event);
     void focusInEvent(QFocusEvent *event);
     void focusOutEvent(QFocusEvent *event);
+    void mousePressEvent(QMouseEvent *event);
     void mouseMoveEvent(QMouseEvent *event);
     void wheelEvent(QWheelEvent *event);
     void updateMatrixes();
@@ -77,17 +86,17 @@ private:
     QWindowPointer m_window {nullptr};
     QMatrix4x4 m_view;
     QMatrix4x4 m_projection;
-    float m_cameraSpeed = 0.05f;
+    float m_cameraSpeed = 2.0f;
     float m_sensitivity = 0.075f;
 
-    int m_timer {0};
-
     bool m_keyPressed[KeyCount] {false, false, false, false};
     float m_yaw = -90.0f;
     float m_pitch = 0.0f;
     float m_fov {45.0};
 
     QVector3D m_cameraPos {0.0f, 0.0f,  3.0f};
+    QVector3D m_previousPos {m_cameraPos};
+    QVector3D m_viewPos {m_cameraPos};
     QVector3D m_cameraFront {0.0f, 0.0f, -1.0f};
 
     bool m_blockMove {false};
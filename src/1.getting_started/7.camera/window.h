@@ -1,13 +1,18 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
-#include <QOpenGLBuffer>
 #include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLTexture>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLWindow>
 
+#include <cubefield.h>
+#include <entityworld.h>
+#include <framescheduler.h>
+#include <mesh.h>
+#include <textureloader.h>
+
 #include <memory>
 
 class Camera;
@@ -32,12 +37,15 @@ private:
 private:
     QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
     std::unique_ptr<Camera> m_camera;
-    QOpenGLBuffer m_vbo {QOpenGLBuffer::VertexBuffer};
+    FrameScheduler m_scheduler;
+    Mesh m_cube;
     QOpenGLVertexArrayObject m_vao;
     std::unique_ptr<QOpenGLShaderProgram> m_program;
-    std::unique_ptr<QOpenGLTexture> m_texture1;
-    std::unique_ptr<QOpenGLTexture> m_texture2;
-    std::vector<QVector3D> m_cubePositions;
+    TextureLoader m_textureLoader;
+    QOpenGLTexture *m_texture1 {nullptr};
+    QOpenGLTexture *m_texture2 {nullptr};
+    CubeField m_cubeField;
+    EntityWorld m_world;
 };
 
 #endif // WINDOW_H
@@ -1,12 +1,14 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
-#include <QOpenGLBuffer>
 #include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLWindow>
 
+#include <framescheduler.h>
+#include <mesh.h>
+
 #include <memory>
 
 class Camera;
@@ -33,9 +35,9 @@ private:
 private:
     QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
     std::unique_ptr<Camera> m_camera;
-    QOpenGLBuffer m_vbo {QOpenGLBuffer::VertexBuffer};
+    FrameScheduler m_scheduler;
+    Mesh m_cube;
     QOpenGLVertexArrayObject m_vao;
-    QOpenGLBuffer m_lampVbo {QOpenGLBuffer::VertexBuffer};
     QOpenGLVertexArrayObject m_lampVao;
     std::unique_ptr<QOpenGLShaderProgram> m_program;
     std::unique_ptr<QOpenGLShaderProgram> m_lampProgram;
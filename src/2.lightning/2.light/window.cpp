@@ -1,13 +1,12 @@
 #include "window.h"
 #include <camera.h>
 
-#if QT_VERSION >= 0x060000
-#include <QtOpenGL/QOpenGLVersionFunctionsFactory>
-#endif
+#include <glfunctions.h>
+#include <programcache.h>
 
 #include <QtGui/QKeyEvent>
 
-#include <QtCore/QDebug>
+#include <QtCore/QCoreApplication>
 
 namespace {
 
@@ -60,39 +59,32 @@ constexpr const GLfloat vertices[] = {
 } // namespace
 
 Window::Window() :
-    m_camera(std::make_unique<Camera>())
+    m_camera(std::make_unique<Camera>()),
+    m_scheduler(this, QCoreApplication::arguments())
 {
     resize(640, 480);
 
     m_camera->setWindow(this);
+
+    connect(&m_scheduler, &FrameScheduler::step, m_camera.get(), &Camera::advance);
+    connect(&m_scheduler, &FrameScheduler::frame, m_camera.get(), &Camera::interpolate);
+    m_scheduler.start();
 }
 
 Window::~Window()
 {
     makeCurrent();
+    m_cube.destroy();
     doneCurrent();
 }
 
 void Window::initializeGL()
 {
-    if (!context()) {
-        qCritical() << "Can't get OGL context";
-        close();
-        return;
-    }
-
-#if QT_VERSION >= 0x060000
-    m_funcs = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(context());
-#else
-    m_funcs = context()->versionFunctions<QOpenGLFunctions_3_3_Core>();
-#endif
+    m_funcs = resolveCoreFunctions();
     if (!m_funcs) {
-        qCritical() << "Can't get OGL 3.2";
         close();
         return;
     }
-
-    m_funcs->initializeOpenGLFunctions();
     m_funcs->glEnable(GL_DEPTH_TEST);
 
     initializeCubeGeometry();
@@ -134,19 +126,7 @@ void Window::initializeCubeGeometry()
     m_vao.create();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
 
-    m_vbo.create();
-    m_vbo.bind();
-    m_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_vbo.allocate(vertices, sizeof(vertices));
-
-    // Vertexes attribute
-    m_funcs->glEnableVertexAttribArray(0);
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), nullptr);
-
-    // Normals attribute
-    m_funcs->glEnableVertexAttribArray(1);
-    m_funcs->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), reinterpret_cast<GLvoid *>(3 * sizeof(GLfloat)));
-    m_vbo.release();
+    m_cube.create(m_funcs, {3, 3}, vertices);
 }
 
 void Window::initializeLampGeometry()
@@ -154,27 +134,22 @@ void Window::initializeLampGeometry()
     m_lampVao.create();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_lampVao);
 
-    m_lampVbo.create();
-    m_lampVbo.bind();
-    m_lampVbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_lampVbo.allocate(vertices, sizeof(vertices));
-
-    // Vertexes attribute
-    m_funcs->glEnableVertexAttribArray(0);
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), nullptr);
+    m_cube.setupAttributes();
 }
 
 void Window::initializeShaders()
 {
     m_program = std::make_unique<QOpenGLShaderProgram>();
-    m_program->addShaderFromSourceFile(QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl"));
-    m_program->addShaderFromSourceFile(QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl"));
-    m_program->link();
+    ProgramCache::link(m_program.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl")},
+    });
 
     m_lampProgram = std::make_unique<QOpenGLShaderProgram>();
-    m_lampProgram->addShaderFromSourceFile(QOpenGLShader::Vertex, QStringLiteral(":/vlamp.glsl"));
-    m_lampProgram->addShaderFromSourceFile(QOpenGLShader::Fragment, QStringLiteral(":/flamp.glsl"));
-    m_lampProgram->link();
+    ProgramCache::link(m_lampProgram.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vlamp.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/flamp.glsl")},
+    });
 }
 
 void Window::paintCube()
@@ -192,7 +167,7 @@ void Window::paintCube()
     m_program->setUniformValue("model", QMatrix4x4());
 
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
-    m_funcs->glDrawArrays(GL_TRIANGLES, 0, 36);
+    m_cube.draw();
 
     // release resources
     m_program->release();
@@ -210,7 +185,7 @@ void Window::paintLamp()
     model.scale({0.2f, 0.2f, 0.2f});
     m_lampProgram->setUniformValue("model", model);
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_lampVao);
-    m_funcs->glDrawArrays(GL_TRIANGLES, 0, 36);
+    m_cube.draw();
 
     // release resources
     m_lampProgram->release();
@@ -1,13 +1,12 @@
 #include "window.h"
 #include <camera.h>
 
-#if QT_VERSION >= 0x060000
-#include <QtOpenGL/QOpenGLVersionFunctionsFactory>
-#endif
+#include <glfunctions.h>
+#include <programcache.h>
 
 #include <QtGui/QKeyEvent>
 
-#include <QtCore/QDebug>
+#include <QtCore/QCoreApplication>
 #include <QtCore/QTime>
 
 #include <cmath>
@@ -63,39 +62,32 @@ constexpr const GLfloat vertices[] = {
 } // namespace
 
 Window::Window() :
-    m_camera(std::make_unique<Camera>())
+    m_camera(std::make_unique<Camera>()),
+    m_scheduler(this, QCoreApplication::arguments())
 {
     resize(640, 480);
 
     m_camera->setWindow(this);
+
+    connect(&m_scheduler, &FrameScheduler::step, m_camera.get(), &Camera::advance);
+    connect(&m_scheduler, &FrameScheduler::frame, m_camera.get(), &Camera::interpolate);
+    m_scheduler.start();
 }
 
 Window::~Window()
 {
     makeCurrent();
+    m_cube.destroy();
     doneCurrent();
 }
 
 void Window::initializeGL()
 {
-    if (!context()) {
-        qCritical() << "Can't get OGL context";
-        close();
-        return;
-    }
-
-#if QT_VERSION >= 0x060000
-    m_funcs = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(context());
-#else
-    m_funcs = context()->versionFunctions<QOpenGLFunctions_3_3_Core>();
-#endif
+    m_funcs = resolveCoreFunctions();
     if (!m_funcs) {
-        qCritical() << "Can't get OGL 3.2";
         close();
         return;
     }
-
-    m_funcs->initializeOpenGLFunctions();
     m_funcs->glEnable(GL_DEPTH_TEST);
 
     initializeCubeGeometry();
@@ -137,19 +129,7 @@ void Window::initializeCubeGeometry()
     m_vao.create();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
 
-    m_vbo.create();
-    m_vbo.bind();
-    m_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_vbo.allocate(vertices, sizeof(vertices));
-
-    // Vertexes attribute
-    m_funcs->glEnableVertexAttribArray(0);
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), nullptr);
-
-    // Normals attribute
-    m_funcs->glEnableVertexAttribArray(1);
-    m_funcs->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), reinterpret_cast<GLvoid *>(3 * sizeof(GLfloat)));
-    m_vbo.release();
+    m_cube.create(m_funcs, {3, 3}, vertices);
 }
 
 void Window::initializeLampGeometry()
@@ -157,43 +137,56 @@ void Window::initializeLampGeometry()
     m_lampVao.create();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_lampVao);
 
-    m_lampVbo.create();
-    m_lampVbo.bind();
-    m_lampVbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_lampVbo.allocate(vertices, sizeof(vertices));
-
-    // Vertexes attribute
-    m_funcs->glEnableVertexAttribArray(0);
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), nullptr);
+    m_cube.setupAttributes();
 }
 
 void Window::initializeShaders()
 {
     m_program = std::make_unique<QOpenGLShaderProgram>();
-    m_program->addShaderFromSourceFile(QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl"));
-    m_program->addShaderFromSourceFile(QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl"));
-    m_program->link();
+    ProgramCache::link(m_program.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl")},
+    });
+    m_uniforms.resolve(m_program.get(), {{
+        "view",
+        "projection",
+        "viewPos",
+        "material.ambient",
+        "material.diffuse",
+        "material.specular",
+        "material.shininess",
+        "light.ambient",
+        "light.diffuse",
+        "light.specular",
+        "light.position",
+        "model",
+    }});
 
     m_lampProgram = std::make_unique<QOpenGLShaderProgram>();
-    m_lampProgram->addShaderFromSourceFile(QOpenGLShader::Vertex, QStringLiteral(":/vlamp.glsl"));
-    m_lampProgram->addShaderFromSourceFile(QOpenGLShader::Fragment, QStringLiteral(":/flamp.glsl"));
-    m_lampProgram->link();
+    ProgramCache::link(m_lampProgram.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vlamp.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/flamp.glsl")},
+    });
+    m_lampUniforms.resolve(m_lampProgram.get(), {{
+        "view",
+        "projection",
+        "model",
+    }});
 }
 
 void Window::paintCube()
 {
     m_program->bind();
 
-    m_program->setUniformValue("view", m_camera->view());
-    m_program->setUniformValue("projection", m_camera->projection());
+    m_program->setUniformValue(m_uniforms[Uniform::View], m_camera->view());
+    m_program->setUniformValue(m_uniforms[Uniform::Projection], m_camera->projection());
 
-    m_program->setUniformValue("objectColor", QVector3D(1.0f, 0.5f, 0.31f));
-    m_program->setUniformValue("viewPos", m_camera->position());
+    m_program->setUniformValue(m_uniforms[Uniform::ViewPos], m_camera->position());
 
-    m_program->setUniformValue("material.ambient",  QVector3D(1.0f, 0.5f, 0.31f));
-    m_program->setUniformValue("material.diffuse",  QVector3D(1.0f, 0.5f, 0.31f));
-    m_program->setUniformValue("material.specular", QVector3D(0.5f, 0.5f, 0.5f));
-    m_program->setUniformValue("material.shininess", 32.0f);
+    m_program->setUniformValue(m_uniforms[Uniform::MaterialAmbient],  QVector3D(1.0f, 0.5f, 0.31f));
+    m_program->setUniformValue(m_uniforms[Uniform::MaterialDiffuse],  QVector3D(1.0f, 0.5f, 0.31f));
+    m_program->setUniformValue(m_uniforms[Uniform::MaterialSpecular], QVector3D(0.5f, 0.5f, 0.5f));
+    m_program->setUniformValue(m_uniforms[Uniform::MaterialShininess], 32.0f);
 
     const auto time = QTime::currentTime();
     const auto angle = radians(((time.second() * 1000 + time.msec()) % 10000) / 10000.0 * 360.0);
@@ -202,15 +195,15 @@ void Window::paintCube()
                                       sin(angle * 1.3f) / 2.0 + 0.5);
     const auto diffuseColor = lightColor * QVector3D(0.5f, 0.5f, 0.5f); // decrease the influence
     const auto ambientColor = diffuseColor * QVector3D(0.2f, 0.2f, 0.2f); // low influence
-    m_program->setUniformValue("light.ambient", ambientColor);
-    m_program->setUniformValue("light.diffuse", diffuseColor);
-    m_program->setUniformValue("light.specular", QVector3D(1.0f, 1.0f, 1.0f));
-    m_program->setUniformValue("light.position", m_lightPos);
+    m_program->setUniformValue(m_uniforms[Uniform::LightAmbient], ambientColor);
+    m_program->setUniformValue(m_uniforms[Uniform::LightDiffuse], diffuseColor);
+    m_program->setUniformValue(m_uniforms[Uniform::LightSpecular], QVector3D(1.0f, 1.0f, 1.0f));
+    m_program->setUniformValue(m_uniforms[Uniform::LightPosition], m_lightPos);
 
-    m_program->setUniformValue("model", QMatrix4x4());
+    m_program->setUniformValue(m_uniforms[Uniform::Model], QMatrix4x4());
 
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
-    m_funcs->glDrawArrays(GL_TRIANGLES, 0, 36);
+    m_cube.draw();
 
     // release resources
     m_program->release();
@@ -220,15 +213,15 @@ void Window::paintLamp()
 {
     m_lampProgram->bind();
 
-    m_lampProgram->setUniformValue("view", m_camera->view());
-    m_lampProgram->setUniformValue("projection", m_camera->projection());
+    m_lampProgram->setUniformValue(m_lampUniforms[LampUniform::View], m_camera->view());
+    m_lampProgram->setUniformValue(m_lampUniforms[LampUniform::Projection], m_camera->projection());
 
     QMatrix4x4 model;
     model.translate(m_lightPos);
     model.scale({0.2f, 0.2f, 0.2f});
-    m_lampProgram->setUniformValue("model", model);
+    m_lampProgram->setUniformValue(m_lampUniforms[LampUniform::Model], model);
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_lampVao);
-    m_funcs->glDrawArrays(GL_TRIANGLES, 0, 36);
+    m_cube.draw();
 
     // release resources
     m_lampProgram->release();
@@ -1,12 +1,15 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
-#include <QOpenGLBuffer>
 #include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLWindow>
 
+#include <framescheduler.h>
+#include <mesh.h>
+#include <uniformtable.h>
+
 #include <memory>
 
 class Camera;
@@ -31,15 +34,40 @@ private:
     void paintLamp();
 
 private:
+    enum class Uniform {
+        View,
+        Projection,
+        ViewPos,
+        MaterialAmbient,
+        MaterialDiffuse,
+        MaterialSpecular,
+        MaterialShininess,
+        LightAmbient,
+        LightDiffuse,
+        LightSpecular,
+        LightPosition,
+        Model,
+        Count
+    };
+
+    enum class LampUniform {
+        View,
+        Projection,
+        Model,
+        Count
+    };
+
     QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
     std::unique_ptr<Camera> m_camera;
-    QOpenGLBuffer m_vbo {QOpenGLBuffer::VertexBuffer};
+    FrameScheduler m_scheduler;
+    Mesh m_cube;
     QOpenGLVertexArrayObject m_vao;
-    QOpenGLBuffer m_lampVbo {QOpenGLBuffer::VertexBuffer};
     QOpenGLVertexArrayObject m_lampVao;
     QVector3D m_lightPos {1.2f, 1.0f, 2.0f};
     std::unique_ptr<QOpenGLShaderProgram> m_program;
     std::unique_ptr<QOpenGLShaderProgram> m_lampProgram;
+    UniformLocations<Uniform> m_uniforms;
+    UniformLocations<LampUniform> m_lampUniforms;
 };
 
 #endif // WINDOW_H
@@ -1,13 +1,12 @@
 #include "window.h"
 #include <camera.h>
 
-#if QT_VERSION >= 0x060000
-#include <QtOpenGL/QOpenGLVersionFunctionsFactory>
-#endif
+#include <glfunctions.h>
+#include <programcache.h>
 
 #include <QtGui/QKeyEvent>
 
-#include <QtCore/QDebug>
+#include <QtCore/QCoreApplication>
 
 namespace {
 
@@ -61,41 +60,35 @@ constexpr const GLfloat vertices[] = {
 } // namespace
 
 Window::Window() :
-    m_camera(std::make_unique<Camera>())
+    m_camera(std::make_unique<Camera>()),
+    m_scheduler(this, QCoreApplication::arguments()),
+    m_cube(Mesh::vertexFormat(QCoreApplication::arguments())),
+    m_textureLoader(this)
 {
     resize(640, 480);
 
     m_camera->setWindow(this);
+
+    connect(&m_scheduler, &FrameScheduler::step, m_camera.get(), &Camera::advance);
+    connect(&m_scheduler, &FrameScheduler::frame, m_camera.get(), &Camera::interpolate);
+    m_scheduler.start();
 }
 
 Window::~Window()
 {
     makeCurrent();
-    m_texture->destroy();
-    m_textureSpecular->destroy();
+    m_textureLoader.destroy();
+    m_cube.destroy();
     doneCurrent();
 }
 
 void Window::initializeGL()
 {
-    if (!context()) {
-        qCritical() << "Can't get OGL context";
-        close();
-        return;
-    }
-
-#if QT_VERSION >= 0x060000
-    m_funcs = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(context());
-#else
-    m_funcs = context()->versionFunctions<QOpenGLFunctions_3_3_Core>();
-#endif
+    m_funcs = resolveCoreFunctions();
     if (!m_funcs) {
-        qCritical() << "Can't get OGL 3.2";
         close();
         return;
     }
-
-    m_funcs->initializeOpenGLFunctions();
     m_funcs->glEnable(GL_DEPTH_TEST);
 
     initializeCubeGeometry();
@@ -119,6 +112,8 @@ void Window::paintGL()
         return;
     }
 
+    m_textureLoader.update(m_funcs);
+
     m_funcs->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     paintCube();
@@ -138,23 +133,7 @@ void Window::initializeCubeGeometry()
     m_vao.create();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
 
-    m_vbo.create();
-    m_vbo.bind();
-    m_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_vbo.allocate(vertices, sizeof(vertices));
-
-    // Vertexes attribute
-    m_funcs->glEnableVertexAttribArray(0);
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), nullptr);
-
-    // Normals attribute
-    m_funcs->glEnableVertexAttribArray(1);
-    m_funcs->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<GLvoid *>(3 * sizeof(GLfloat)));
-
-    m_funcs->glEnableVertexAttribArray(2);
-    m_funcs->glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<GLvoid *>(6 * sizeof(GLfloat)));
-
-    m_vbo.release();
+    m_cube.create(m_funcs, vertices);
 }
 
 void Window::initializeLampGeometry()
@@ -162,65 +141,77 @@ void Window::initializeLampGeometry()
     m_lampVao.create();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_lampVao);
 
-    m_lampVbo.create();
-    m_lampVbo.bind();
-    m_lampVbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_lampVbo.allocate(vertices, sizeof(vertices));
-
-    // Vertexes attribute
-    m_funcs->glEnableVertexAttribArray(0);
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), nullptr);
+    m_cube.setupAttributes();
 }
 
 void Window::initializeShaders()
 {
     m_program = std::make_unique<QOpenGLShaderProgram>();
-    m_program->addShaderFromSourceFile(QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl"));
-    m_program->addShaderFromSourceFile(QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl"));
-    m_program->link();
+    ProgramCache::link(m_program.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl")},
+    });
+    m_uniforms.resolve(m_program.get(), {{
+        "view",
+        "projection",
+        "viewPos",
+        "material.diffuse",
+        "material.specular",
+        "material.shininess",
+        "light.ambient",
+        "light.diffuse",
+        "light.specular",
+        "light.position",
+        "model",
+    }});
 
     m_lampProgram = std::make_unique<QOpenGLShaderProgram>();
-    m_lampProgram->addShaderFromSourceFile(QOpenGLShader::Vertex, QStringLiteral(":/vlamp.glsl"));
-    m_lampProgram->addShaderFromSourceFile(QOpenGLShader::Fragment, QStringLiteral(":/flamp.glsl"));
-    m_lampProgram->link();
+    ProgramCache::link(m_lampProgram.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vlamp.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/flamp.glsl")},
+    });
+    m_lampUniforms.resolve(m_lampProgram.get(), {{
+        "view",
+        "projection",
+        "model",
+    }});
 }
 
 void Window::initializeTextures()
 {
-    m_texture = std::make_unique<QOpenGLTexture>(QImage(":/container2.png").mirrored());
-    m_textureSpecular = std::make_unique<QOpenGLTexture>(QImage(":/container2_specular.png").mirrored());
+    m_texture = m_textureLoader.load(QStringLiteral(":/container2.png"), TextureLoader::Mirrored);
+    m_textureSpecular = m_textureLoader.load(QStringLiteral(":/container2_specular.png"), TextureLoader::Mirrored,
+                                             qRgb(0, 0, 0));
 }
 
 void Window::paintCube()
 {
     m_program->bind();
 
-    m_program->setUniformValue("view", m_camera->view());
-    m_program->setUniformValue("projection", m_camera->projection());
+    m_program->setUniformValue(m_uniforms[Uniform::View], m_camera->view());
+    m_program->setUniformValue(m_uniforms[Uniform::Projection], m_camera->projection());
 
-    m_program->setUniformValue("objectColor", QVector3D(1.0f, 0.5f, 0.31f));
-    m_program->setUniformValue("viewPos", m_camera->position());
+    m_program->setUniformValue(m_uniforms[Uniform::ViewPos], m_camera->position());
 
     m_funcs->glActiveTexture(GL_TEXTURE0);
     m_texture->bind();
-    m_program->setUniformValue("material.diffuse", 0);
+    m_program->setUniformValue(m_uniforms[Uniform::MaterialDiffuse], 0);
 
     m_funcs->glActiveTexture(GL_TEXTURE1);
     m_textureSpecular->bind();
-    m_program->setUniformValue("material.specular", 1);
+    m_program->setUniformValue(m_uniforms[Uniform::MaterialSpecular], 1);
 
-    m_program->setUniformValue("material.specular", QVector3D(0.5f, 0.5f, 0.5f));
-    m_program->setUniformValue("material.shininess", 32.0f);
+    m_program->setUniformValue(m_uniforms[Uniform::MaterialShininess], 32.0f);
 
-    m_program->setUniformValue("light.ambient", QVector3D(0.2f, 0.2f, 0.2f));
-    m_program->setUniformValue("light.diffuse", QVector3D(0.5f, 0.5f, 0.5f));
-    m_program->setUniformValue("light.specular", QVector3D(1.0f, 1.0f, 1.0f));
-    m_program->setUniformValue("light.position", m_lightPos);
+    m_program->setUniformValue(m_uniforms[Uniform::LightAmbient], QVector3D(0.2f, 0.2f, 0.2f));
+    m_program->setUniformValue(m_uniforms[Uniform::LightDiffuse], QVector3D(0.5f, 0.5f, 0.5f));
+    m_program->setUniformValue(m_uniforms[Uniform::LightSpecular], QVector3D(1.0f, 1.0f, 1.0f));
+    m_program->setUniformValue(m_uniforms[Uniform::LightPosition], m_lightPos);
 
-    m_program->setUniformValue("model", QMatrix4x4());
+    m_program->setUniformValue(m_uniforms[Uniform::Model], QMatrix4x4());
 
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
-    m_funcs->glDrawArrays(GL_TRIANGLES, 0, 36);
+    m_cube.draw();
 
     // release resources
     m_texture->release();
@@ -232,15 +223,15 @@ void Window::paintLamp()
 {
     m_lampProgram->bind();
 
-    m_lampProgram->setUniformValue("view", m_camera->view());
-    m_lampProgram->setUniformValue("projection", m_camera->projection());
+    m_lampProgram->setUniformValue(m_lampUniforms[LampUniform::View], m_camera->view());
+    m_lampProgram->setUniformValue(m_lampUniforms[LampUniform::Projection], m_camera->projection());
 
     QMatrix4x4 model;
     model.translate(m_lightPos);
     model.scale({0.2f, 0.2f, 0.2f});
-    m_lampProgram->setUniformValue("model", model);
+    m_lampProgram->setUniformValue(m_lampUniforms[LampUniform::Model], model);
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_lampVao);
-    m_funcs->glDrawArrays(GL_TRIANGLES, 0, 36);
+    m_cube.draw();
 
     // release resources
     m_lampProgram->release();
@@ -1,13 +1,17 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
-#include <QOpenGLBuffer>
 #include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLTexture>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLWindow>
 
+#include <framescheduler.h>
+#include <mesh.h>
+#include <textureloader.h>
+#include <uniformtable.h>
+
 #include <memory>
 
 class Camera;
@@ -33,17 +37,42 @@ private:
     void paintLamp();
 
 private:
+    enum class Uniform {
+        View,
+        Projection,
+        ViewPos,
+        MaterialDiffuse,
+        MaterialSpecular,
+        MaterialShininess,
+        LightAmbient,
+        LightDiffuse,
+        LightSpecular,
+        LightPosition,
+        Model,
+        Count
+    };
+
+    enum class LampUniform {
+        View,
+        Projection,
+        Model,
+        Count
+    };
+
     QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
     std::unique_ptr<Camera> m_camera;
-    QOpenGLBuffer m_vbo {QOpenGLBuffer::VertexBuffer};
+    FrameScheduler m_scheduler;
+    Mesh m_cube;
     QOpenGLVertexArrayObject m_vao;
-    QOpenGLBuffer m_lampVbo {QOpenGLBuffer::VertexBuffer};
     QOpenGLVertexArrayObject m_lampVao;
     QVector3D m_lightPos {1.2f, 1.0f, 2.0f};
     std::unique_ptr<QOpenGLShaderProgram> m_program;
     std::unique_ptr<QOpenGLShaderProgram> m_lampProgram;
-    std::unique_ptr<QOpenGLTexture> m_texture;
-    std::unique_ptr<QOpenGLTexture> m_textureSpecular;
+    UniformLocations<Uniform> m_uniforms;
+    UniformLocations<LampUniform> m_lampUniforms;
+    TextureLoader m_textureLoader;
+    QOpenGLTexture *m_texture {nullptr};
+    QOpenGLTexture *m_textureSpecular {nullptr};
 };
 
 #endif // WINDOW_H
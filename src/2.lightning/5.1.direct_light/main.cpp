@@ -2,6 +2,8 @@
 
 #include "window.h"
 
+#include <offscreenrunner.h>
+
 int main(int argc, char *argv[])
 {
     QGuiApplication a(argc, argv);
@@ -13,7 +15,12 @@ int main(int argc, char *argv[])
     fmt.setProfile(QSurfaceFormat::CoreProfile);
     QSurfaceFormat::setDefaultFormat(fmt);
 
+    OffscreenRunner runner(a.arguments());
+
     Window w;
+    if (runner.isEnabled())
+        return runner.exec(&w);
+
     w.show();
 
     return QCoreApplication::exec();
@@ -1,13 +1,20 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
-#include <QOpenGLBuffer>
 #include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLTexture>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLWindow>
 
+#include <cubefield.h>
+#include <framescheduler.h>
+#include <mesh.h>
+#include <renderqueue.h>
+#include <statecache.h>
+#include <textureloader.h>
+#include <uniformtable.h>
+
 #include <memory>
 
 class Camera;
@@ -32,19 +39,49 @@ private:
     void initializeTextures();
     void paintCube();
     void paintLamp();
+    void drawCubes(int modelLocation);
 
 private:
+    enum class Uniform {
+        View,
+        Projection,
+        ViewPos,
+        MaterialDiffuse,
+        MaterialSpecular,
+        MaterialShininess,
+        LightAmbient,
+        LightDiffuse,
+        LightSpecular,
+        LightDirection,
+        Model,
+        Instanced,
+        Count
+    };
+
+    enum class LampUniform {
+        View,
+        Projection,
+        Model,
+        Count
+    };
+
     QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
+    StateCache m_state;
     std::unique_ptr<Camera> m_camera;
-    QOpenGLBuffer m_vbo {QOpenGLBuffer::VertexBuffer};
+    FrameScheduler m_scheduler;
+    Mesh m_cube;
     QOpenGLVertexArrayObject m_vao;
-    QOpenGLBuffer m_lampVbo {QOpenGLBuffer::VertexBuffer};
     QOpenGLVertexArrayObject m_lampVao;
     QVector3D m_lightPos {1.2f, 1.0f, 2.0f};
+    CubeField m_cubeField;
+    RenderQueue m_renderQueue;
     std::unique_ptr<QOpenGLShaderProgram> m_program;
     std::unique_ptr<QOpenGLShaderProgram> m_lampProgram;
-    std::unique_ptr<QOpenGLTexture> m_texture;
-    std::unique_ptr<QOpenGLTexture> m_textureSpecular;
+    UniformLocations<Uniform> m_uniforms;
+    UniformLocations<LampUniform> m_lampUniforms;
+    TextureLoader m_textureLoader;
+    QOpenGLTexture *m_texture {nullptr};
+    QOpenGLTexture *m_textureSpecular {nullptr};
 };
 
 #endif // WINDOW_H
@@ -1,12 +1,12 @@
 #include "window.h"
 #include "camera.h"
 
-#if QT_VERSION >= 0x060000
-#include <QtOpenGL/QOpenGLVersionFunctionsFactory>
-#endif
+#include <glfunctions.h>
+#include <programcache.h>
 
 #include <QtGui/QKeyEvent>
 
+#include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
 
 #include <cmath>
@@ -60,62 +60,60 @@ constexpr const GLfloat vertices[] = {
     -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
 };
 
-constexpr QVector3D cubePositions[] = {
-    {0.0f,  0.0f,  0.0f},
-    {2.0f,  5.0f, -15.0f},
-    {-1.5f, -2.2f, -2.5f},
-    {-3.8f, -2.0f, -12.3f},
-    {2.4f, -0.4f, -3.5f},
-    {-1.7f,  3.0f, -7.5f},
-    {1.3f, -2.0f, -2.5f},
-    {1.5f,  2.0f, -2.5f},
-    {1.5f,  0.2f, -1.5f},
-    {-1.3f,  1.0f, -1.5f}
-};
+// bounding sphere of the unit cube
+constexpr float cubeRadius = 0.8660254f;
 
 } // namespace
 
 Window::Window() :
-    m_camera(std::make_unique<Camera>())
+    m_state(QCoreApplication::arguments()),
+    m_camera(std::make_unique<Camera>()),
+    m_scheduler(this, QCoreApplication::arguments()),
+    m_cube(Mesh::vertexFormat(QCoreApplication::arguments())),
+    m_cubeField(QCoreApplication::arguments()),
+    m_renderQueue(QCoreApplication::arguments()),
+    m_textureLoader(this)
 {
     resize(640, 480);
 
     m_camera->setWindow(this);
+
+    connect(&m_scheduler, &FrameScheduler::step, m_camera.get(), &Camera::advance);
+    connect(&m_scheduler, &FrameScheduler::frame, m_camera.get(), &Camera::interpolate);
+    connect(m_camera.get(), &Camera::clicked, this, [this](const QVector3D &origin, const QVector3D &direction) {
+        const auto cube = m_renderQueue.pick(origin, direction);
+        if (cube >= 0)
+            qDebug() << "Picked cube" << cube << "at" << m_cubeField.models()[size_t(cube)].column(3).toVector3D();
+    });
+    m_scheduler.start();
 }
 
 Window::~Window()
 {
     makeCurrent();
-    m_texture->destroy();
-    m_textureSpecular->destroy();
+    m_textureLoader.destroy();
+    m_renderQueue.destroy();
+    m_cubeField.destroy();
+    m_cube.destroy();
+    m_state.destroy();
     doneCurrent();
 }
 
 void Window::initializeGL()
 {
-    if (!context()) {
-        qCritical() << "Can't get OGL context";
-        close();
-        return;
-    }
-
-#if QT_VERSION >= 0x060000
-    m_funcs = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(context());
-#else
-    m_funcs = context()->versionFunctions<QOpenGLFunctions_3_3_Core>();
-#endif
+    m_funcs = resolveCoreFunctions();
     if (!m_funcs) {
-        qCritical() << "Can't get OGL 3.2";
         close();
         return;
     }
-
-    m_funcs->initializeOpenGLFunctions();
-    m_funcs->glEnable(GL_DEPTH_TEST);
+    m_state.create(m_funcs);
+    m_state.setCapability(GL_DEPTH_TEST, true);
 
     initializeCubeGeometry();
     initializeLampGeometry();
     initializeShaders();
+    m_renderQueue.create(m_funcs, &m_state);
+    m_renderQueue.setModels(m_cubeField.models(), cubeRadius);
     initializeTextures();
 }
 
@@ -125,7 +123,7 @@ void Window::resizeGL(int w, int h)
         return;
     }
 
-    m_funcs->glViewport(0, 0, w, h);
+    m_state.viewport(0, 0, w, h);
 }
 
 void Window::paintGL()
@@ -134,11 +132,17 @@ void Window::paintGL()
         return;
     }
 
+    // the uploads bind textures and buffers behind the cache's back
+    if (m_textureLoader.update(m_funcs))
+        m_state.invalidate();
+
     m_funcs->glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     m_funcs->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     paintCube();
 //    paintLamp();
+
+    m_state.endFrame();
 }
 
 void Window::keyPressEvent(QKeyEvent *event)
@@ -147,6 +151,17 @@ void Window::keyPressEvent(QKeyEvent *event)
         close();
     } else if (event->key() == Qt::Key_F) {
         toggleFullScreen();
+    } else if (event->key() == Qt::Key_I) {
+        m_cubeField.setInstanced(!m_cubeField.isInstanced());
+    } else if (event->key() == Qt::Key_K) {
+        m_renderQueue.setCulling(RenderQueue::Culling((int(m_renderQueue.culling()) + 1) % 3));
+        qDebug().noquote() << m_renderQueue.modeText();
+    } else if (event->key() == Qt::Key_O) {
+        m_renderQueue.setSorted(!m_renderQueue.isSorted());
+        qDebug().noquote() << m_renderQueue.modeText();
+    } else if (event->key() == Qt::Key_Z) {
+        m_renderQueue.setDepthPrePass(!m_renderQueue.hasDepthPrePass());
+        qDebug().noquote() << m_renderQueue.modeText();
     }
 
     QOpenGLWindow::keyPressEvent(event);
@@ -165,23 +180,10 @@ void Window::initializeCubeGeometry()
     m_vao.create();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
 
-    m_vbo.create();
-    m_vbo.bind();
-    m_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_vbo.allocate(vertices, sizeof(vertices));
-
-    // Vertexes attribute
-    m_funcs->glEnableVertexAttribArray(0);
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), nullptr);
-
-    // Normals attribute
-    m_funcs->glEnableVertexAttribArray(1);
-    m_funcs->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<GLvoid *>(3 * sizeof(GLfloat)));
+    m_cube.create(m_funcs, vertices);
 
-    m_funcs->glEnableVertexAttribArray(2);
-    m_funcs->glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<GLvoid *>(6 * sizeof(GLfloat)));
-
-    m_vbo.release();
+    // Instance model and normal matrices
+    m_cubeField.createInstanceBuffer(m_funcs, 3, 7);
 }
 
 void Window::initializeLampGeometry()
@@ -189,102 +191,130 @@ void Window::initializeLampGeometry()
     m_lampVao.create();
     QOpenGLVertexArrayObject::Binder vaoBinder(&m_lampVao);
 
-    m_lampVbo.create();
-    m_lampVbo.bind();
-    m_lampVbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_lampVbo.allocate(vertices, sizeof(vertices));
-
-    // Vertexes attribute
-    m_funcs->glEnableVertexAttribArray(0);
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), nullptr);
+    m_cube.setupAttributes();
 }
 
 void Window::initializeShaders()
 {
     m_program = std::make_unique<QOpenGLShaderProgram>();
-    m_program->addShaderFromSourceFile(QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl"));
-    m_program->addShaderFromSourceFile(QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl"));
-    m_program->link();
+    ProgramCache::link(m_program.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl")},
+    });
+    m_uniforms.resolve(m_program.get(), {{
+        "view",
+        "projection",
+        "viewPos",
+        "material.diffuse",
+        "material.specular",
+        "material.shininess",
+        "light.position",
+        "light.direction",
+        "light.cutoff",
+        "light.outerCutoff",
+        "light.ambient",
+        "light.diffuse",
+        "light.specular",
+        "light.constant",
+        "light.linear",
+        "light.quadratic",
+        "model",
+        "instanced",
+    }});
 
     m_lampProgram = std::make_unique<QOpenGLShaderProgram>();
-    m_lampProgram->addShaderFromSourceFile(QOpenGLShader::Vertex, QStringLiteral(":/vlamp.glsl"));
-    m_lampProgram->addShaderFromSourceFile(QOpenGLShader::Fragment, QStringLiteral(":/flamp.glsl"));
-    m_lampProgram->link();
+    ProgramCache::link(m_lampProgram.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vlamp.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/flamp.glsl")},
+    });
+    m_lampUniforms.resolve(m_lampProgram.get(), {{
+        "view",
+        "projection",
+        "model",
+    }});
 }
 
 void Window::initializeTextures()
 {
-    m_texture = std::make_unique<QOpenGLTexture>(QImage(":/container2.png").mirrored());
-    m_textureSpecular = std::make_unique<QOpenGLTexture>(QImage(":/container2_specular.png").mirrored());
+    m_texture = m_textureLoader.load(QStringLiteral(":/container2.png"), TextureLoader::Mirrored);
+    m_textureSpecular = m_textureLoader.load(QStringLiteral(":/container2_specular.png"), TextureLoader::Mirrored,
+                                             qRgb(0, 0, 0));
 }
 
 void Window::paintCube()
 {
-    m_program->bind();
-
-    m_program->setUniformValue("view", m_camera->view());
-    m_program->setUniformValue("projection", m_camera->projection());
+    if (m_renderQueue.update(m_camera->view(), m_camera->projection()))
+        m_cubeField.updateInstanceBuffer(m_renderQueue.renderList().data().data(),
+                                         m_renderQueue.renderList().count());
+
+    if (m_renderQueue.hasDepthPrePass()) {
+        m_renderQueue.beginDepthPrePass(m_camera->view(), m_camera->projection(),
+                                        m_cubeField.isInstanced());
+        drawCubes(m_renderQueue.depthModelLocation());
+        m_renderQueue.endDepthPrePass();
+    }
 
-    m_program->setUniformValue("objectColor", QVector3D(1.0f, 0.5f, 0.31f));
-    m_program->setUniformValue("viewPos", m_camera->position());
+    m_state.useProgram(m_program->programId());
 
-    m_funcs->glActiveTexture(GL_TEXTURE0);
-    m_texture->bind();
-    m_program->setUniformValue("material.diffuse", 0);
+    m_program->setUniformValue(m_uniforms[Uniform::View], m_camera->view());
+    m_program->setUniformValue(m_uniforms[Uniform::Projection], m_camera->projection());
 
-    m_funcs->glActiveTexture(GL_TEXTURE1);
-    m_textureSpecular->bind();
-    m_program->setUniformValue("material.specular", 1);
+    m_program->setUniformValue(m_uniforms[Uniform::ViewPos], m_camera->position());
 
-    m_program->setUniformValue("material.specular", QVector3D(0.5f, 0.5f, 0.5f));
-    m_program->setUniformValue("material.shininess", 32.0f);
+    m_state.bindTexture(0, GL_TEXTURE_2D, m_texture->textureId());
+    m_program->setUniformValue(m_uniforms[Uniform::MaterialDiffuse], 0);
 
-    m_program->setUniformValue("light.position", m_camera->position());
-    m_program->setUniformValue("light.direction", m_camera->front());
-    m_program->setUniformValue("light.cutoff", cos(radians(12.5f)));
-    m_program->setUniformValue("light.outerCutoff", cos(radians(17.5f)));
+    m_state.bindTexture(1, GL_TEXTURE_2D, m_textureSpecular->textureId());
+    m_program->setUniformValue(m_uniforms[Uniform::MaterialSpecular], 1);
 
-    m_program->setUniformValue("light.ambient", QVector3D(0.2f, 0.2f, 0.2f));
-    m_program->setUniformValue("light.diffuse", QVector3D(0.5f, 0.5f, 0.5f));
-    m_program->setUniformValue("light.specular", QVector3D(1.0f, 1.0f, 1.0f));
+    m_program->setUniformValue(m_uniforms[Uniform::MaterialShininess], 32.0f);
 
-    m_program->setUniformValue("light.constant", 1.0f);
-    m_program->setUniformValue("light.linear", 0.09f);
-    m_program->setUniformValue("light.quadratic", 0.032f);
+    m_program->setUniformValue(m_uniforms[Uniform::LightPosition], m_camera->position());
+    m_program->setUniformValue(m_uniforms[Uniform::LightDirection], m_camera->front());
+    m_program->setUniformValue(m_uniforms[Uniform::LightCutoff], cos(radians(12.5f)));
+    m_program->setUniformValue(m_uniforms[Uniform::LightOuterCutoff], cos(radians(17.5f)));
 
-    QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
+    m_program->setUniformValue(m_uniforms[Uniform::LightAmbient], QVector3D(0.2f, 0.2f, 0.2f));
+    m_program->setUniformValue(m_uniforms[Uniform::LightDiffuse], QVector3D(0.5f, 0.5f, 0.5f));
+    m_program->setUniformValue(m_uniforms[Uniform::LightSpecular], QVector3D(1.0f, 1.0f, 1.0f));
 
-    for(unsigned int i = 0; i < 10; i++)
-    {
-        QMatrix4x4 model;
-        const auto angle = 20.0f * i;
-        model.translate(cubePositions[i]);
-        model.rotate(angle, {1.0f, 0.3f, 0.5f});
+    m_program->setUniformValue(m_uniforms[Uniform::LightConstant], 1.0f);
+    m_program->setUniformValue(m_uniforms[Uniform::LightLinear], 0.09f);
+    m_program->setUniformValue(m_uniforms[Uniform::LightQuadratic], 0.032f);
 
-        m_program->setUniformValue("model", model);
-        m_funcs->glDrawArrays(GL_TRIANGLES, 0, 36);
-    }
+    m_program->setUniformValue(m_uniforms[Uniform::Instanced], m_cubeField.isInstanced());
 
-    // release resources
-    m_texture->release();
-    m_textureSpecular->release();
-    m_program->release();
+    m_renderQueue.beginMainPass();
+    drawCubes(m_uniforms[Uniform::Model]);
+    m_renderQueue.endMainPass();
 }
 
 void Window::paintLamp()
 {
-    m_lampProgram->bind();
+    m_state.useProgram(m_lampProgram->programId());
 
-    m_lampProgram->setUniformValue("view", m_camera->view());
-    m_lampProgram->setUniformValue("projection", m_camera->projection());
+    m_lampProgram->setUniformValue(m_lampUniforms[LampUniform::View], m_camera->view());
+    m_lampProgram->setUniformValue(m_lampUniforms[LampUniform::Projection], m_camera->projection());
 
     QMatrix4x4 model;
     model.translate(m_lightPos);
     model.scale({0.2f, 0.2f, 0.2f});
-    m_lampProgram->setUniformValue("model", model);
-    QOpenGLVertexArrayObject::Binder vaoBinder(&m_lampVao);
-    m_funcs->glDrawArrays(GL_TRIANGLES, 0, 36);
+    m_lampProgram->setUniformValue(m_lampUniforms[LampUniform::Model], model);
+    m_state.bindVertexArray(m_lampVao.objectId());
+    m_cube.draw();
+}
 
-    // release resources
-    m_lampProgram->release();
+void Window::drawCubes(int modelLocation)
+{
+    const auto &renderList = m_renderQueue.renderList();
+    m_state.bindVertexArray(m_vao.objectId());
+    if (m_cubeField.isInstanced()) {
+        m_cube.drawInstanced(renderList.count());
+    } else {
+        // the packets are built by RenderQueue::update(), only the uniform is set here
+        for (int packet = 0; packet < renderList.count(); ++packet) {
+            m_funcs->glUniformMatrix4fv(modelLocation, 1, GL_FALSE, renderList.model(packet));
+            m_cube.draw();
+        }
+    }
 }
@@ -0,0 +1,42 @@
+#ifndef FRAMEBLOCK_H
+#define FRAMEBLOCK_H
+
+#include "lightsblock.h"
+
+#include <QtGui/QMatrix4x4>
+
+#include <algorithm>
+
+// CPU mirror of the std140 "Frame" uniform block shared by all shaders, written to the stream
+// buffer every frame. It also has the spot light's position and direction, which follow the camera,
+// the rest of the lights is in the persistent "Lights" block
+
+struct FrameBlock
+{
+    FrameBlock() = default;
+    FrameBlock(const QMatrix4x4 &view, const QMatrix4x4 &projection, const QVector3D &viewPosition,
+               const QVector3D &spotLightPosition, const QVector3D &spotLightDirection) :
+        viewPos(viewPosition),
+        spotPosition(spotLightPosition),
+        spotDirection(spotLightDirection)
+    {
+        std::copy(view.constData(), view.constData() + 16, this->view);
+        std::copy(projection.constData(), projection.constData() + 16, this->projection);
+    }
+
+    GLfloat view[16] {};
+    GLfloat projection[16] {};
+    Std140Vec3 viewPos;
+    GLfloat padding0 {0.0f};
+    Std140Vec3 spotPosition;
+    GLfloat padding1 {0.0f};
+    Std140Vec3 spotDirection;
+    GLfloat padding2 {0.0f};
+};
+
+static_assert(offsetof(FrameBlock, viewPos) == 128, "Frame doesn't match std140 layout");
+static_assert(offsetof(FrameBlock, spotPosition) == 144, "Frame doesn't match std140 layout");
+static_assert(offsetof(FrameBlock, spotDirection) == 160, "Frame doesn't match std140 layout");
+static_assert(sizeof(FrameBlock) == 176, "Frame doesn't match std140 layout");
+
+#endif // FRAMEBLOCK_H
@@ -8,6 +8,7 @@ struct Material {
     float shininess;
 };
 
+// NOTE: std140 aligns vec3 to 16 bytes, scalars fill the gaps; keep in sync with lightsblock.h
 struct DirLight {
     vec3 direction;
 
@@ -18,29 +19,25 @@ struct DirLight {
 
 struct PointLight {
     vec3 position;
-
     float constant;
-    float linear;
-    float quadratic;
-
     vec3 ambient;
+    float linear;
     vec3 diffuse;
+    float quadratic;
     vec3 specular;
 };
 
+// the position and direction follow the camera, they are spotPosition and spotDirection of Frame
 struct SpotLight {
-    vec3 position;
-    vec3 direction;
-    float cutoff;
-    float outerCutoff;
-
     vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
     float constant;
+    vec3 diffuse;
     float linear;
+    vec3 specular;
     float quadratic;
+
+    float cutoff;
+    float outerCutoff;
 };
 
 in vec2 TexCoords;
@@ -50,12 +47,22 @@ in vec3 Normal;
 out vec4 FragColor;
 
 uniform vec3 objectColor;
-uniform vec3 viewPos;
+
+layout (std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    vec3 spotPosition;
+    vec3 spotDirection;
+};
 
 uniform Material material;
-uniform DirLight dirLight;
-uniform PointLight pointLights[NR_POINT_LIGHTS];
-uniform SpotLight spotLight;
+
+layout (std140) uniform Lights {
+    DirLight dirLight;
+    PointLight pointLights[NR_POINT_LIGHTS];
+    SpotLight spotLight;
+};
 
 vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
 vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
@@ -106,8 +113,8 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
 
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
 {
-    vec3 lightDirection = normalize(light.position - fragPos);
-    float theta = dot(lightDirection, normalize(-light.direction));
+    vec3 lightDirection = normalize(spotPosition - fragPos);
+    float theta = dot(lightDirection, normalize(-spotDirection));
     float epsilon = light.cutoff - light.outerCutoff;
     float intensity = clamp((theta - light.outerCutoff) / epsilon, 0.0, 1.0);
 
@@ -0,0 +1,78 @@
+#ifndef LIGHTSBLOCK_H
+#define LIGHTSBLOCK_H
+
+#include <QtGui/QVector3D>
+#include <QtGui/qopengl.h>
+
+#include <cstddef>
+
+// CPU mirror of the std140 "Lights" uniform block from fshader.glsl.
+// In std140 a vec3 is aligned to 16 bytes, so scalars are packed into the 4th component.
+
+constexpr int NR_POINT_LIGHTS = 4;
+
+struct Std140Vec3
+{
+    Std140Vec3() = default;
+    Std140Vec3(const QVector3D &v) : x(v.x()), y(v.y()), z(v.z()) {}
+
+    QVector3D toVector3D() const { return {x, y, z}; }
+
+    GLfloat x {0.0f};
+    GLfloat y {0.0f};
+    GLfloat z {0.0f};
+};
+
+struct DirLightData
+{
+    Std140Vec3 direction;
+    GLfloat padding0 {0.0f};
+    Std140Vec3 ambient;
+    GLfloat padding1 {0.0f};
+    Std140Vec3 diffuse;
+    GLfloat padding2 {0.0f};
+    Std140Vec3 specular;
+    GLfloat padding3 {0.0f};
+};
+
+struct PointLightData
+{
+    Std140Vec3 position;
+    GLfloat constant {1.0f};
+    Std140Vec3 ambient;
+    GLfloat linear {0.0f};
+    Std140Vec3 diffuse;
+    GLfloat quadratic {0.0f};
+    Std140Vec3 specular;
+    GLfloat padding {0.0f};
+};
+
+// the position and direction follow the camera, they are in FrameBlock
+struct SpotLightData
+{
+    Std140Vec3 ambient;
+    GLfloat constant {1.0f};
+    Std140Vec3 diffuse;
+    GLfloat linear {0.0f};
+    Std140Vec3 specular;
+    GLfloat quadratic {0.0f};
+    GLfloat cutoff {0.0f};
+    GLfloat outerCutoff {0.0f};
+    GLfloat padding[2] {};
+};
+
+struct LightsBlock
+{
+    DirLightData dirLight;
+    PointLightData pointLights[NR_POINT_LIGHTS];
+    SpotLightData spotLight;
+};
+
+static_assert(sizeof(DirLightData) == 64, "DirLight doesn't match std140 layout");
+static_assert(sizeof(PointLightData) == 64, "PointLight doesn't match std140 layout");
+static_assert(sizeof(SpotLightData) == 64, "SpotLight doesn't match std140 layout");
+static_assert(offsetof(LightsBlock, pointLights) == 64, "Lights doesn't match std140 layout");
+static_assert(offsetof(LightsBlock, spotLight) == 320, "Lights doesn't match std140 layout");
+static_assert(sizeof(LightsBlock) == 384, "Lights doesn't match std140 layout");
+
+#endif // LIGHTSBLOCK_H
@@ -1,12 +1,20 @@
 #version 330 core
 
 layout (location = 0) in vec3 position;
+layout (location = 3) in mat4 instanceModel;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    vec3 spotPosition;
+    vec3 spotDirection;
+};
+
+// the lamps are drawn in the main pass, with the depth pre-pass GL_EQUAL needs it bit-exact
+invariant gl_Position;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(position, 1.0f);
+    gl_Position = projection * view * instanceModel * vec4(position, 1.0f);
 }
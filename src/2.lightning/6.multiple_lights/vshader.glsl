@@ -3,19 +3,41 @@
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 normal;
 layout (location = 2) in vec2 texcoords;
+layout (location = 3) in mat4 instanceModel;
+layout (location = 7) in mat3 instanceNormalMatrix;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
 
+// per-frame data comes from the stream buffer, see frameblock.h
+layout (std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    vec3 spotPosition;
+    vec3 spotDirection;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform bool instanced;
+
+// the depth pre-pass computes the same position, GL_EQUAL needs it bit-exact
+invariant gl_Position;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(position, 1.0f);
-    FragPos = vec3(model * vec4(position, 1.0f));
-    Normal = mat3(transpose(inverse(model))) * normal;
+    mat4 cubeModel = model;
+    mat3 normalMatrix;
+    if (instanced) {
+        cubeModel = instanceModel;
+        normalMatrix = instanceNormalMatrix;
+    } else {
+        normalMatrix = mat3(transpose(inverse(model)));
+    }
+
+    gl_Position = projection * view * cubeModel * vec4(position, 1.0f);
+    FragPos = vec3(cubeModel * vec4(position, 1.0f));
+    Normal = normalMatrix * normal;
     TexCoords = texcoords;
 }
@@ -1,15 +1,20 @@
 #include "window.h"
 #include "camera.h"
 
-#if QT_VERSION >= 0x060000
-#include <QtOpenGL/QOpenGLVersionFunctionsFactory>
-#endif
+#include <components.h>
+#include <glfunctions.h>
+#include <mesh.h>
+#include <programcache.h>
+#include <systems.h>
 
 #include <QtGui/QKeyEvent>
 
+#include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
 
+#include <algorithm>
 #include <cmath>
+#include <type_traits>
 
 namespace {
 
@@ -60,63 +65,120 @@ constexpr const GLfloat vertices[] = {
     -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
 };
 
-constexpr QVector3D cubePositions[] = {
-    {0.0f,  0.0f,  0.0f},
-    {2.0f,  5.0f, -15.0f},
-    {-1.5f, -2.2f, -2.5f},
-    {-3.8f, -2.0f, -12.3f},
-    {2.4f, -0.4f, -3.5f},
-    {-1.7f,  3.0f, -7.5f},
-    {1.3f, -2.0f, -2.5f},
-    {1.5f,  2.0f, -2.5f},
-    {1.5f,  0.2f, -1.5f},
-    {-1.3f,  1.0f, -1.5f}
+constexpr QVector3D pointLightPositions[] = {
+    { 0.7f,  0.2f,  2.0f},
+    { 2.3f, -3.3f, -4.0f},
+    {-4.0f,  2.0f, -12.0f},
+    { 0.0f,  0.0f, -3.0f}
 };
 
+static_assert(std::extent<decltype(pointLightPositions)>::value == NR_POINT_LIGHTS,
+              "Every point light of the uniform block needs a position");
+
+constexpr GLuint lightsBindingPoint = 0;
+constexpr GLuint frameBindingPoint = 1;
+
+// bounding sphere of the unit cube
+constexpr float cubeRadius = 0.8660254f;
+
+// the programs and texture sets of the main pass' DrawQueue keys
+enum Program { LitProgram, LampProgram };
+enum TextureSet { NoTextures, ContainerTextures };
+
+// the main pass' DrawQueue indices: the instanced cubes, the lamps or a cube packet (0 and above)
+constexpr int cubesDraw = -1;
+constexpr int lampsDraw = -2;
+
+// The lamp shader only reads the positions, without normals and texture coords the cube welds
+// into its 8 corners instead of 24 vertices
+std::vector<GLfloat> positionsOnly(const GLfloat *vertices, int vertexCount)
+{
+    auto result = std::vector<GLfloat>(size_t(vertexCount * Mesh::FloatsPerVertex), 0.0f);
+    for (int i = 0; i < vertexCount; ++i) {
+        const auto vertex = size_t(i * Mesh::FloatsPerVertex);
+        std::copy(vertices + vertex, vertices + vertex + 3, result.begin() + std::ptrdiff_t(vertex));
+    }
+    return result;
+}
+
+void bindUniformBlock(QOpenGLFunctions_3_3_Core *funcs, QOpenGLShaderProgram *program, const char *name,
+                      GLuint bindingPoint)
+{
+    const auto blockIndex = funcs->glGetUniformBlockIndex(program->programId(), name);
+    if (blockIndex == GL_INVALID_INDEX)
+        qWarning() << "Can't find" << name << "uniform block";
+    else
+        funcs->glUniformBlockBinding(program->programId(), blockIndex, bindingPoint);
+}
+
 } // namespace
 
 Window::Window() :
-    m_camera(std::make_unique<Camera>())
+    m_state(QCoreApplication::arguments()),
+    m_camera(std::make_unique<Camera>()),
+    m_scheduler(this, QCoreApplication::arguments()),
+    m_profiler(QCoreApplication::arguments()),
+    m_meshPool(Mesh::vertexFormat(QCoreApplication::arguments())),
+    m_sceneBatch(QCoreApplication::arguments()),
+    m_cubeField(QCoreApplication::arguments()),
+    m_renderQueue(QCoreApplication::arguments()),
+    m_textureLoader(this),
+    m_streamBuffer(QCoreApplication::arguments())
 {
     resize(640, 480);
 
     m_camera->setWindow(this);
+
+    // the point lights are drawn as small cubes, they don't move so the matrices are computed once
+    for (const auto &position: pointLightPositions)
+        m_world.create(Transform {position, {}, {0.2f, 0.2f, 0.2f}}, ModelMatrix {}, Light {});
+    updateModelMatrices(m_world);
+
+    connect(&m_scheduler, &FrameScheduler::step, m_camera.get(), &Camera::advance);
+    connect(&m_scheduler, &FrameScheduler::frame, m_camera.get(), &Camera::interpolate);
+    connect(m_camera.get(), &Camera::clicked, this, [this](const QVector3D &origin, const QVector3D &direction) {
+        const auto cube = m_renderQueue.pick(origin, direction);
+        if (cube >= 0)
+            qDebug() << "Picked cube" << cube << "at" << m_cubeField.models()[size_t(cube)].column(3).toVector3D();
+    });
+    m_scheduler.start();
 }
 
 Window::~Window()
 {
     makeCurrent();
-    m_texture->destroy();
-    m_textureSpecular->destroy();
+    m_profiler.destroy();
+    m_textureLoader.destroy();
+    m_renderQueue.destroy();
+    m_cubeField.destroy();
+    m_streamBuffer.destroy();
+    if (m_funcs)
+        m_funcs->glDeleteBuffers(1, &m_lightsUbo);
+    m_sceneBatch.destroy();
+    m_meshPool.destroy();
+    m_state.destroy();
     doneCurrent();
 }
 
 void Window::initializeGL()
 {
-    if (!context()) {
-        qCritical() << "Can't get OGL context";
-        close();
-        return;
-    }
-
-#if QT_VERSION >= 0x060000
-    m_funcs = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(context());
-#else
-    m_funcs = context()->versionFunctions<QOpenGLFunctions_3_3_Core>();
-#endif
+    m_funcs = resolveCoreFunctions();
     if (!m_funcs) {
-        qCritical() << "Can't get OGL 3.2";
         close();
         return;
     }
+    m_state.create(m_funcs);
+    m_state.setCapability(GL_DEPTH_TEST, true);
 
-    m_funcs->initializeOpenGLFunctions();
-    m_funcs->glEnable(GL_DEPTH_TEST);
-
-    initializeCubeGeometry();
-    initializeLampGeometry();
+    initializeGeometry();
     initializeShaders();
+    m_renderQueue.create(m_funcs, &m_state);
+    m_renderQueue.setModels(m_cubeField.models(), cubeRadius);
     initializeTextures();
+    initializeLights();
+    m_streamBuffer.create(m_funcs, int(sizeof(FrameBlock)), 1);
+
+    m_profiler.create(this);
 }
 
 void Window::resizeGL(int w, int h)
@@ -125,7 +187,7 @@ void Window::resizeGL(int w, int h)
         return;
     }
 
-    m_funcs->glViewport(0, 0, w, h);
+    m_state.viewport(0, 0, w, h);
 }
 
 void Window::paintGL()
@@ -134,11 +196,25 @@ void Window::paintGL()
         return;
     }
 
+    m_profiler.beginFrame();
+    m_streamBuffer.beginFrame();
+
+    // the uploads bind textures and buffers behind the cache's back
+    if (m_textureLoader.update(m_funcs))
+        m_state.invalidate();
+
     m_funcs->glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     m_funcs->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    paintCube();
-    paintLamps();
+    uploadFrameData();
+    if (m_renderQueue.update(m_camera->view(), m_camera->projection()))
+        updateBatch();
+    paintDepthPrePass();
+    paintMainPass();
+
+    m_streamBuffer.endFrame();
+    m_state.endFrame();
+    m_profiler.endFrame();
 }
 
 void Window::keyPressEvent(QKeyEvent *event)
@@ -147,6 +223,17 @@ void Window::keyPressEvent(QKeyEvent *event)
         close();
     } else if (event->key() == Qt::Key_F) {
         toggleFullScreen();
+    } else if (event->key() == Qt::Key_I) {
+        m_cubeField.setInstanced(!m_cubeField.isInstanced());
+    } else if (event->key() == Qt::Key_K) {
+        m_renderQueue.setCulling(RenderQueue::Culling((int(m_renderQueue.culling()) + 1) % 3));
+        qDebug().noquote() << m_renderQueue.modeText();
+    } else if (event->key() == Qt::Key_O) {
+        m_renderQueue.setSorted(!m_renderQueue.isSorted());
+        qDebug().noquote() << m_renderQueue.modeText();
+    } else if (event->key() == Qt::Key_Z) {
+        m_renderQueue.setDepthPrePass(!m_renderQueue.hasDepthPrePass());
+        qDebug().noquote() << m_renderQueue.modeText();
     }
 
     QOpenGLWindow::keyPressEvent(event);
@@ -160,157 +247,233 @@ void Window::toggleFullScreen()
         showNormal();
 }
 
-void Window::initializeCubeGeometry()
+// The cubes and the lamps share the pool's buffers and the batch's VAO, the instance model and
+// normal matrices are attributes 3 and 7. With glMultiDrawElementsIndirect the depth pre-pass
+// draws both meshes with one call, the main pass draws the commands of each program with one.
+void Window::initializeGeometry()
 {
-    m_vao.create();
-    QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
-
-    m_vbo.create();
-    m_vbo.bind();
-    m_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_vbo.allocate(vertices, sizeof(vertices));
-
-    // Vertexes attribute
-    m_funcs->glEnableVertexAttribArray(0);
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), nullptr);
-
-    // Normals attribute
-    m_funcs->glEnableVertexAttribArray(1);
-    m_funcs->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<GLvoid *>(3 * sizeof(GLfloat)));
-
-    m_funcs->glEnableVertexAttribArray(2);
-    m_funcs->glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<GLvoid *>(6 * sizeof(GLfloat)));
-
-    m_vbo.release();
+    m_cubeMesh = m_meshPool.add(vertices);
+    const auto lampVertices = positionsOnly(vertices, int(std::extent<decltype(vertices)>::value)
+                                            / Mesh::FloatsPerVertex);
+    m_lampMesh = m_meshPool.add(lampVertices.data(), int(lampVertices.size()) / Mesh::FloatsPerVertex);
+    m_meshPool.create(m_funcs);
+
+    m_sceneBatch.create(m_funcs, &m_state, &m_meshPool, 3, 7);
+    m_world.forEach<ModelMatrix, Light>([this](const ModelMatrix &model, const Light &) {
+        m_lampModels.push_back(model.matrix);
+    });
+    updateBatch();
 }
 
-void Window::initializeLampGeometry()
+// the cubes' instances are the render list, so the batch is rebuilt when it changes
+void Window::updateBatch()
 {
-    m_lampVao.create();
-    QOpenGLVertexArrayObject::Binder vaoBinder(&m_lampVao);
-
-    m_lampVbo.create();
-    m_lampVbo.bind();
-    m_lampVbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
-    m_lampVbo.allocate(vertices, sizeof(vertices));
-
-    // Vertexes attribute
-    m_funcs->glEnableVertexAttribArray(0);
-    m_funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), nullptr);
+    const auto &renderList = m_renderQueue.renderList();
+    m_sceneBatch.clear();
+    m_sceneBatch.add(m_cubeMesh, renderList.data().data(), renderList.count());
+    m_cubeCommands = m_sceneBatch.commandCount();
+    for (const auto &model: m_lampModels)
+        m_sceneBatch.add(m_lampMesh, model);
+    m_sceneBatch.upload();
 }
 
 void Window::initializeShaders()
 {
     m_program = std::make_unique<QOpenGLShaderProgram>();
-    m_program->addShaderFromSourceFile(QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl"));
-    m_program->addShaderFromSourceFile(QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl"));
-    m_program->link();
+    ProgramCache::link(m_program.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl")},
+    });
+    m_uniforms.resolve(m_program.get(), {{
+        "model",
+        "instanced",
+    }});
+
+    bindUniformBlock(m_funcs, m_program.get(), "Frame", frameBindingPoint);
+    bindUniformBlock(m_funcs, m_program.get(), "Lights", lightsBindingPoint);
+
+    // samplers and material never change, so they are set only once
+    m_program->bind();
+    m_program->setUniformValue("material.diffuse", 0);
+    m_program->setUniformValue("material.specular", 1);
+    m_program->setUniformValue("material.shininess", 32.0f);
+    m_program->release();
 
     m_lampProgram = std::make_unique<QOpenGLShaderProgram>();
-    m_lampProgram->addShaderFromSourceFile(QOpenGLShader::Vertex, QStringLiteral(":/vlamp.glsl"));
-    m_lampProgram->addShaderFromSourceFile(QOpenGLShader::Fragment, QStringLiteral(":/flamp.glsl"));
-    m_lampProgram->link();
+    ProgramCache::link(m_lampProgram.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vlamp.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/flamp.glsl")},
+    });
+    bindUniformBlock(m_funcs, m_lampProgram.get(), "Frame", frameBindingPoint);
 }
 
 void Window::initializeTextures()
 {
-    m_texture = std::make_unique<QOpenGLTexture>(QImage(":/container2.png").mirrored());
-    m_textureSpecular = std::make_unique<QOpenGLTexture>(QImage(":/container2_specular.png").mirrored());
+    m_texture = m_textureLoader.load(QStringLiteral(":/container2.png"), TextureLoader::Mirrored);
+    m_textureSpecular = m_textureLoader.load(QStringLiteral(":/container2_specular.png"), TextureLoader::Mirrored,
+                                             qRgb(0, 0, 0));
 }
 
-void Window::paintCube()
+void Window::initializeLights()
 {
-    m_program->bind();
-
-    m_program->setUniformValue("view", m_camera->view());
-    m_program->setUniformValue("projection", m_camera->projection());
-
-    m_program->setUniformValue("objectColor", QVector3D(1.0f, 0.5f, 0.31f));
-    m_program->setUniformValue("viewPos", m_camera->position());
-
-    m_funcs->glActiveTexture(GL_TEXTURE0);
-    m_texture->bind();
-    m_program->setUniformValue("material.diffuse", 0);
-
-    m_funcs->glActiveTexture(GL_TEXTURE1);
-    m_textureSpecular->bind();
-    m_program->setUniformValue("material.specular", 1);
-
-    m_program->setUniformValue("material.specular", QVector3D(0.5f, 0.5f, 0.5f));
-    m_program->setUniformValue("material.shininess", 32.0f);
-
     // direct light
-    m_program->setUniformValue("dirLight.ambient", QVector3D(0.2f, 0.2f, 0.2f));
-    m_program->setUniformValue("dirLight.diffuse", QVector3D(0.5f, 0.5f, 0.5f));
-    m_program->setUniformValue("dirLight.specular", QVector3D(1.0f, 1.0f, 1.0f));
-    m_program->setUniformValue("dirLight.direction", QVector3D(-0.2f, -1.0f, -0.3f));
+    m_lights.dirLight.direction = QVector3D(-0.2f, -1.0f, -0.3f);
+    m_lights.dirLight.ambient = QVector3D(0.2f, 0.2f, 0.2f);
+    m_lights.dirLight.diffuse = QVector3D(0.5f, 0.5f, 0.5f);
+    m_lights.dirLight.specular = QVector3D(1.0f, 1.0f, 1.0f);
 
     // point lights
-    int lightIndex = 0;
-    for (const auto &lightPos: m_lightPositions) {
-        const auto prefix = QByteArray("pointLights[") + QByteArray::number(lightIndex) + "].";
-        m_program->setUniformValue((prefix + "position").constData(), lightPos);
-
-        m_program->setUniformValue((prefix + "ambient").constData(), QVector3D(0.2f, 0.2f, 0.2f));
-        m_program->setUniformValue((prefix + "diffuse").constData(), QVector3D(0.5f, 0.5f, 0.5f));
-        m_program->setUniformValue((prefix + "specular").constData(), QVector3D(1.0f, 1.0f, 1.0f));
-
-        m_program->setUniformValue((prefix + "constant").constData(), 1.0f);
-        m_program->setUniformValue((prefix + "linear").constData(), 0.09f);
-        m_program->setUniformValue((prefix + "quadratic").constData(), 0.032f);
+    int index = 0;
+    m_world.forEach<Transform, Light>([this, &index](const Transform &transform, const Light &light) {
+        auto &data = m_lights.pointLights[index++];
+        data.position = transform.position;
+
+        data.ambient = light.ambient;
+        data.diffuse = light.diffuse;
+        data.specular = light.specular;
+
+        data.constant = light.constant;
+        data.linear = light.linear;
+        data.quadratic = light.quadratic;
+    });
+    Q_ASSERT(index == NR_POINT_LIGHTS);
+
+    // spot light, position and direction follow the camera, they are streamed with the frame
+    m_lights.spotLight.cutoff = cos(radians(12.5f));
+    m_lights.spotLight.outerCutoff = cos(radians(17.5f));
+
+    m_lights.spotLight.ambient = QVector3D(0.2f, 0.2f, 0.2f);
+    m_lights.spotLight.diffuse = QVector3D(0.5f, 0.5f, 0.5f);
+    m_lights.spotLight.specular = QVector3D(1.0f, 1.0f, 1.0f);
+
+    m_lights.spotLight.constant = 1.0f;
+    m_lights.spotLight.linear = 0.09f;
+    m_lights.spotLight.quadratic = 0.032f;
+
+    m_funcs->glGenBuffers(1, &m_lightsUbo);
+    m_funcs->glBindBuffer(GL_UNIFORM_BUFFER, m_lightsUbo);
+    m_funcs->glBufferData(GL_UNIFORM_BUFFER, sizeof(m_lights), nullptr, GL_DYNAMIC_DRAW);
+    m_funcs->glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    m_lightsChanged = true;
+}
 
-        lightIndex++;
-    }
+void Window::uploadLights()
+{
+    if (!m_lightsChanged)
+        return;
 
-    // spot light
-    m_program->setUniformValue("spotLight.position", m_camera->position());
-    m_program->setUniformValue("spotLight.direction", m_camera->front());
-    m_program->setUniformValue("spotLight.cutoff", cos(radians(12.5f)));
-    m_program->setUniformValue("spotLight.outerCutoff", cos(radians(17.5f)));
+    // the stream buffer rebinds the generic binding every frame, glBindBufferBase() sets it too
+    m_funcs->glBindBufferBase(GL_UNIFORM_BUFFER, lightsBindingPoint, m_lightsUbo);
+    m_funcs->glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(m_lights), &m_lights);
+    m_lightsChanged = false;
+}
 
-    m_program->setUniformValue("spotLight.ambient", QVector3D(0.2f, 0.2f, 0.2f));
-    m_program->setUniformValue("spotLight.diffuse", QVector3D(0.5f, 0.5f, 0.5f));
-    m_program->setUniformValue("spotLight.specular", QVector3D(1.0f, 1.0f, 1.0f));
+void Window::uploadFrameData()
+{
+    ProfileScope scope(m_profiler, "uniforms");
 
-    m_program->setUniformValue("spotLight.constant", 1.0f);
-    m_program->setUniformValue("spotLight.linear", 0.09f);
-    m_program->setUniformValue("spotLight.quadratic", 0.032f);
+    uploadLights();
 
-    QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
+    // only the camera and the spot light that follows it go to this frame's region of the stream
+    // buffer, the other lights stay in their own buffer until they change
+    m_streamBuffer.bind(frameBindingPoint, FrameBlock(m_camera->view(), m_camera->projection(),
+                                                      m_camera->position(), m_camera->position(),
+                                                      m_camera->front()));
+    m_streamBuffer.flush();
+}
 
-    for(unsigned int i = 0; i < 10; i++)
-    {
-        QMatrix4x4 model;
-        const auto angle = 20.0f * i;
-        model.translate(cubePositions[i]);
-        model.rotate(angle, {1.0f, 0.3f, 0.5f});
+void Window::paintDepthPrePass()
+{
+    if (!m_renderQueue.hasDepthPrePass())
+        return;
 
-        m_program->setUniformValue("model", model);
-        m_funcs->glDrawArrays(GL_TRIANGLES, 0, 36);
+    ProfileScope scope(m_profiler, "depthPrePass");
+
+    const auto program = m_renderQueue.beginDepthPrePass(m_camera->view(), m_camera->projection(),
+                                                         m_cubeField.isInstanced());
+    if (m_cubeField.isInstanced()) {
+        // both meshes, one glMultiDrawElementsIndirect
+        m_sceneBatch.draw();
+    } else {
+        drawCubes(m_renderQueue.depthModelLocation());
+        program->setUniformValue(m_renderQueue.depthInstancedLocation(), true);
+        drawLamps();
     }
+    m_renderQueue.endDepthPrePass();
+}
 
-    // release resources
-    m_texture->release();
-    m_textureSpecular->release();
-    m_program->release();
+// The cubes and the lamps are submitted in DrawQueue key order, so every program and texture set
+// is bound once per run of draws that share it. All draws are opaque and have depth 0: the stable
+// sort keeps the cube packets in the render list's (front-to-back, with "--sort-draws") order.
+// The lamps are drawn in the main pass too, with the pre-pass they are in the depth buffer.
+void Window::paintMainPass()
+{
+    ProfileScope scope(m_profiler, "mainPass");
+
+    const auto &renderList = m_renderQueue.renderList();
+    m_drawQueue.clear();
+    const auto cubeKey = DrawQueue::makeKey(0, LitProgram, 0, ContainerTextures, 0.0f);
+    if (m_cubeField.isInstanced()) {
+        m_drawQueue.add(cubeKey, cubesDraw);
+    } else {
+        m_drawQueue.reserve(renderList.count() + 1);
+        for (int packet = 0; packet < renderList.count(); ++packet)
+            m_drawQueue.add(cubeKey, packet);
+    }
+    m_drawQueue.add(DrawQueue::makeKey(0, LampProgram, 0, NoTextures, 0.0f), lampsDraw);
+    m_drawQueue.sort();
+
+    ProfileScope drawScope(m_profiler, "draw");
+
+    m_renderQueue.beginMainPass();
+    const auto &draws = m_drawQueue.draws();
+    for (size_t i = 0; i < draws.size(); ++i) {
+        const auto &draw = draws[i];
+        const auto program = DrawQueue::program(draw.key);
+        if (i == 0 || program != DrawQueue::program(draws[i - 1].key)) {
+            if (program == LitProgram) {
+                m_state.useProgram(m_program->programId());
+                m_program->setUniformValue(m_uniforms[Uniform::Instanced], m_cubeField.isInstanced());
+            } else {
+                m_state.useProgram(m_lampProgram->programId());
+            }
+        }
+        const auto textureSet = DrawQueue::textureSet(draw.key);
+        if (textureSet == ContainerTextures && (i == 0 || textureSet != DrawQueue::textureSet(draws[i - 1].key))) {
+            m_state.bindTexture(0, GL_TEXTURE_2D, m_texture->textureId());
+            m_state.bindTexture(1, GL_TEXTURE_2D, m_textureSpecular->textureId());
+        }
+
+        if (draw.index == cubesDraw) {
+            m_sceneBatch.draw(0, m_cubeCommands);
+        } else if (draw.index == lampsDraw) {
+            drawLamps();
+        } else {
+            m_state.bindVertexArray(m_sceneBatch.vertexArrayId());
+            m_funcs->glUniformMatrix4fv(m_uniforms[Uniform::Model], 1, GL_FALSE, renderList.model(draw.index));
+            m_meshPool.draw(m_cubeMesh);
+        }
+    }
+    m_renderQueue.endMainPass();
 }
 
-void Window::paintLamps()
+void Window::drawCubes(int modelLocation)
 {
-    m_lampProgram->bind();
-
-    m_lampProgram->setUniformValue("view", m_camera->view());
-    m_lampProgram->setUniformValue("projection", m_camera->projection());
-
-    for (const auto &lightPos: m_lightPositions) {
-        QMatrix4x4 model;
-        model.translate(lightPos);
-        model.scale({0.2f, 0.2f, 0.2f});
-        m_lampProgram->setUniformValue("model", model);
-        QOpenGLVertexArrayObject::Binder vaoBinder(&m_lampVao);
-        m_funcs->glDrawArrays(GL_TRIANGLES, 0, 36);
+    if (m_cubeField.isInstanced()) {
+        m_sceneBatch.draw(0, m_cubeCommands);
+        return;
     }
 
-    // release resources
-    m_lampProgram->release();
+    // the packets are built by RenderQueue::update(), only the uniform is set here
+    const auto &renderList = m_renderQueue.renderList();
+    m_state.bindVertexArray(m_sceneBatch.vertexArrayId());
+    for (int packet = 0; packet < renderList.count(); ++packet) {
+        m_funcs->glUniformMatrix4fv(modelLocation, 1, GL_FALSE, renderList.model(packet));
+        m_meshPool.draw(m_cubeMesh);
+    }
+}
+
+void Window::drawLamps()
+{
+    m_sceneBatch.draw(m_cubeCommands, m_sceneBatch.commandCount() - m_cubeCommands);
 }
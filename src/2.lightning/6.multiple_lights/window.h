@@ -1,14 +1,29 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
-#include <QOpenGLBuffer>
+#include "frameblock.h"
+#include "lightsblock.h"
+
 #include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLTexture>
-#include <QOpenGLVertexArrayObject>
 #include <QOpenGLWindow>
 
+#include <cubefield.h>
+#include <drawbatch.h>
+#include <drawqueue.h>
+#include <entityworld.h>
+#include <frameprofiler.h>
+#include <framescheduler.h>
+#include <meshpool.h>
+#include <renderqueue.h>
+#include <statecache.h>
+#include <streambuffer.h>
+#include <textureloader.h>
+#include <uniformtable.h>
+
 #include <memory>
+#include <vector>
 
 class Camera;
 
@@ -26,31 +41,53 @@ protected:
 
 private:
     void toggleFullScreen();
-    void initializeCubeGeometry();
-    void initializeLampGeometry();
+    void initializeGeometry();
+    void updateBatch();
     void initializeShaders();
     void initializeTextures();
-    void paintCube();
-    void paintLamps();
+    void initializeLights();
+    void uploadLights();
+    void uploadFrameData();
+    void paintDepthPrePass();
+    void paintMainPass();
+    void drawCubes(int modelLocation);
+    void drawLamps();
 
 private:
+    enum class Uniform {
+        Model,
+        Instanced,
+        Count
+    };
+
     QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
+    StateCache m_state;
     std::unique_ptr<Camera> m_camera;
-    QOpenGLBuffer m_vbo {QOpenGLBuffer::VertexBuffer};
-    QOpenGLVertexArrayObject m_vao;
-    QOpenGLBuffer m_lampVbo {QOpenGLBuffer::VertexBuffer};
-    QOpenGLVertexArrayObject m_lampVao;
+    FrameScheduler m_scheduler;
+    FrameProfiler m_profiler;
+    MeshPool m_meshPool;
+    int m_cubeMesh {-1};
+    int m_lampMesh {-1};
+    // the cubes' commands come first, then the lamps'
+    DrawBatch m_sceneBatch;
+    int m_cubeCommands {0};
+    std::vector<QMatrix4x4> m_lampModels;
 //    QVector3D m_lightPos {1.2f, 1.0f, 2.0f};
-    QVector3D m_lightPositions[4] = {
-        { 0.7f,  0.2f,  2.0f},
-        { 2.3f, -3.3f, -4.0f},
-        {-4.0f,  2.0f, -12.0f},
-        { 0.0f,  0.0f, -3.0f}
-    };
+    EntityWorld m_world;
+    CubeField m_cubeField;
+    RenderQueue m_renderQueue;
+    DrawQueue m_drawQueue;
     std::unique_ptr<QOpenGLShaderProgram> m_program;
     std::unique_ptr<QOpenGLShaderProgram> m_lampProgram;
-    std::unique_ptr<QOpenGLTexture> m_texture;
-    std::unique_ptr<QOpenGLTexture> m_textureSpecular;
+    UniformLocations<Uniform> m_uniforms;
+    TextureLoader m_textureLoader;
+    QOpenGLTexture *m_texture {nullptr};
+    QOpenGLTexture *m_textureSpecular {nullptr};
+    LightsBlock m_lights;
+    // written by uploadLights() when the lights have changed
+    GLuint m_lightsUbo {0};
+    bool m_lightsChanged {true};
+    StreamBuffer m_streamBuffer;
 };
 
 #endif // WINDOW_H
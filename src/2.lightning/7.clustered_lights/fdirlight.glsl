@@ -0,0 +1,46 @@
+#version 330 core
+
+struct DirLight {
+    vec3 direction;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+out vec4 FragColor;
+
+uniform sampler2D gPosition;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpecular;
+
+uniform vec3 viewPos;
+uniform float shininess;
+uniform vec3 clearColor;
+uniform DirLight dirLight;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec4 position = texelFetch(gPosition, pixel, 0);
+
+    // restore the scene's depth, so the light volumes and the lamps are depth tested against it
+    gl_FragDepth = position.w;
+    if (position.w == 1.0) {
+        FragColor = vec4(clearColor, 1.0);
+        return;
+    }
+
+    vec3 normal = texelFetch(gNormal, pixel, 0).xyz;
+    vec4 albedoSpecular = texelFetch(gAlbedoSpecular, pixel, 0);
+    vec3 viewDir = normalize(viewPos - position.xyz);
+
+    vec3 lightDir = normalize(-dirLight.direction);
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    vec3 ambient  = dirLight.ambient  * albedoSpecular.rgb;
+    vec3 diffuse  = dirLight.diffuse  * diff * albedoSpecular.rgb;
+    vec3 specular = dirLight.specular * spec * albedoSpecular.a;
+    FragColor = vec4(ambient + diffuse + specular, 1.0);
+}
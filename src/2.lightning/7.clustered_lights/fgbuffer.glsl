@@ -0,0 +1,24 @@
+#version 330 core
+
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+};
+
+in vec2 TexCoords;
+in vec3 FragPos;
+in vec3 Normal;
+
+layout (location = 0) out vec4 gPosition;
+layout (location = 1) out vec4 gNormal;
+layout (location = 2) out vec4 gAlbedoSpecular;
+
+uniform Material material;
+
+void main()
+{
+    gPosition = vec4(FragPos, gl_FragCoord.z);
+    gNormal = vec4(normalize(Normal), 0.0);
+    gAlbedoSpecular = vec4(texture(material.diffuse, TexCoords).rgb, texture(material.specular, TexCoords).r);
+}
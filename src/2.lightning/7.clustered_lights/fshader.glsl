@@ -0,0 +1,100 @@
+#version 330 core
+
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+};
+
+struct DirLight {
+    vec3 direction;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+in vec2 TexCoords;
+in vec3 FragPos;
+in vec3 Normal;
+in float ViewDepth;
+
+out vec4 FragColor;
+
+uniform vec3 viewPos;
+
+uniform Material material;
+uniform DirLight dirLight;
+
+// two texels per light: world position and radius, color
+uniform samplerBuffer lights;
+uniform int lightCount;
+
+// (offset, count) into lightIndices for every cluster, see LightClusters
+uniform usamplerBuffer clusters;
+uniform usamplerBuffer lightIndices;
+uniform bool clustered;
+uniform ivec3 gridSize;
+uniform vec2 tileScale;
+uniform vec2 sliceParams;
+
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor);
+vec3 CalcPointLight(int index, vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor);
+
+void main()
+{
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 diffuseColor = vec3(texture(material.diffuse, TexCoords));
+    vec3 specularColor = vec3(texture(material.specular, TexCoords));
+
+    vec3 result = CalcDirLight(dirLight, norm, viewDir, diffuseColor, specularColor);
+    if (clustered) {
+        ivec3 cluster = ivec3(ivec2(gl_FragCoord.xy * tileScale),
+                              int(log(ViewDepth) * sliceParams.x + sliceParams.y));
+        cluster = clamp(cluster, ivec3(0), gridSize - 1);
+        int index = cluster.x + gridSize.x * (cluster.y + gridSize.y * cluster.z);
+        uvec2 range = texelFetch(clusters, index).rg;
+        for (uint i = 0u; i < range.y; i++) {
+            int light = int(texelFetch(lightIndices, int(range.x + i)).r);
+            result += CalcPointLight(light, norm, viewDir, diffuseColor, specularColor);
+        }
+    } else {
+        for (int i = 0; i < lightCount; i++)
+            result += CalcPointLight(i, norm, viewDir, diffuseColor, specularColor);
+    }
+
+    FragColor = vec4(result, 1.0);
+}
+
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor)
+{
+    vec3 lightDir = normalize(-light.direction);
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    vec3 ambient  = light.ambient  * diffuseColor;
+    vec3 diffuse  = light.diffuse  * diff * diffuseColor;
+    vec3 specular = light.specular * spec * specularColor;
+    return (ambient + diffuse + specular);
+}
+
+// The light fades out to zero at its radius, so lights outside of the cluster contribute nothing
+vec3 CalcPointLight(int index, vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor)
+{
+    vec4 positionRadius = texelFetch(lights, 2 * index);
+    vec3 color = texelFetch(lights, 2 * index + 1).rgb;
+
+    vec3 toLight = positionRadius.xyz - FragPos;
+    float distance = length(toLight);
+    if (distance >= positionRadius.w)
+        return vec3(0.0);
+
+    vec3 lightDir = toLight / distance;
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    float falloff = 1.0 - (distance * distance) / (positionRadius.w * positionRadius.w);
+    float attenuation = falloff * falloff / (1.0 + distance * distance);
+    return color * (diff * diffuseColor + spec * specularColor) * attenuation;
+}
@@ -0,0 +1,37 @@
+#version 330 core
+
+flat in vec4 LightPositionRadius;
+flat in vec3 LightColor;
+
+out vec4 FragColor;
+
+uniform sampler2D gPosition;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpecular;
+
+uniform vec3 viewPos;
+uniform float shininess;
+
+// Same light as CalcPointLight() in fshader.glsl, added to the directional light by blending
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec4 position = texelFetch(gPosition, pixel, 0);
+
+    vec3 toLight = LightPositionRadius.xyz - position.xyz;
+    float distance = length(toLight);
+    if (position.w == 1.0 || distance >= LightPositionRadius.w)
+        discard;
+
+    vec3 normal = texelFetch(gNormal, pixel, 0).xyz;
+    vec4 albedoSpecular = texelFetch(gAlbedoSpecular, pixel, 0);
+    vec3 viewDir = normalize(viewPos - position.xyz);
+
+    vec3 lightDir = toLight / distance;
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    float falloff = 1.0 - (distance * distance) / (LightPositionRadius.w * LightPositionRadius.w);
+    float attenuation = falloff * falloff / (1.0 + distance * distance);
+    FragColor = vec4(LightColor * (diff * albedoSpecular.rgb + spec * albedoSpecular.a) * attenuation, 1.0);
+}
@@ -0,0 +1,27 @@
+#include <QGuiApplication>
+
+#include "window.h"
+
+#include <offscreenrunner.h>
+
+int main(int argc, char *argv[])
+{
+    QGuiApplication a(argc, argv);
+
+    QSurfaceFormat fmt;
+    // NOTE: default depth buffer size is -1
+    fmt.setDepthBufferSize(24);
+    fmt.setVersion(3, 2);
+    fmt.setProfile(QSurfaceFormat::CoreProfile);
+    QSurfaceFormat::setDefaultFormat(fmt);
+
+    OffscreenRunner runner(a.arguments());
+
+    Window w;
+    if (runner.isEnabled())
+        return runner.exec(&w);
+
+    w.show();
+
+    return QCoreApplication::exec();
+}
@@ -0,0 +1,17 @@
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 3) in vec4 lightPositionRadius;
+layout (location = 4) in vec4 lightColor;
+
+out vec3 LampColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float scale;
+
+void main()
+{
+    gl_Position = projection * view * vec4(position * scale + lightPositionRadius.xyz, 1.0f);
+    LampColor = lightColor.rgb;
+}
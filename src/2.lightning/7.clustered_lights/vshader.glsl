@@ -0,0 +1,37 @@
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 texcoords;
+layout (location = 3) in mat4 instanceModel;
+layout (location = 7) in mat3 instanceNormalMatrix;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+out float ViewDepth;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform bool instanced;
+
+void main()
+{
+    mat4 cubeModel = model;
+    mat3 normalMatrix;
+    if (instanced) {
+        cubeModel = instanceModel;
+        normalMatrix = instanceNormalMatrix;
+    } else {
+        normalMatrix = mat3(transpose(inverse(model)));
+    }
+
+    vec4 worldPos = cubeModel * vec4(position, 1.0f);
+    vec4 viewPos = view * worldPos;
+    gl_Position = projection * viewPos;
+    FragPos = vec3(worldPos);
+    Normal = normalMatrix * normal;
+    TexCoords = texcoords;
+    ViewDepth = -viewPos.z;
+}
@@ -0,0 +1,20 @@
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 3) in vec4 lightPositionRadius;
+layout (location = 4) in vec4 lightColor;
+
+flat out vec4 LightPositionRadius;
+flat out vec3 LightColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float volumeScale;
+
+void main()
+{
+    vec3 worldPos = position * lightPositionRadius.w * volumeScale + lightPositionRadius.xyz;
+    gl_Position = projection * view * vec4(worldPos, 1.0f);
+    LightPositionRadius = lightPositionRadius;
+    LightColor = lightColor.rgb;
+}
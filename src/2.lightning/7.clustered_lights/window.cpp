@@ -0,0 +1,623 @@
+#include "window.h"
+#include "camera.h"
+
+#include <glfunctions.h>
+#include <programcache.h>
+
+#include <QtGui/QColor>
+#include <QtGui/QKeyEvent>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
+
+namespace {
+
+// setup vertex data
+
+constexpr const GLfloat vertices[] = {
+    // positions          // normals           // texture coords
+    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
+     0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
+
+    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
+
+    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+
+     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+
+    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 0.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
+
+    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
+};
+
+constexpr int maxLights = 0x10000;
+
+// texture units of the buffer textures, 0 and 1 are the material's
+constexpr int lightsUnit = 2;
+constexpr int clustersUnit = 3;
+constexpr int lightIndicesUnit = 4;
+
+// the G-buffer's attachments take units 2-4 in the deferred lighting passes
+constexpr int gbufferUnit = 2;
+
+constexpr float lampScale = 0.1f;
+
+// the sphere's faces lie inside the unit sphere, so it is scaled up to cover the light's radius
+constexpr int volumeSlices = 16;
+constexpr int volumeStacks = 12;
+constexpr float volumeScale = 1.1f;
+
+constexpr QVector3D clearColor {0.02f, 0.02f, 0.02f};
+
+const char *shadingName(int shading)
+{
+    static const char *names[] = {"Forward", "Clustered", "Deferred"};
+    return names[shading];
+}
+
+} // namespace
+
+Window::Window() :
+    m_camera(std::make_unique<Camera>()),
+    m_scheduler(this, QCoreApplication::arguments()),
+    m_profiler(QCoreApplication::arguments()),
+    m_cube(Mesh::vertexFormat(QCoreApplication::arguments())),
+    m_cubeField(QCoreApplication::arguments()),
+    m_textureLoader(this)
+{
+    resize(640, 480);
+
+    const auto arguments = QCoreApplication::arguments();
+    for (int i = 1; i < arguments.size(); ++i) {
+        if (arguments.at(i) == QLatin1String("--lights") && i + 1 < arguments.size())
+            m_lightCount = std::min(std::max(1, arguments.at(++i).toInt()), maxLights);
+        else if (arguments.at(i) == QLatin1String("--naive"))
+            m_shading = Shading::Forward;
+        else if (arguments.at(i) == QLatin1String("--deferred"))
+            m_shading = Shading::Deferred;
+    }
+
+    m_camera->setWindow(this);
+
+    connect(&m_scheduler, &FrameScheduler::step, m_camera.get(), &Camera::advance);
+    connect(&m_scheduler, &FrameScheduler::step, this, [this](float seconds) { m_time += seconds; });
+    connect(&m_scheduler, &FrameScheduler::frame, m_camera.get(), &Camera::interpolate);
+    m_scheduler.start();
+}
+
+Window::~Window()
+{
+    makeCurrent();
+    m_profiler.destroy();
+    m_textureLoader.destroy();
+    m_cubeField.destroy();
+    m_gbuffer.destroy();
+    m_sphere.destroy();
+    if (m_funcs) {
+        const GLuint textures[] = {m_lightsTexture, m_clustersTexture, m_lightIndicesTexture};
+        m_funcs->glDeleteTextures(3, textures);
+        const GLuint buffers[] = {m_lightsBuffer, m_clustersBuffer, m_lightIndicesBuffer};
+        m_funcs->glDeleteBuffers(3, buffers);
+    }
+    m_cube.destroy();
+    doneCurrent();
+}
+
+void Window::initializeGL()
+{
+    m_funcs = resolveCoreFunctions();
+    if (!m_funcs) {
+        close();
+        return;
+    }
+    m_funcs->glEnable(GL_DEPTH_TEST);
+
+    initializeLights();
+    initializeCubeGeometry();
+    initializeLampGeometry();
+    initializeVolumeGeometry();
+    initializeShaders();
+    initializeTextures();
+
+    m_profiler.create(this);
+}
+
+void Window::resizeGL(int w, int h)
+{
+    if (!m_funcs) {
+        return;
+    }
+
+    m_funcs->glViewport(0, 0, w, h);
+}
+
+void Window::paintGL()
+{
+    if (!m_funcs) {
+        return;
+    }
+
+    m_profiler.beginFrame();
+
+    m_textureLoader.update(m_funcs);
+
+    // w and h of resizeGL() are in device-independent pixels, but QOpenGLWindow sets the viewport
+    // to the framebuffer's size in device pixels before paintGL() (and the offscreen runner
+    // to its FBO's size), which is what gl_FragCoord is in
+    GLint viewport[4] {};
+    m_funcs->glGetIntegerv(GL_VIEWPORT, viewport);
+    m_framebufferSize = QSize(viewport[2], viewport[3]);
+
+    m_funcs->glClearColor(clearColor.x(), clearColor.y(), clearColor.z(), 1.0f);
+    m_funcs->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    updateLights();
+    if (m_shading == Shading::Deferred)
+        paintDeferred();
+    else
+        paintCube();
+    paintLamps();
+
+    m_profiler.endFrame();
+}
+
+void Window::keyPressEvent(QKeyEvent *event)
+{
+    if (event->key() == Qt::Key_Escape) {
+        close();
+    } else if (event->key() == Qt::Key_F) {
+        toggleFullScreen();
+    } else if (event->key() == Qt::Key_I) {
+        m_cubeField.setInstanced(!m_cubeField.isInstanced());
+    } else if (event->key() == Qt::Key_C) {
+        m_shading = Shading((int(m_shading) + 1) % 3);
+        qDebug() << shadingName(int(m_shading)) << "shading of" << m_lightCount << "lights";
+    }
+
+    QOpenGLWindow::keyPressEvent(event);
+}
+
+void Window::toggleFullScreen()
+{
+    if (windowState() != Qt::WindowState::WindowFullScreen)
+        showFullScreen();
+    else
+        showNormal();
+}
+
+void Window::initializeCubeGeometry()
+{
+    m_vao.create();
+    QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
+
+    m_cube.create(m_funcs, vertices);
+
+    // Instance model and normal matrices
+    m_cubeField.createInstanceBuffer(m_funcs, 3, 7);
+}
+
+void Window::initializeLampGeometry()
+{
+    m_lampVao.create();
+    QOpenGLVertexArrayObject::Binder vaoBinder(&m_lampVao);
+
+    m_cube.setupAttributes();
+    setupLightAttributes();
+}
+
+void Window::initializeVolumeGeometry()
+{
+    m_volumeVao.create();
+    QOpenGLVertexArrayObject::Binder vaoBinder(&m_volumeVao);
+
+    const auto sphere = Mesh::sphereVertices(volumeSlices, volumeStacks);
+    m_sphere.create(m_funcs, sphere.data(), int(sphere.size()) / Mesh::FloatsPerVertex);
+    setupLightAttributes();
+
+    // the fullscreen pass generates its vertices, but core profile still needs a VAO
+    m_quadVao.create();
+}
+
+void Window::setupLightAttributes()
+{
+    // every lamp and light volume reads its position and color straight from the lights buffer
+    m_funcs->glBindBuffer(GL_ARRAY_BUFFER, m_lightsBuffer);
+    m_funcs->glEnableVertexAttribArray(3);
+    m_funcs->glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(LightData),
+                                   reinterpret_cast<GLvoid *>(offsetof(LightData, positionRadius)));
+    m_funcs->glVertexAttribDivisor(3, 1);
+    m_funcs->glEnableVertexAttribArray(4);
+    m_funcs->glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(LightData),
+                                   reinterpret_cast<GLvoid *>(offsetof(LightData, color)));
+    m_funcs->glVertexAttribDivisor(4, 1);
+    m_funcs->glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Window::initializeShaders()
+{
+    m_program = std::make_unique<QOpenGLShaderProgram>();
+    ProgramCache::link(m_program.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/fshader.glsl")},
+    });
+    m_uniforms.resolve(m_program.get(), {{
+        "view",
+        "projection",
+        "viewPos",
+        "model",
+        "instanced",
+        "lightCount",
+        "clustered",
+        "gridSize",
+        "tileScale",
+        "sliceParams",
+    }});
+
+    // samplers, material and the directional light never change, so they are set only once
+    m_program->bind();
+    m_program->setUniformValue("material.diffuse", 0);
+    m_program->setUniformValue("material.specular", 1);
+    m_program->setUniformValue("material.shininess", 32.0f);
+    m_program->setUniformValue("lights", lightsUnit);
+    m_program->setUniformValue("clusters", clustersUnit);
+    m_program->setUniformValue("lightIndices", lightIndicesUnit);
+
+    m_program->setUniformValue("dirLight.direction", QVector3D(-0.2f, -1.0f, -0.3f));
+    m_program->setUniformValue("dirLight.ambient", QVector3D(0.02f, 0.02f, 0.02f));
+    m_program->setUniformValue("dirLight.diffuse", QVector3D(0.05f, 0.05f, 0.05f));
+    m_program->setUniformValue("dirLight.specular", QVector3D(0.1f, 0.1f, 0.1f));
+    m_program->release();
+
+    m_lampProgram = std::make_unique<QOpenGLShaderProgram>();
+    ProgramCache::link(m_lampProgram.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vlamp.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/flamp.glsl")},
+    });
+    m_lampUniforms.resolve(m_lampProgram.get(), {{
+        "view",
+        "projection",
+        "scale",
+    }});
+
+    m_gbufferProgram = std::make_unique<QOpenGLShaderProgram>();
+    ProgramCache::link(m_gbufferProgram.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vshader.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/fgbuffer.glsl")},
+    });
+    m_gbufferUniforms.resolve(m_gbufferProgram.get(), {{
+        "view",
+        "projection",
+        "model",
+        "instanced",
+    }});
+    m_gbufferProgram->bind();
+    m_gbufferProgram->setUniformValue("material.diffuse", 0);
+    m_gbufferProgram->setUniformValue("material.specular", 1);
+    m_gbufferProgram->release();
+
+    const auto setGBufferUniforms = [](QOpenGLShaderProgram *program) {
+        program->bind();
+        program->setUniformValue("gPosition", gbufferUnit + GBuffer::Position);
+        program->setUniformValue("gNormal", gbufferUnit + GBuffer::Normal);
+        program->setUniformValue("gAlbedoSpecular", gbufferUnit + GBuffer::AlbedoSpecular);
+        program->setUniformValue("shininess", 32.0f);
+    };
+
+    m_dirLightProgram = std::make_unique<QOpenGLShaderProgram>();
+    ProgramCache::link(m_dirLightProgram.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vquad.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/fdirlight.glsl")},
+    });
+    m_dirLightUniforms.resolve(m_dirLightProgram.get(), {{
+        "viewPos",
+    }});
+    setGBufferUniforms(m_dirLightProgram.get());
+    m_dirLightProgram->setUniformValue("clearColor", clearColor);
+    m_dirLightProgram->setUniformValue("dirLight.direction", QVector3D(-0.2f, -1.0f, -0.3f));
+    m_dirLightProgram->setUniformValue("dirLight.ambient", QVector3D(0.02f, 0.02f, 0.02f));
+    m_dirLightProgram->setUniformValue("dirLight.diffuse", QVector3D(0.05f, 0.05f, 0.05f));
+    m_dirLightProgram->setUniformValue("dirLight.specular", QVector3D(0.1f, 0.1f, 0.1f));
+    m_dirLightProgram->release();
+
+    m_volumeProgram = std::make_unique<QOpenGLShaderProgram>();
+    ProgramCache::link(m_volumeProgram.get(), {
+        {QOpenGLShader::Vertex, QStringLiteral(":/vvolume.glsl")},
+        {QOpenGLShader::Fragment, QStringLiteral(":/fvolume.glsl")},
+    });
+    m_volumeUniforms.resolve(m_volumeProgram.get(), {{
+        "view",
+        "projection",
+        "viewPos",
+    }});
+    setGBufferUniforms(m_volumeProgram.get());
+    m_volumeProgram->setUniformValue("volumeScale", volumeScale);
+    m_volumeProgram->release();
+}
+
+void Window::initializeTextures()
+{
+    m_texture = m_textureLoader.load(QStringLiteral(":/container2.png"), TextureLoader::Mirrored);
+    m_textureSpecular = m_textureLoader.load(QStringLiteral(":/container2_specular.png"), TextureLoader::Mirrored,
+                                             qRgb(0, 0, 0));
+}
+
+void Window::initializeLights()
+{
+    // lights are scattered around the cubes
+    QVector3D min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                  std::numeric_limits<float>::max());
+    QVector3D max(-min);
+    for (const auto &model: m_cubeField.models()) {
+        const auto position = model.column(3).toVector3D();
+        for (int i = 0; i < 3; ++i) {
+            min[i] = std::min(min[i], position[i] - 1.5f);
+            max[i] = std::max(max[i], position[i] + 1.5f);
+        }
+    }
+
+    // the radius keeps roughly a dozen lights over every point regardless of the light count
+    const auto size = max - min;
+    const auto volume = size.x() * size.y() * size.z();
+    const auto radius = std::min(std::max(std::cbrt(12.0f * volume / (float(M_PI) * m_lightCount)), 0.5f), 6.0f);
+
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    m_lights.resize(size_t(m_lightCount));
+    m_lightPhases.resize(size_t(m_lightCount));
+    for (size_t i = 0; i < m_lights.size(); ++i) {
+        const QVector3D position(min.x() + unit(generator) * size.x(),
+                                 min.y() + unit(generator) * size.y(),
+                                 min.z() + unit(generator) * size.z());
+        const auto color = QColor::fromHsvF(unit(generator), 0.7f, 1.0f);
+        m_lights[i].positionRadius = QVector4D(position, radius);
+        m_lights[i].color = QVector4D(float(color.redF()), float(color.greenF()), float(color.blueF()), 1.0f);
+        m_lightPhases[i] = unit(generator) * 2.0f * float(M_PI);
+    }
+    m_frameLights = m_lights;
+    m_viewLights.resize(m_lights.size());
+
+    qDebug() << "Lights:" << m_lightCount << "with radius" << radius;
+
+    const auto createBufferTexture = [this](GLuint *buffer, GLuint *texture, GLenum format) {
+        m_funcs->glGenBuffers(1, buffer);
+        m_funcs->glBindBuffer(GL_TEXTURE_BUFFER, *buffer);
+        m_funcs->glBufferData(GL_TEXTURE_BUFFER, 4, nullptr, GL_STREAM_DRAW);
+        m_funcs->glGenTextures(1, texture);
+        m_funcs->glBindTexture(GL_TEXTURE_BUFFER, *texture);
+        m_funcs->glTexBuffer(GL_TEXTURE_BUFFER, format, *buffer);
+    };
+    createBufferTexture(&m_lightsBuffer, &m_lightsTexture, GL_RGBA32F);
+    createBufferTexture(&m_clustersBuffer, &m_clustersTexture, GL_RG32UI);
+    createBufferTexture(&m_lightIndicesBuffer, &m_lightIndicesTexture, GL_R16UI);
+    m_funcs->glBindTexture(GL_TEXTURE_BUFFER, 0);
+    m_funcs->glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void Window::updateLights()
+{
+    ProfileScope scope(m_profiler, "lights");
+
+    const auto view = m_camera->view();
+    for (size_t i = 0; i < m_lights.size(); ++i) {
+        auto position = m_lights[i].positionRadius.toVector3D();
+        position.setY(position.y() + 0.5f * float(std::sin(m_time + m_lightPhases[i])));
+        const auto radius = m_lights[i].positionRadius.w();
+        m_frameLights[i].positionRadius = QVector4D(position, radius);
+        m_viewLights[i] = QVector4D(view.map(position), radius);
+    }
+
+    // the buffers are orphaned every frame, so the driver never waits for the previous frame
+    m_funcs->glBindBuffer(GL_TEXTURE_BUFFER, m_lightsBuffer);
+    m_funcs->glBufferData(GL_TEXTURE_BUFFER, GLsizeiptr(m_frameLights.size() * sizeof(LightData)),
+                          m_frameLights.data(), GL_STREAM_DRAW);
+
+    if (m_shading == Shading::Clustered) {
+        m_clusters.setProjection(m_camera->projection());
+        m_clusters.build(m_viewLights);
+
+        const auto &grid = m_clusters.grid();
+        m_funcs->glBindBuffer(GL_TEXTURE_BUFFER, m_clustersBuffer);
+        m_funcs->glBufferData(GL_TEXTURE_BUFFER, GLsizeiptr(grid.size() * sizeof(quint32)),
+                              grid.data(), GL_STREAM_DRAW);
+
+        // an empty buffer can't back a texture, keep at least one index
+        const auto &indices = m_clusters.lightIndices();
+        const quint16 none = 0;
+        m_funcs->glBindBuffer(GL_TEXTURE_BUFFER, m_lightIndicesBuffer);
+        m_funcs->glBufferData(GL_TEXTURE_BUFFER, GLsizeiptr(std::max<size_t>(indices.size(), 1) * sizeof(quint16)),
+                              indices.empty() ? &none : indices.data(), GL_STREAM_DRAW);
+    }
+
+    m_funcs->glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void Window::paintCube()
+{
+    ProfileScope scope(m_profiler, "paintCube");
+
+    m_program->bind();
+
+    m_program->setUniformValue(m_uniforms[Uniform::View], m_camera->view());
+    m_program->setUniformValue(m_uniforms[Uniform::Projection], m_camera->projection());
+    m_program->setUniformValue(m_uniforms[Uniform::ViewPos], m_camera->position());
+    m_program->setUniformValue(m_uniforms[Uniform::Instanced], m_cubeField.isInstanced());
+
+    m_program->setUniformValue(m_uniforms[Uniform::LightCount], m_lightCount);
+    const bool clustered = m_shading == Shading::Clustered;
+    m_program->setUniformValue(m_uniforms[Uniform::Clustered], clustered);
+    if (clustered) {
+        m_funcs->glUniform3i(m_uniforms[Uniform::GridSize],
+                             LightClusters::TilesX, LightClusters::TilesY, LightClusters::Slices);
+        m_program->setUniformValue(m_uniforms[Uniform::TileScale],
+                                   QVector2D(float(LightClusters::TilesX) / m_framebufferSize.width(),
+                                             float(LightClusters::TilesY) / m_framebufferSize.height()));
+        m_program->setUniformValue(m_uniforms[Uniform::SliceParams],
+                                   QVector2D(m_clusters.sliceScale(), m_clusters.sliceBias()));
+    }
+
+    m_funcs->glActiveTexture(GL_TEXTURE0);
+    m_texture->bind();
+
+    m_funcs->glActiveTexture(GL_TEXTURE1);
+    m_textureSpecular->bind();
+
+    m_funcs->glActiveTexture(GL_TEXTURE0 + lightsUnit);
+    m_funcs->glBindTexture(GL_TEXTURE_BUFFER, m_lightsTexture);
+    m_funcs->glActiveTexture(GL_TEXTURE0 + clustersUnit);
+    m_funcs->glBindTexture(GL_TEXTURE_BUFFER, m_clustersTexture);
+    m_funcs->glActiveTexture(GL_TEXTURE0 + lightIndicesUnit);
+    m_funcs->glBindTexture(GL_TEXTURE_BUFFER, m_lightIndicesTexture);
+
+    {
+        ProfileScope drawScope(m_profiler, "draw");
+        drawCubes(m_program.get(), m_uniforms[Uniform::Model]);
+    }
+
+    // release resources
+    for (const auto unit: {lightIndicesUnit, clustersUnit, lightsUnit}) {
+        m_funcs->glActiveTexture(GLenum(GL_TEXTURE0 + unit));
+        m_funcs->glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+    m_funcs->glActiveTexture(GL_TEXTURE1);
+    m_textureSpecular->release();
+    m_funcs->glActiveTexture(GL_TEXTURE0);
+    m_texture->release();
+    m_program->release();
+}
+
+// The cubes are drawn once into the G-buffer, then the directional light is applied with
+// a fullscreen pass and every point light shades only the pixels covered by its light volume.
+void Window::paintDeferred()
+{
+    if (!m_gbuffer.create(m_funcs, m_framebufferSize))
+        return;
+
+    {
+        ProfileScope scope(m_profiler, "geometry");
+
+        m_gbuffer.bind();
+        m_gbufferProgram->bind();
+        m_gbufferProgram->setUniformValue(m_gbufferUniforms[GBufferUniform::View], m_camera->view());
+        m_gbufferProgram->setUniformValue(m_gbufferUniforms[GBufferUniform::Projection], m_camera->projection());
+        m_gbufferProgram->setUniformValue(m_gbufferUniforms[GBufferUniform::Instanced], m_cubeField.isInstanced());
+
+        m_funcs->glActiveTexture(GL_TEXTURE0);
+        m_texture->bind();
+        m_funcs->glActiveTexture(GL_TEXTURE1);
+        m_textureSpecular->bind();
+
+        drawCubes(m_gbufferProgram.get(), m_gbufferUniforms[GBufferUniform::Model]);
+
+        m_textureSpecular->release();
+        m_funcs->glActiveTexture(GL_TEXTURE0);
+        m_texture->release();
+        m_gbufferProgram->release();
+        m_gbuffer.release();
+    }
+
+    ProfileScope scope(m_profiler, "lighting");
+
+    m_gbuffer.bindTextures(gbufferUnit);
+
+    // the fullscreen pass also writes the G-buffer's depth into the window's depth buffer
+    m_funcs->glDepthFunc(GL_ALWAYS);
+    m_dirLightProgram->bind();
+    m_dirLightProgram->setUniformValue(m_dirLightUniforms[DirLightUniform::ViewPos], m_camera->position());
+    {
+        QOpenGLVertexArrayObject::Binder vaoBinder(&m_quadVao);
+        m_funcs->glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    m_dirLightProgram->release();
+
+    // Back faces of the volumes pass the depth test only where the surface is in front of them,
+    // front faces are culled so a volume still shades when the camera is inside of it
+    m_funcs->glDepthFunc(GL_GEQUAL);
+    m_funcs->glDepthMask(GL_FALSE);
+    m_funcs->glEnable(GL_CULL_FACE);
+    m_funcs->glCullFace(GL_FRONT);
+    m_funcs->glEnable(GL_BLEND);
+    m_funcs->glBlendFunc(GL_ONE, GL_ONE);
+
+    m_volumeProgram->bind();
+    m_volumeProgram->setUniformValue(m_volumeUniforms[VolumeUniform::View], m_camera->view());
+    m_volumeProgram->setUniformValue(m_volumeUniforms[VolumeUniform::Projection], m_camera->projection());
+    m_volumeProgram->setUniformValue(m_volumeUniforms[VolumeUniform::ViewPos], m_camera->position());
+    {
+        QOpenGLVertexArrayObject::Binder vaoBinder(&m_volumeVao);
+        m_sphere.drawInstanced(m_lightCount);
+    }
+    m_volumeProgram->release();
+
+    m_funcs->glDisable(GL_BLEND);
+    m_funcs->glCullFace(GL_BACK);
+    m_funcs->glDisable(GL_CULL_FACE);
+    m_funcs->glDepthMask(GL_TRUE);
+    m_funcs->glDepthFunc(GL_LESS);
+
+    m_gbuffer.releaseTextures(gbufferUnit);
+}
+
+void Window::paintLamps()
+{
+    ProfileScope scope(m_profiler, "paintLamps");
+
+    m_lampProgram->bind();
+
+    m_lampProgram->setUniformValue(m_lampUniforms[LampUniform::View], m_camera->view());
+    m_lampProgram->setUniformValue(m_lampUniforms[LampUniform::Projection], m_camera->projection());
+    m_lampProgram->setUniformValue(m_lampUniforms[LampUniform::Scale], lampScale);
+
+    QOpenGLVertexArrayObject::Binder vaoBinder(&m_lampVao);
+    m_cube.drawInstanced(m_lightCount);
+
+    // release resources
+    m_lampProgram->release();
+}
+
+void Window::drawCubes(QOpenGLShaderProgram *program, int modelLocation)
+{
+    QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
+    if (m_cubeField.isInstanced()) {
+        m_cube.drawInstanced(m_cubeField.count());
+    } else {
+        for (const auto &model: m_cubeField.models()) {
+            program->setUniformValue(modelLocation, model);
+            m_cube.draw();
+        }
+    }
+}
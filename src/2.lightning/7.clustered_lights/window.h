@@ -0,0 +1,151 @@
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLTexture>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLWindow>
+
+#include <cubefield.h>
+#include <frameprofiler.h>
+#include <framescheduler.h>
+#include <gbuffer.h>
+#include <lightclusters.h>
+#include <mesh.h>
+#include <textureloader.h>
+#include <uniformtable.h>
+
+#include <memory>
+#include <vector>
+
+class Camera;
+
+class Window : public QOpenGLWindow
+{
+public:
+    Window();
+    ~Window() override;
+
+protected:
+    void initializeGL() override;
+    void resizeGL(int w, int h) override;
+    void paintGL() override;
+    void keyPressEvent(QKeyEvent *event) override;
+
+private:
+    void toggleFullScreen();
+    void initializeCubeGeometry();
+    void initializeLampGeometry();
+    void initializeVolumeGeometry();
+    void setupLightAttributes();
+    void initializeShaders();
+    void initializeTextures();
+    void initializeLights();
+    void updateLights();
+    void paintCube();
+    void paintDeferred();
+    void paintLamps();
+    void drawCubes(QOpenGLShaderProgram *program, int modelLocation);
+
+private:
+    enum class Shading {
+        Forward,
+        Clustered,
+        Deferred
+    };
+
+    enum class Uniform {
+        View,
+        Projection,
+        ViewPos,
+        Model,
+        Instanced,
+        LightCount,
+        Clustered,
+        GridSize,
+        TileScale,
+        SliceParams,
+        Count
+    };
+
+    enum class LampUniform {
+        View,
+        Projection,
+        Scale,
+        Count
+    };
+
+    enum class GBufferUniform {
+        View,
+        Projection,
+        Model,
+        Instanced,
+        Count
+    };
+
+    enum class DirLightUniform {
+        ViewPos,
+        Count
+    };
+
+    enum class VolumeUniform {
+        View,
+        Projection,
+        ViewPos,
+        Count
+    };
+
+    // matches the lights buffer texture, two RGBA32F texels per light
+    struct LightData
+    {
+        QVector4D positionRadius;
+        QVector4D color;
+    };
+
+    QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
+    std::unique_ptr<Camera> m_camera;
+    FrameScheduler m_scheduler;
+    FrameProfiler m_profiler;
+    Mesh m_cube;
+    QOpenGLVertexArrayObject m_vao;
+    QOpenGLVertexArrayObject m_lampVao;
+    Mesh m_sphere;
+    QOpenGLVertexArrayObject m_volumeVao;
+    QOpenGLVertexArrayObject m_quadVao;
+    CubeField m_cubeField;
+    std::unique_ptr<QOpenGLShaderProgram> m_program;
+    std::unique_ptr<QOpenGLShaderProgram> m_lampProgram;
+    UniformLocations<Uniform> m_uniforms;
+    UniformLocations<LampUniform> m_lampUniforms;
+    std::unique_ptr<QOpenGLShaderProgram> m_gbufferProgram;
+    std::unique_ptr<QOpenGLShaderProgram> m_dirLightProgram;
+    std::unique_ptr<QOpenGLShaderProgram> m_volumeProgram;
+    UniformLocations<GBufferUniform> m_gbufferUniforms;
+    UniformLocations<DirLightUniform> m_dirLightUniforms;
+    UniformLocations<VolumeUniform> m_volumeUniforms;
+    GBuffer m_gbuffer;
+    TextureLoader m_textureLoader;
+    QOpenGLTexture *m_texture {nullptr};
+    QOpenGLTexture *m_textureSpecular {nullptr};
+
+    int m_lightCount {256};
+    Shading m_shading {Shading::Clustered};
+    double m_time {0.0};
+    // in device pixels
+    QSize m_framebufferSize;
+    std::vector<LightData> m_lights;
+    std::vector<float> m_lightPhases;
+    std::vector<LightData> m_frameLights;
+    std::vector<QVector4D> m_viewLights;
+    LightClusters m_clusters;
+
+    GLuint m_lightsBuffer {0};
+    GLuint m_clustersBuffer {0};
+    GLuint m_lightIndicesBuffer {0};
+    GLuint m_lightsTexture {0};
+    GLuint m_clustersTexture {0};
+    GLuint m_lightIndicesTexture {0};
+};
+
+#endif // WINDOW_H
@@ -0,0 +1,118 @@
+#include <bvh.h>
+#include <frustumculler.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// Measures building, refitting and querying Bvh for 10k, 100k and 1M randomly placed unit cubes.
+// Frustum queries are compared with the flat FrustumCuller over the same boxes, picking casts
+// rays from the origin in random directions.
+
+namespace {
+
+std::vector<Bvh::Box> randomBoxes(int count, std::mt19937 &generator)
+{
+    std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+    const QVector3D extent(0.5f, 0.5f, 0.5f);
+
+    std::vector<Bvh::Box> result;
+    result.reserve(size_t(count));
+    for (int i = 0; i < count; ++i) {
+        const QVector3D center(position(generator), position(generator), position(generator));
+        result.push_back({center - extent, center + extent});
+    }
+    return result;
+}
+
+QMatrix4x4 viewProjection(const QMatrix4x4 &projection, int iteration)
+{
+    QMatrix4x4 view;
+    view.rotate(float(iteration) * 7.0f, {0.0f, 1.0f, 0.0f});
+    return projection * view;
+}
+
+template<typename Function>
+double measure(int iterations, Function function)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i)
+        function(i);
+    return double(timer.nsecsElapsed()) / iterations / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    const auto arguments = a.arguments();
+    const int iterations = arguments.size() > 1 ? std::max(1, arguments.at(1).toInt()) : 20;
+    constexpr int rayCount = 1000;
+    constexpr int movedPercent = 1;
+
+    QMatrix4x4 projection;
+    projection.perspective(45.0f, 640.0f / 480.0f, 0.1f, 100.0f);
+
+    qInfo().noquote() << QStringLiteral("%1 iterations, %2 rays, %3% of the objects moved per refit")
+                         .arg(iterations).arg(rayCount).arg(movedPercent);
+    qInfo().noquote() << QStringLiteral("objects   nodes depth   build ms   refit ms   moved ms   "
+                                        "bvh cull ms   flat cull ms   pick us/ray");
+    for (const int count: {10000, 100000, 1000000}) {
+        std::mt19937 generator(42);
+        auto boxes = randomBoxes(count, generator);
+
+        Bvh bvh;
+        const auto build = measure(iterations, [&](int) { bvh.build(boxes); });
+        const auto refit = measure(iterations, [&](int) { bvh.refit(boxes); });
+
+        // every object moves back and forth along x, the BVH's topology stays valid
+        const auto moved = count * movedPercent / 100;
+        const auto move = measure(iterations, [&](int i) {
+            const QVector3D offset(i % 2 ? -1.0f : 1.0f, 0.0f, 0.0f);
+            for (int object = 0; object < moved; ++object) {
+                auto &box = boxes[size_t(object)];
+                box = {box.min + offset, box.max + offset};
+                bvh.setBox(object, box);
+            }
+        });
+
+        std::vector<int> visible;
+        const auto bvhCull = measure(iterations, [&](int i) {
+            visible.clear();
+            bvh.cull(viewProjection(projection, i), visible);
+        });
+
+        FrustumCuller culler;
+        culler.setBoxes(boxes);
+        const auto flatCull = measure(iterations, [&](int i) {
+            culler.setViewProjection(viewProjection(projection, i));
+            culler.cull();
+        });
+
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::vector<QVector3D> directions(rayCount);
+        for (auto &direction: directions)
+            direction = QVector3D(unit(generator), unit(generator), unit(generator)).normalized();
+        const auto pick = measure(rayCount, [&](int i) { bvh.pick({}, directions[size_t(i)]); }) * 1e3;
+
+        qInfo().noquote() << QStringLiteral("%1 %2 %3 %4 %5 %6 %7 %8 %9")
+                             .arg(count, 7)
+                             .arg(bvh.nodeCount(), 9)
+                             .arg(bvh.depth(), 5)
+                             .arg(build, 10, 'f', 3)
+                             .arg(refit, 10, 'f', 3)
+                             .arg(move, 10, 'f', 3)
+                             .arg(bvhCull, 13, 'f', 3)
+                             .arg(flatCull, 14, 'f', 3)
+                             .arg(pick, 13, 'f', 3);
+    }
+
+    return 0;
+}
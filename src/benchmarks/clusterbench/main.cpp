@@ -0,0 +1,78 @@
+#include <lightclusters.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+
+#include <algorithm>
+#include <random>
+
+// Measures how long LightClusters::build() takes for an increasing number of lights,
+// with and without SSE. The lights are spread over the view frustum of 7.clustered_lights.
+
+namespace {
+
+std::vector<QVector4D> randomLights(int count, float radius)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> depth(0.5f, 60.0f);
+
+    std::vector<QVector4D> result;
+    result.reserve(size_t(count));
+    for (int i = 0; i < count; ++i) {
+        const auto z = depth(generator);
+        result.emplace_back(unit(generator) * z * 0.55f, unit(generator) * z * 0.42f, -z, radius);
+    }
+    return result;
+}
+
+double measure(LightClusters &clusters, const std::vector<QVector4D> &lights, int iterations)
+{
+    clusters.build(lights);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i)
+        clusters.build(lights);
+    return double(timer.nsecsElapsed()) / iterations / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    const auto arguments = a.arguments();
+    const int iterations = arguments.size() > 1 ? std::max(1, arguments.at(1).toInt()) : 100;
+    const float radius = arguments.size() > 2 ? std::max(0.1f, arguments.at(2).toFloat()) : 2.0f;
+
+    QMatrix4x4 projection;
+    projection.perspective(45.0f, 640.0f / 480.0f, 0.1f, 100.0f);
+
+    LightClusters clusters;
+    clusters.setProjection(projection);
+
+    qInfo().noquote() << QStringLiteral("%1 clusters, light radius %2, %3 iterations")
+                         .arg(LightClusters::ClusterCount).arg(radius).arg(iterations);
+    qInfo().noquote() << QStringLiteral("lights   scalar ms   simd ms   speedup   lights/cluster");
+    for (int count = 64; count <= 0x10000; count *= 2) {
+        const auto lights = randomLights(count, radius);
+
+        clusters.setSimdEnabled(false);
+        const auto scalar = measure(clusters, lights, iterations);
+        clusters.setSimdEnabled(true);
+        const auto simd = measure(clusters, lights, iterations);
+
+        const auto perCluster = double(clusters.lightIndices().size()) / LightClusters::ClusterCount;
+        qInfo().noquote() << QStringLiteral("%1 %2 %3 %4x %5")
+                             .arg(count, 6)
+                             .arg(scalar, 11, 'f', 3)
+                             .arg(simd, 9, 'f', 3)
+                             .arg(scalar / simd, 8, 'f', 2)
+                             .arg(perCluster, 16, 'f', 2);
+    }
+
+    return 0;
+}
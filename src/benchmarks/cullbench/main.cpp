@@ -0,0 +1,133 @@
+#include <frustumculler.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// Measures FrustumCuller::cull() on randomly placed and rotated unit cubes (1M by default)
+// with bounding spheres and AABBs, for every instruction set the CPU supports.
+// The camera turns around between iterations, so the visible set changes every time.
+
+namespace {
+
+struct Bounds
+{
+    std::vector<QVector4D> spheres;
+    std::vector<FrustumCuller::Box> boxes;
+};
+
+Bounds randomCubes(int count)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+
+    // a unit cube fits into a sphere of radius sqrt(3) / 2
+    const auto radius = std::sqrt(3.0f) * 0.5f;
+
+    Bounds result;
+    result.spheres.reserve(size_t(count));
+    result.boxes.reserve(size_t(count));
+    for (int i = 0; i < count; ++i) {
+        QMatrix4x4 model;
+        model.translate(position(generator), position(generator), position(generator));
+        model.rotate(angle(generator), {1.0f, 0.3f, 0.5f});
+
+        const auto center = model.column(3).toVector3D();
+        result.spheres.emplace_back(center, radius);
+
+        // the AABB of a rotated box has the half extents |R| * 0.5
+        QVector3D extent;
+        for (int row = 0; row < 3; ++row)
+            extent[row] = 0.5f * (std::abs(model(row, 0)) + std::abs(model(row, 1)) + std::abs(model(row, 2)));
+        result.boxes.push_back({center - extent, center + extent});
+    }
+    return result;
+}
+
+const char *name(FrustumCuller::Instructions instructions)
+{
+    switch (instructions) {
+    case FrustumCuller::Instructions::Scalar:
+        return "scalar";
+    case FrustumCuller::Instructions::Sse2:
+        return "sse2";
+    case FrustumCuller::Instructions::Avx:
+        return "avx";
+    }
+    return "";
+}
+
+QMatrix4x4 viewProjection(const QMatrix4x4 &projection, int iteration)
+{
+    QMatrix4x4 view;
+    view.rotate(float(iteration) * 7.0f, {0.0f, 1.0f, 0.0f});
+    return projection * view;
+}
+
+double measure(FrustumCuller &culler, const QMatrix4x4 &projection, int iterations, double *visible)
+{
+    culler.setViewProjection(viewProjection(projection, 0));
+    culler.cull();
+
+    qint64 nsecs = 0;
+    qint64 visibleCount = 0;
+    QElapsedTimer timer;
+    for (int i = 0; i < iterations; ++i) {
+        culler.setViewProjection(viewProjection(projection, i));
+        timer.start();
+        visibleCount += qint64(culler.cull().size());
+        nsecs += timer.nsecsElapsed();
+    }
+    *visible = double(visibleCount) / iterations;
+    return double(nsecs) / iterations / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    const auto arguments = a.arguments();
+    const int iterations = arguments.size() > 1 ? std::max(1, arguments.at(1).toInt()) : 20;
+    const int count = arguments.size() > 2 ? std::max(1, arguments.at(2).toInt()) : 1000000;
+
+    QMatrix4x4 projection;
+    projection.perspective(45.0f, 640.0f / 480.0f, 0.1f, 100.0f);
+
+    const auto bounds = randomCubes(count);
+    const auto best = FrustumCuller::bestInstructions();
+
+    qInfo().noquote() << QStringLiteral("%1 cubes, %2 iterations, best instructions: %3")
+                         .arg(count).arg(iterations).arg(QString::fromLatin1(name(best)));
+    qInfo().noquote() << QStringLiteral("bounds   instructions   ms   speedup   visible");
+    for (const auto boxes: {false, true}) {
+        FrustumCuller culler;
+        if (boxes)
+            culler.setBoxes(bounds.boxes);
+        else
+            culler.setSpheres(bounds.spheres);
+
+        double scalar = 0.0;
+        for (int i = 0; i <= int(best); ++i) {
+            culler.setInstructions(FrustumCuller::Instructions(i));
+            double visible = 0.0;
+            const auto ms = measure(culler, projection, iterations, &visible);
+            if (i == 0)
+                scalar = ms;
+            qInfo().noquote() << QStringLiteral("%1 %2 %3 %4x %5")
+                                 .arg(boxes ? QStringLiteral("aabb") : QStringLiteral("sphere"), -6)
+                                 .arg(QString::fromLatin1(name(culler.instructions())), 14)
+                                 .arg(ms, 8, 'f', 3)
+                                 .arg(scalar / ms, 8, 'f', 2)
+                                 .arg(visible, 9, 'f', 0);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <drawqueue.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+
+#include <algorithm>
+#include <random>
+
+// Sorts the draws of a frame with many materials by their 64-bit keys, DrawQueue's radix sort
+// against std::sort and std::stable_sort of the same keys, and counts the program, material and
+// texture set changes needed to submit the draws in submission order and in key order.
+// Every material belongs to one program and uses one texture set, 10% of the draws are blended
+// and go to a second pass, back-to-front.
+
+namespace {
+
+constexpr int programs = 16;
+constexpr int materials = 1024;
+constexpr int textureSets = 512;
+
+std::vector<quint64> randomKeys(int count)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> material(0, materials - 1);
+    std::uniform_real_distribution<float> depth(0.0f, 1.0f);
+    std::bernoulli_distribution blended(0.1);
+
+    auto result = std::vector<quint64>(size_t(count));
+    for (auto &key: result) {
+        const auto drawMaterial = material(generator);
+        const auto drawDepth = depth(generator);
+        const auto transparent = blended(generator);
+        key = DrawQueue::makeKey(transparent ? 1 : 0, drawMaterial % programs, drawMaterial,
+                                 drawMaterial % textureSets, transparent ? 1.0f - drawDepth : drawDepth);
+    }
+    return result;
+}
+
+void fill(DrawQueue &queue, const std::vector<quint64> &keys)
+{
+    queue.clear();
+    for (size_t i = 0; i < keys.size(); ++i)
+        queue.add(keys[i], int(i));
+}
+
+template<typename Function>
+double measure(int iterations, Function function)
+{
+    QElapsedTimer timer;
+    qint64 elapsed = 0;
+    for (int i = 0; i < iterations; ++i) {
+        function(timer);
+        elapsed += timer.nsecsElapsed();
+    }
+    return double(elapsed) / iterations / 1e6;
+}
+
+QString changesText(const DrawQueue::StateChanges &changes)
+{
+    return QStringLiteral("%1 programs, %2 materials, %3 texture sets")
+            .arg(changes.programs)
+            .arg(changes.materials)
+            .arg(changes.textureSets);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    const auto arguments = a.arguments();
+    const int iterations = arguments.size() > 1 ? std::max(1, arguments.at(1).toInt()) : 20;
+    const int count = arguments.size() > 2 ? std::max(1, arguments.at(2).toInt()) : 100000;
+
+    const auto keys = randomKeys(count);
+    DrawQueue queue;
+    queue.reserve(count);
+
+    // the queue is refilled before every sort, only the sort is timed
+    const auto radix = measure(iterations, [&](QElapsedTimer &timer) {
+        fill(queue, keys);
+        timer.start();
+        queue.sort();
+    });
+
+    std::vector<DrawQueue::Draw> draws;
+    const auto byKey = [](const DrawQueue::Draw &lhs, const DrawQueue::Draw &rhs) { return lhs.key < rhs.key; };
+    const auto comparison = measure(iterations, [&](QElapsedTimer &timer) {
+        fill(queue, keys);
+        draws = queue.draws();
+        timer.start();
+        std::sort(draws.begin(), draws.end(), byKey);
+    });
+    const auto stable = measure(iterations, [&](QElapsedTimer &timer) {
+        fill(queue, keys);
+        draws = queue.draws();
+        timer.start();
+        std::stable_sort(draws.begin(), draws.end(), byKey);
+    });
+
+    fill(queue, keys);
+    const auto unsortedChanges = queue.stateChanges();
+    queue.sort();
+    const auto sortedChanges = queue.stateChanges();
+
+    // both sorts are stable, so the draws must be the same, not just the keys
+    const auto &sorted = queue.draws();
+    const auto same = std::equal(sorted.begin(), sorted.end(), draws.begin(), draws.end(),
+                                 [](const DrawQueue::Draw &lhs, const DrawQueue::Draw &rhs) {
+        return lhs.key == rhs.key && lhs.index == rhs.index;
+    });
+
+    qInfo().noquote() << QStringLiteral("%1 iterations, %2 draws, %3 programs, %4 materials, %5 texture sets")
+                         .arg(iterations).arg(count).arg(programs).arg(materials).arg(textureSets);
+    qInfo().noquote() << QStringLiteral("radix sort:        %1 ms").arg(radix, 0, 'f', 3);
+    qInfo().noquote() << QStringLiteral("std::sort:         %1 ms").arg(comparison, 0, 'f', 3);
+    qInfo().noquote() << QStringLiteral("std::stable_sort:  %1 ms").arg(stable, 0, 'f', 3);
+    qInfo().noquote() << QStringLiteral("changes unsorted:  %1").arg(changesText(unsortedChanges));
+    qInfo().noquote() << QStringLiteral("changes sorted:    %1").arg(changesText(sortedChanges));
+    if (!same) {
+        qCritical() << "The radix sort doesn't match std::stable_sort";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include <components.h>
+#include <entityworld.h>
+#include <systems.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+
+// Measures a per-frame transform update (spin every entity, then rebuild its model matrix) over
+// 10k, 100k and 1M entities stored by EntityWorld, against the same entities kept as individually
+// allocated objects in shuffled order, as a scene of heap-allocated nodes would keep them.
+// The cost per entity should stay flat as the count grows.
+
+namespace {
+
+const QVector3D spinAxis(0.0f, 1.0f, 0.0f);
+
+// every fifth entity is a light, which gives the world two archetypes
+constexpr int lightEvery = 5;
+
+struct Object
+{
+    Transform transform;
+    ModelMatrix model;
+    MeshInstance mesh;
+    Material material;
+    Light light;
+    bool hasLight {false};
+};
+
+Transform randomTransform(std::mt19937 &generator)
+{
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+    Transform result;
+    result.position = QVector3D(position(generator), position(generator), position(generator));
+    result.rotation = QQuaternion::fromAxisAndAngle({1.0f, 0.3f, 0.5f}, angle(generator));
+    return result;
+}
+
+void spin(EntityWorld &world, const QQuaternion &rotation)
+{
+    world.forEachChunk<Transform>([&rotation](int count, const EntityWorld::Entity *, Transform *transforms) {
+        for (int i = 0; i < count; ++i)
+            transforms[i].rotation = rotation * transforms[i].rotation;
+    });
+    updateModelMatrices(world);
+}
+
+void spin(std::vector<std::unique_ptr<Object>> &objects, const QQuaternion &rotation)
+{
+    for (const auto &object: objects) {
+        auto &transform = object->transform;
+        transform.rotation = rotation * transform.rotation;
+        auto &model = object->model.matrix;
+        model.setToIdentity();
+        model.translate(transform.position);
+        model.rotate(transform.rotation);
+        model.scale(transform.scale);
+    }
+}
+
+template<typename Function>
+double measure(int iterations, Function function)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i)
+        function(i);
+    return double(timer.nsecsElapsed()) / iterations / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    const auto arguments = a.arguments();
+    const int iterations = arguments.size() > 1 ? std::max(1, arguments.at(1).toInt()) : 20;
+    const auto rotation = QQuaternion::fromAxisAndAngle(spinAxis, 1.0f);
+
+    qInfo().noquote() << QStringLiteral("%1 iterations, 1 light per %2 entities").arg(iterations).arg(lightEvery);
+    qInfo().noquote() << QStringLiteral("entities archetypes chunks  create ms   "
+                                        "ecs ms  ns/entity   objects ms  ns/entity");
+    for (const int count: {10000, 100000, 1000000}) {
+        std::mt19937 generator(42);
+        std::vector<Transform> transforms(size_t(count));
+        for (auto &transform: transforms)
+            transform = randomTransform(generator);
+
+        EntityWorld world;
+        const auto create = measure(1, [&](int) {
+            for (int i = 0; i < count; ++i) {
+                const auto &transform = transforms[size_t(i)];
+                if (i % lightEvery == 0)
+                    world.create(transform, ModelMatrix {}, MeshInstance {}, Material {}, Light {});
+                else
+                    world.create(transform, ModelMatrix {}, MeshInstance {}, Material {});
+            }
+        });
+        const auto ecs = measure(iterations, [&](int) { spin(world, rotation); });
+
+        std::vector<std::unique_ptr<Object>> objects;
+        objects.reserve(size_t(count));
+        for (int i = 0; i < count; ++i) {
+            objects.push_back(std::make_unique<Object>());
+            objects.back()->transform = transforms[size_t(i)];
+            objects.back()->hasLight = i % lightEvery == 0;
+        }
+        std::shuffle(objects.begin(), objects.end(), generator);
+        const auto aos = measure(iterations, [&](int) { spin(objects, rotation); });
+
+        qInfo().noquote() << QStringLiteral("%1 %2 %3 %4 %5 %6 %7 %8")
+                             .arg(count, 8)
+                             .arg(world.archetypeCount(), 10)
+                             .arg(world.chunkCount(), 6)
+                             .arg(create, 10, 'f', 3)
+                             .arg(ecs, 8, 'f', 3)
+                             .arg(ecs * 1e6 / count, 10, 'f', 2)
+                             .arg(aos, 12, 'f', 3)
+                             .arg(aos * 1e6 / count, 10, 'f', 2);
+    }
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <renderqueue.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThread>
+
+#include <algorithm>
+#include <random>
+#include <type_traits>
+
+// Measures RenderQueue::update() - culling, sorting and packing the render list - with 1, 2, 4...
+// up to the ideal thread count. The camera turns every iteration, so the order changes and the
+// whole render list is packed again in every mode (without culling or sorting it never changes,
+// so that mode isn't measured).
+
+namespace {
+
+std::vector<QMatrix4x4> randomModels(int count)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+
+    auto result = std::vector<QMatrix4x4>(size_t(count));
+    for (auto &model: result) {
+        model.translate(position(generator), position(generator), position(generator));
+        model.rotate(angle(generator), {1.0f, 0.3f, 0.5f});
+    }
+    return result;
+}
+
+template<typename Function>
+double measure(int iterations, Function function)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i)
+        function(i);
+    return double(timer.nsecsElapsed()) / iterations / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    const auto arguments = a.arguments();
+    const int iterations = arguments.size() > 1 ? std::max(1, arguments.at(1).toInt()) : 20;
+    const int count = arguments.size() > 2 ? std::max(1, arguments.at(2).toInt()) : 100000;
+
+    // the bounding sphere of a unit cube
+    constexpr float radius = 0.8660254f;
+    const auto models = randomModels(count);
+
+    QMatrix4x4 projection;
+    projection.perspective(45.0f, 640.0f / 480.0f, 0.1f, 100.0f);
+
+    const QStringList modes[] = {
+        {QStringLiteral("--sort-draws")},
+        {QStringLiteral("--cull")},
+        {QStringLiteral("--cull"), QStringLiteral("--sort-draws")},
+        {QStringLiteral("--cull-bvh"), QStringLiteral("--sort-draws")},
+    };
+
+    qInfo().noquote() << QStringLiteral("%1 iterations, %2 objects, ms per update").arg(iterations).arg(count);
+    qInfo().noquote() << QStringLiteral("threads    sorted    culled   culled+sorted   bvh+sorted");
+    const auto idealThreadCount = std::max(1, QThread::idealThreadCount());
+    for (int threads = 1; ; threads = std::min(threads * 2, idealThreadCount)) {
+        double times[std::extent<decltype(modes)>::value] = {};
+        for (size_t mode = 0; mode < std::extent<decltype(modes)>::value; ++mode) {
+            auto queueArguments = modes[mode];
+            queueArguments.prepend(QStringLiteral("renderlistbench"));
+            RenderQueue queue(queueArguments);
+            queue.setThreadCount(threads);
+            queue.setModels(models, radius);
+            times[mode] = measure(iterations, [&](int i) {
+                QMatrix4x4 view;
+                view.rotate(float(i) * 7.0f + 1.0f, {0.0f, 1.0f, 0.0f});
+                queue.update(view, projection);
+            });
+        }
+
+        qInfo().noquote() << QStringLiteral("%1 %2 %3 %4 %5")
+                             .arg(threads, 7)
+                             .arg(times[0], 9, 'f', 3)
+                             .arg(times[1], 9, 'f', 3)
+                             .arg(times[2], 15, 'f', 3)
+                             .arg(times[3], 12, 'f', 3);
+        if (threads == idealThreadCount)
+            break;
+    }
+
+    return 0;
+}
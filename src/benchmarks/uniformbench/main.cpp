@@ -0,0 +1,283 @@
+#include <uniformtable.h>
+
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+
+#include <QtGui/QGuiApplication>
+#include <QtGui/QMatrix4x4>
+
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+
+// Measures the CPU cost of the uniform setup done by 5.3.spot_light's paintCube()
+// with string names versus locations cached by UniformLocations.
+
+namespace {
+
+constexpr auto vertexShader = R"(
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 texcoords;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(position, 1.0f);
+    FragPos = vec3(model * vec4(position, 1.0f));
+    Normal = mat3(transpose(inverse(model))) * normal;
+    TexCoords = texcoords;
+}
+)";
+
+constexpr auto fragmentShader = R"(
+#version 330 core
+
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+};
+
+struct Light {
+    vec3 position;
+    vec3 direction;
+    float cutoff;
+    float outerCutoff;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+in vec2 TexCoords;
+in vec3 FragPos;
+in vec3 Normal;
+
+out vec4 color;
+
+uniform vec3 viewPos;
+uniform Light light;
+uniform Material material;
+
+void main()
+{
+    vec3 lightDirection = normalize(light.position - FragPos);
+    float theta = dot(lightDirection, normalize(-light.direction));
+    float intensity = clamp((theta - light.outerCutoff) / (light.cutoff - light.outerCutoff), 0.0, 1.0);
+    float distance = length(light.position - FragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * distance * distance);
+
+    vec3 normal = normalize(Normal);
+    vec3 reflectDirection = reflect(-lightDirection, normal);
+    float diff = max(dot(normal, lightDirection), 0.0);
+    float spec = pow(max(dot(normalize(viewPos - FragPos), reflectDirection), 0.0), material.shininess);
+
+    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
+    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
+    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
+    color = vec4((ambient + (diffuse + specular) * intensity) * attenuation, 1.0);
+}
+)";
+
+enum class Uniform {
+    View,
+    Projection,
+    ViewPos,
+    MaterialDiffuse,
+    MaterialSpecular,
+    MaterialShininess,
+    LightPosition,
+    LightDirection,
+    LightCutoff,
+    LightOuterCutoff,
+    LightAmbient,
+    LightDiffuse,
+    LightSpecular,
+    LightConstant,
+    LightLinear,
+    LightQuadratic,
+    Model,
+    Count
+};
+
+constexpr UniformLocations<Uniform>::Names uniformNames = {{
+    "view",
+    "projection",
+    "viewPos",
+    "material.diffuse",
+    "material.specular",
+    "material.shininess",
+    "light.position",
+    "light.direction",
+    "light.cutoff",
+    "light.outerCutoff",
+    "light.ambient",
+    "light.diffuse",
+    "light.specular",
+    "light.constant",
+    "light.linear",
+    "light.quadratic",
+    "model",
+}};
+
+constexpr int cubeCount = 10;
+
+QMatrix4x4 cubeModel(int i)
+{
+    QMatrix4x4 model;
+    model.translate({float(i), 0.0f, -float(i)});
+    model.rotate(20.0f * i, {1.0f, 0.3f, 0.5f});
+    return model;
+}
+
+void setUniformsByName(QOpenGLShaderProgram &program, const QMatrix4x4 &view,
+                       const QMatrix4x4 &projection, const QVector3D &position)
+{
+    program.setUniformValue("view", view);
+    program.setUniformValue("projection", projection);
+    program.setUniformValue("viewPos", position);
+
+    program.setUniformValue("material.diffuse", 0);
+    program.setUniformValue("material.specular", 1);
+    program.setUniformValue("material.shininess", 32.0f);
+
+    program.setUniformValue("light.position", position);
+    program.setUniformValue("light.direction", QVector3D(0.0f, 0.0f, -1.0f));
+    program.setUniformValue("light.cutoff", 0.97f);
+    program.setUniformValue("light.outerCutoff", 0.95f);
+
+    program.setUniformValue("light.ambient", QVector3D(0.2f, 0.2f, 0.2f));
+    program.setUniformValue("light.diffuse", QVector3D(0.5f, 0.5f, 0.5f));
+    program.setUniformValue("light.specular", QVector3D(1.0f, 1.0f, 1.0f));
+
+    program.setUniformValue("light.constant", 1.0f);
+    program.setUniformValue("light.linear", 0.09f);
+    program.setUniformValue("light.quadratic", 0.032f);
+
+    for (int i = 0; i < cubeCount; ++i)
+        program.setUniformValue("model", cubeModel(i));
+}
+
+void setUniformsByLocation(QOpenGLShaderProgram &program, const UniformLocations<Uniform> &uniforms,
+                           const QMatrix4x4 &view, const QMatrix4x4 &projection,
+                           const QVector3D &position)
+{
+    program.setUniformValue(uniforms[Uniform::View], view);
+    program.setUniformValue(uniforms[Uniform::Projection], projection);
+    program.setUniformValue(uniforms[Uniform::ViewPos], position);
+
+    program.setUniformValue(uniforms[Uniform::MaterialDiffuse], 0);
+    program.setUniformValue(uniforms[Uniform::MaterialSpecular], 1);
+    program.setUniformValue(uniforms[Uniform::MaterialShininess], 32.0f);
+
+    program.setUniformValue(uniforms[Uniform::LightPosition], position);
+    program.setUniformValue(uniforms[Uniform::LightDirection], QVector3D(0.0f, 0.0f, -1.0f));
+    program.setUniformValue(uniforms[Uniform::LightCutoff], 0.97f);
+    program.setUniformValue(uniforms[Uniform::LightOuterCutoff], 0.95f);
+
+    program.setUniformValue(uniforms[Uniform::LightAmbient], QVector3D(0.2f, 0.2f, 0.2f));
+    program.setUniformValue(uniforms[Uniform::LightDiffuse], QVector3D(0.5f, 0.5f, 0.5f));
+    program.setUniformValue(uniforms[Uniform::LightSpecular], QVector3D(1.0f, 1.0f, 1.0f));
+
+    program.setUniformValue(uniforms[Uniform::LightConstant], 1.0f);
+    program.setUniformValue(uniforms[Uniform::LightLinear], 0.09f);
+    program.setUniformValue(uniforms[Uniform::LightQuadratic], 0.032f);
+
+    for (int i = 0; i < cubeCount; ++i)
+        program.setUniformValue(uniforms[Uniform::Model], cubeModel(i));
+}
+
+template<typename Function>
+double measure(int frames, Function function)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < frames; ++i)
+        function(i);
+    return double(timer.nsecsElapsed()) / frames / 1000.0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QGuiApplication a(argc, argv);
+
+    QSurfaceFormat fmt;
+    fmt.setVersion(3, 3);
+    fmt.setProfile(QSurfaceFormat::CoreProfile);
+    QSurfaceFormat::setDefaultFormat(fmt);
+
+    const auto arguments = a.arguments();
+    const int frames = arguments.size() > 1 ? std::max(1, arguments.at(1).toInt()) : 10000;
+
+    QOffscreenSurface surface;
+    surface.create();
+
+    QOpenGLContext context;
+    if (!context.create() || !context.makeCurrent(&surface)) {
+        qCritical() << "Can't create OGL context";
+        return 1;
+    }
+
+    QOpenGLShaderProgram program;
+    program.addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShader);
+    program.addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShader);
+    if (!program.link()) {
+        qCritical() << "Can't link program" << program.log();
+        return 1;
+    }
+
+    UniformLocations<Uniform> uniforms;
+    uniforms.resolve(&program, uniformNames);
+
+    QMatrix4x4 projection;
+    projection.perspective(45.0f, 640.0f / 480.0f, 0.1f, 100.0f);
+
+    program.bind();
+    const auto frame = [&](int i, bool cached) {
+        const QVector3D position(std::sin(i * 0.01f), 0.0f, 3.0f);
+        QMatrix4x4 view;
+        view.lookAt(position, position + QVector3D(0.0f, 0.0f, -1.0f), {0.0f, 1.0f, 0.0f});
+        if (cached)
+            setUniformsByLocation(program, uniforms, view, projection, position);
+        else
+            setUniformsByName(program, view, projection, position);
+    };
+
+    // warm up the driver and Qt's internal caches
+    measure(100, [&](int i) { frame(i, false); });
+    measure(100, [&](int i) { frame(i, true); });
+
+    const auto byName = measure(frames, [&](int i) { frame(i, false); });
+    const auto byLocation = measure(frames, [&](int i) { frame(i, true); });
+    context.functions()->glFinish();
+    program.release();
+
+    qInfo().noquote() << QStringLiteral("frames: %1").arg(frames);
+    qInfo().noquote() << QStringLiteral("by name:     %1 us/frame").arg(byName, 0, 'f', 3);
+    qInfo().noquote() << QStringLiteral("by location: %1 us/frame").arg(byLocation, 0, 'f', 3);
+    qInfo().noquote() << QStringLiteral("saving:      %1 us/frame (%2x)")
+                         .arg(byName - byLocation, 0, 'f', 3)
+                         .arg(byName / byLocation, 0, 'f', 2);
+
+    return 0;
+}
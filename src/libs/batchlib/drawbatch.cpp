@@ -0,0 +1,204 @@
+#include "drawbatch.h"
+
+#include <meshpool.h>
+#include <statecache.h>
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <QtCore/QDebug>
+#include <QtCore/QLoggingCategory>
+
+#include <algorithm>
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+Q_LOGGING_CATEGORY(lcDrawBatch, "learnopengl.drawbatch", QtInfoMsg)
+
+namespace {
+
+using MultiDrawElementsIndirect = void (QOPENGLF_APIENTRYP)(GLenum mode, GLenum type, const void *indirect,
+                                                            GLsizei drawCount, GLsizei stride);
+
+} // namespace
+
+DrawBatch::DrawBatch(const QStringList &arguments)
+{
+    m_multiDrawAllowed = !arguments.contains(QStringLiteral("--no-multi-draw"));
+}
+
+DrawBatch::~DrawBatch() = default;
+
+void DrawBatch::create(QOpenGLFunctions_3_3_Core *funcs, StateCache *state, MeshPool *pool, int modelLocation,
+                       int normalMatrixLocation)
+{
+    m_funcs = funcs;
+    m_state = state;
+    m_pool = pool;
+    m_modelLocation = modelLocation;
+    m_normalMatrixLocation = normalMatrixLocation;
+
+    // the commands' baseInstance needs GL_ARB_base_instance, which is part of 4.2
+    const auto context = QOpenGLContext::currentContext();
+    const auto supported = context->format().version() >= qMakePair(4, 3)
+            || (context->hasExtension(QByteArrayLiteral("GL_ARB_multi_draw_indirect"))
+                && context->hasExtension(QByteArrayLiteral("GL_ARB_base_instance")));
+    if (m_multiDrawAllowed && supported) {
+        m_multiDrawIndirect = context->getProcAddress("glMultiDrawElementsIndirect");
+    }
+
+    m_vao.create();
+    QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
+    m_pool->setupAttributes();
+
+    m_instanceVbo.create();
+    m_instanceVbo.bind();
+    m_instanceVbo.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    const auto enable = [this](int location, int columns) {
+        for (int column = 0; column < columns; ++column) {
+            m_funcs->glEnableVertexAttribArray(GLuint(location + column));
+            m_funcs->glVertexAttribDivisor(GLuint(location + column), 1);
+        }
+    };
+    enable(m_modelLocation, 4);
+    if (m_normalMatrixLocation >= 0)
+        enable(m_normalMatrixLocation, 3);
+    setupInstanceAttributes(0);
+    m_instanceVbo.release();
+
+    if (isMultiDraw())
+        m_funcs->glGenBuffers(1, &m_commandBuffer);
+
+    qCDebug(lcDrawBatch) << "Draw batch:" << (isMultiDraw() ? "glMultiDrawElementsIndirect"
+                                                            : "glDrawElementsInstancedBaseVertex per command");
+}
+
+void DrawBatch::destroy()
+{
+    if (!m_funcs)
+        return;
+
+    m_vao.destroy();
+    m_instanceVbo.destroy();
+    m_funcs->glDeleteBuffers(1, &m_commandBuffer);
+    m_commandBuffer = 0;
+    m_funcs = nullptr;
+}
+
+void DrawBatch::clear()
+{
+    m_commands.clear();
+    m_commandMeshes.clear();
+    m_instances.clear();
+    m_dirty = true;
+}
+
+void DrawBatch::add(int mesh, const QMatrix4x4 &model)
+{
+    appendCommand(mesh, 1);
+    m_instances.insert(m_instances.end(), model.constData(), model.constData() + 16);
+    const auto normalMatrix = model.normalMatrix();
+    m_instances.insert(m_instances.end(), normalMatrix.constData(), normalMatrix.constData() + 9);
+}
+
+void DrawBatch::add(int mesh, const GLfloat *instances, int instanceCount)
+{
+    if (instanceCount == 0)
+        return;
+    appendCommand(mesh, instanceCount);
+    m_instances.insert(m_instances.end(), instances, instances + instanceCount * InstanceFloats);
+}
+
+void DrawBatch::upload()
+{
+    if (!m_dirty)
+        return;
+    m_dirty = false;
+
+    m_instanceVbo.bind();
+    m_instanceVbo.allocate(m_instances.data(), int(m_instances.size() * sizeof(GLfloat)));
+    m_instanceVbo.release();
+
+    if (isMultiDraw()) {
+        m_state->bindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+        m_funcs->glBufferData(GL_DRAW_INDIRECT_BUFFER, GLsizeiptr(m_commands.size() * sizeof(Command)),
+                              m_commands.data(), GL_DYNAMIC_DRAW);
+    }
+}
+
+void DrawBatch::draw()
+{
+    draw(0, commandCount());
+}
+
+void DrawBatch::draw(int firstCommand, int commandCount)
+{
+    Q_ASSERT_X(!m_dirty, "DrawBatch", "upload() wasn't called after add()");
+    Q_ASSERT(firstCommand >= 0 && firstCommand + commandCount <= this->commandCount());
+    m_drawCallCount = 0;
+    if (commandCount <= 0)
+        return;
+
+    m_state->bindVertexArray(m_vao.objectId());
+    if (isMultiDraw()) {
+        // the indirect buffer binding isn't VAO state
+        m_state->bindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+        const auto multiDrawIndirect = reinterpret_cast<MultiDrawElementsIndirect>(m_multiDrawIndirect);
+        const auto offset = reinterpret_cast<const void *>(size_t(firstCommand) * sizeof(Command));
+        multiDrawIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, offset, GLsizei(commandCount), 0);
+        m_drawCallCount = 1;
+        return;
+    }
+
+    m_instanceVbo.bind();
+    for (int i = firstCommand; i < firstCommand + commandCount; ++i) {
+        const auto &command = m_commands[size_t(i)];
+        setupInstanceAttributes(int(command.baseInstance));
+        const auto indices = reinterpret_cast<GLvoid *>(command.firstIndex * sizeof(GLushort));
+        m_funcs->glDrawElementsInstancedBaseVertex(GL_TRIANGLES, GLsizei(command.count), GL_UNSIGNED_SHORT, indices,
+                                                   GLsizei(command.instanceCount), command.baseVertex);
+    }
+    m_instanceVbo.release();
+    m_drawCallCount = commandCount;
+}
+
+void DrawBatch::appendCommand(int mesh, int instanceCount)
+{
+    m_dirty = true;
+
+    // the instances are appended, so a run of the same mesh extends the last command
+    if (!m_commandMeshes.empty() && m_commandMeshes.back() == mesh) {
+        m_commands.back().instanceCount += GLuint(instanceCount);
+        return;
+    }
+
+    const auto &range = m_pool->range(mesh);
+    m_commands.push_back({GLuint(range.indexCount), GLuint(instanceCount), GLuint(range.firstIndex),
+                          range.baseVertex, GLuint(this->instanceCount())});
+    m_commandMeshes.push_back(mesh);
+}
+
+void DrawBatch::setupInstanceAttributes(int firstInstance)
+{
+    // without baseInstance the attributes themselves start at the command's first instance
+    if (firstInstance == m_attributeInstance)
+        return;
+    m_attributeInstance = firstInstance;
+
+    const auto stride = InstanceFloats * int(sizeof(GLfloat));
+    const auto base = size_t(firstInstance) * size_t(stride);
+    for (int column = 0; column < 4; ++column) {
+        const auto offset = base + size_t(column) * 4 * sizeof(GLfloat);
+        m_funcs->glVertexAttribPointer(GLuint(m_modelLocation + column), 4, GL_FLOAT, GL_FALSE, stride,
+                                       reinterpret_cast<GLvoid *>(offset));
+    }
+    if (m_normalMatrixLocation >= 0) {
+        for (int column = 0; column < 3; ++column) {
+            const auto offset = base + size_t(16 + column * 3) * sizeof(GLfloat);
+            m_funcs->glVertexAttribPointer(GLuint(m_normalMatrixLocation + column), 3, GL_FLOAT, GL_FALSE, stride,
+                                           reinterpret_cast<GLvoid *>(offset));
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef DRAWBATCH_H
+#define DRAWBATCH_H
+
+#include <QOpenGLBuffer>
+#include <QOpenGLVertexArrayObject>
+
+#include <QtGui/QMatrix4x4>
+
+#include <QtCore/QStringList>
+
+#include <vector>
+
+class MeshPool;
+class QOpenGLFunctions_3_3_Core;
+class StateCache;
+
+// Instanced draws of MeshPool meshes. Every instance has a model and a normal matrix, packed like
+// RenderList packets and read as instance attributes at modelLocation (4 slots) and
+// normalMatrixLocation (3 slots), so shaders need neither gl_DrawID nor per-draw uniforms.
+// Each run of add()s of one mesh becomes a draw command whose baseInstance points at its first
+// instance. With GL 4.3 or GL_ARB_multi_draw_indirect all commands are submitted by a single
+// glMultiDrawElementsIndirect; on plain 3.3 every command is a glDrawElementsInstancedBaseVertex
+// with the instance attributes moved to its first instance ("--no-multi-draw" forces this).
+// The VAO and the indirect buffer are bound through the StateCache and stay bound after draw().
+class DrawBatch
+{
+    Q_DISABLE_COPY(DrawBatch)
+public:
+    static constexpr int InstanceFloats = 16 + 9;
+
+    explicit DrawBatch(const QStringList &arguments);
+    ~DrawBatch();
+
+    // Creates the batch's VAO over the pool's buffers, pass -1 to skip the normal matrix
+    void create(QOpenGLFunctions_3_3_Core *funcs, StateCache *state, MeshPool *pool, int modelLocation,
+                int normalMatrixLocation = -1);
+    void destroy();
+
+    bool isMultiDraw() const noexcept { return m_multiDrawIndirect != nullptr; }
+    // The VAO over the pool's buffers, e.g. for MeshPool::draw()
+    GLuint vertexArrayId() const { return m_vao.objectId(); }
+    int commandCount() const noexcept { return int(m_commands.size()); }
+    int instanceCount() const noexcept { return int(m_instances.size() / InstanceFloats); }
+    // Calls issued by the last draw()
+    int drawCallCount() const noexcept { return m_drawCallCount; }
+
+    void clear();
+    void add(int mesh, const QMatrix4x4 &model);
+    // instanceCount instances packed as InstanceFloats floats each, e.g. RenderList::data()
+    void add(int mesh, const GLfloat *instances, int instanceCount);
+
+    // Uploads the commands and instances added since the last upload
+    void upload();
+    void draw();
+    // Draws commandCount commands from firstCommand, e.g. the meshes drawn by one program
+    void draw(int firstCommand, int commandCount);
+
+private:
+    // the layout of glMultiDrawElementsIndirect's commands
+    struct Command
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    void appendCommand(int mesh, int instanceCount);
+    void setupInstanceAttributes(int firstInstance);
+
+private:
+    bool m_multiDrawAllowed {true};
+    QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
+    StateCache *m_state {nullptr};
+    MeshPool *m_pool {nullptr};
+    QFunctionPointer m_multiDrawIndirect {nullptr};
+    int m_modelLocation {-1};
+    int m_normalMatrixLocation {-1};
+    QOpenGLVertexArrayObject m_vao;
+    QOpenGLBuffer m_instanceVbo {QOpenGLBuffer::VertexBuffer};
+    GLuint m_commandBuffer {0};
+    std::vector<Command> m_commands;
+    std::vector<int> m_commandMeshes;
+    std::vector<GLfloat> m_instances;
+    int m_attributeInstance {-1};
+    bool m_dirty {false};
+    int m_drawCallCount {0};
+};
+
+#endif // DRAWBATCH_H
@@ -0,0 +1,217 @@
+#include "offscreenrunner.h"
+
+#include <goldenimage.h>
+
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QOpenGLTimerQuery>
+#include <QOpenGLWindow>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+// QOpenGLWindow's GL hooks are protected, this gives access to them without touching the examples
+class WindowAccess : public QOpenGLWindow
+{
+public:
+    using QOpenGLWindow::initializeGL;
+    using QOpenGLWindow::resizeGL;
+    using QOpenGLWindow::paintGL;
+};
+
+QJsonValue statistics(const std::vector<qint64> &nsecs)
+{
+    if (nsecs.empty())
+        return QJsonValue::Null;
+
+    const auto minmax = std::minmax_element(nsecs.begin(), nsecs.end());
+    double sum = 0;
+    for (const auto value: nsecs)
+        sum += value;
+
+    return QJsonObject {
+        {QStringLiteral("min"), *minmax.first / 1e6},
+        {QStringLiteral("avg"), sum / nsecs.size() / 1e6},
+        {QStringLiteral("max"), *minmax.second / 1e6},
+    };
+}
+
+} // namespace
+
+OffscreenRunner::OffscreenRunner(const QStringList &arguments) :
+    m_golden(std::make_unique<GoldenImage>(arguments))
+{
+    for (int i = 1; i + 1 < arguments.size(); ++i) {
+        if (arguments.at(i) == QLatin1String("--benchmark")) {
+            m_frameCount = std::max(0, arguments.at(++i).toInt());
+        } else if (arguments.at(i) == QLatin1String("--benchmark-output")) {
+            m_outputFile = arguments.at(++i);
+        }
+    }
+}
+
+OffscreenRunner::~OffscreenRunner()
+{
+    if (m_context && m_fbo) {
+        m_context->makeCurrent(m_surface.get());
+        m_fbo.reset();
+        m_context->doneCurrent();
+    }
+}
+
+bool OffscreenRunner::isEnabled() const noexcept
+{
+    return m_frameCount > 0 || m_golden->isEnabled();
+}
+
+int OffscreenRunner::exec(QOpenGLWindow *window)
+{
+    if (!window || !createContext())
+        return 1;
+
+    render(window);
+
+    auto ok = true;
+    if (m_golden->isEnabled())
+        ok = m_golden->check(m_fbo->toImage());
+    if (m_frameCount > 0)
+        ok = writeReport() && ok;
+    return ok ? 0 : 1;
+}
+
+QJsonObject OffscreenRunner::report() const
+{
+    std::vector<qint64> cpu;
+    std::vector<qint64> gpu;
+    QJsonArray frames;
+    for (const auto &frame: m_frameTimes) {
+        cpu.push_back(frame.cpuNsecs);
+        if (frame.gpuNsecs >= 0)
+            gpu.push_back(frame.gpuNsecs);
+        frames.append(QJsonObject {
+            {QStringLiteral("cpu"), frame.cpuNsecs / 1e6},
+            {QStringLiteral("gpu"), frame.gpuNsecs >= 0 ? QJsonValue(frame.gpuNsecs / 1e6) : QJsonValue()},
+        });
+    }
+
+    return QJsonObject {
+        {QStringLiteral("application"), QCoreApplication::applicationName()},
+        {QStringLiteral("renderer"), m_renderer},
+        {QStringLiteral("width"), m_fbo ? m_fbo->width() : 0},
+        {QStringLiteral("height"), m_fbo ? m_fbo->height() : 0},
+        {QStringLiteral("frames"), int(m_frameTimes.size())},
+        {QStringLiteral("cpu"), statistics(cpu)},
+        {QStringLiteral("gpu"), statistics(gpu)},
+        {QStringLiteral("samples"), frames},
+    };
+}
+
+bool OffscreenRunner::createContext()
+{
+    const auto format = QSurfaceFormat::defaultFormat();
+
+    m_surface = std::make_unique<QOffscreenSurface>();
+    m_surface->setFormat(format);
+    m_surface->create();
+
+    m_context = std::make_unique<QOpenGLContext>();
+    m_context->setFormat(format);
+    if (!m_context->create()) {
+        qCritical() << "Can't create offscreen OGL context";
+        return false;
+    }
+
+    if (!m_context->makeCurrent(m_surface.get())) {
+        qCritical() << "Can't make offscreen OGL context current";
+        return false;
+    }
+
+    const auto renderer = m_context->functions()->glGetString(GL_RENDERER);
+    m_renderer = QString::fromLatin1(reinterpret_cast<const char *>(renderer));
+    return true;
+}
+
+void OffscreenRunner::render(QOpenGLWindow *window)
+{
+    const auto initializeGL = &WindowAccess::initializeGL;
+    const auto resizeGL = &WindowAccess::resizeGL;
+    const auto paintGL = &WindowAccess::paintGL;
+
+    const auto size = window->size();
+    m_fbo = std::make_unique<QOpenGLFramebufferObject>(
+            size, QOpenGLFramebufferObject::CombinedDepthStencil);
+    m_fbo->bind();
+
+    (window->*initializeGL)();
+    (window->*resizeGL)(size.width(), size.height());
+
+    const auto frameCount = std::max(m_frameCount, 1);
+
+    // One query per frame, results are collected after the loop so the CPU never waits for the GPU
+    std::vector<std::unique_ptr<QOpenGLTimerQuery>> queries;
+    queries.reserve(size_t(frameCount));
+    bool hasTimerQueries = true;
+
+    m_frameTimes.assign(size_t(frameCount), {});
+    QElapsedTimer timer;
+    for (int i = 0; i < frameCount; ++i) {
+        QCoreApplication::processEvents();
+        m_fbo->bind();
+
+        std::unique_ptr<QOpenGLTimerQuery> query;
+        if (hasTimerQueries) {
+            query = std::make_unique<QOpenGLTimerQuery>();
+            hasTimerQueries = query->create();
+            if (!hasTimerQueries) {
+                qWarning() << "Timer queries are not supported, GPU time is not available";
+                query.reset();
+            }
+        }
+
+        timer.start();
+        if (query)
+            query->begin();
+        (window->*paintGL)();
+        if (query)
+            query->end();
+        m_context->functions()->glFlush();
+        m_frameTimes[i].cpuNsecs = timer.nsecsElapsed();
+
+        queries.push_back(std::move(query));
+    }
+
+    m_context->functions()->glFinish();
+    for (int i = 0; i < frameCount; ++i) {
+        if (queries[i])
+            m_frameTimes[i].gpuNsecs = qint64(queries[i]->waitForResult());
+    }
+}
+
+bool OffscreenRunner::writeReport() const
+{
+    const auto json = QJsonDocument(report()).toJson();
+
+    if (m_outputFile.isEmpty()) {
+        std::fwrite(json.constData(), 1, size_t(json.size()), stdout);
+        return true;
+    }
+
+    QFile file(m_outputFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCritical() << "Can't open" << m_outputFile << ":" << file.errorString();
+        return false;
+    }
+    file.write(json);
+    return true;
+}
@@ -0,0 +1,64 @@
+#ifndef OFFSCREENRUNNER_H
+#define OFFSCREENRUNNER_H
+
+#include <QtCore/QJsonObject>
+#include <QtCore/QStringList>
+
+#include <memory>
+#include <vector>
+
+class GoldenImage;
+class QOffscreenSurface;
+class QOpenGLContext;
+class QOpenGLFramebufferObject;
+class QOpenGLWindow;
+
+// Renders a QOpenGLWindow's initializeGL()/paintGL() into an FBO without showing the window.
+// Enabled with "--benchmark <frames>", the report is written to "--benchmark-output <file>"
+// or to stdout. With "--golden <file>" (see GoldenImage) the last frame is compared with a
+// reference image and exec() fails on a mismatch; one frame is rendered without "--benchmark".
+class OffscreenRunner
+{
+    Q_DISABLE_COPY(OffscreenRunner)
+public:
+    struct FrameTime
+    {
+        qint64 cpuNsecs {0};
+        qint64 gpuNsecs {-1};
+    };
+
+    explicit OffscreenRunner(const QStringList &arguments);
+    OffscreenRunner(OffscreenRunner &&) = delete;
+    ~OffscreenRunner();
+
+    OffscreenRunner &operator=(OffscreenRunner &&) = delete;
+
+    bool isEnabled() const noexcept;
+    int frameCount() const noexcept { return m_frameCount; }
+    QString outputFile() const { return m_outputFile; }
+
+    int exec(QOpenGLWindow *window);
+
+    const std::vector<FrameTime> &frameTimes() const noexcept { return m_frameTimes; }
+    QJsonObject report() const;
+
+private:
+    bool createContext();
+    void render(QOpenGLWindow *window);
+    bool writeReport() const;
+
+private:
+    int m_frameCount {0};
+    QString m_outputFile;
+
+    std::unique_ptr<GoldenImage> m_golden;
+
+    std::unique_ptr<QOffscreenSurface> m_surface;
+    std::unique_ptr<QOpenGLContext> m_context;
+    std::unique_ptr<QOpenGLFramebufferObject> m_fbo;
+
+    QString m_renderer;
+    std::vector<FrameTime> m_frameTimes;
+};
+
+#endif // OFFSCREENRUNNER_H
@@ -0,0 +1,150 @@
+#include "lightclusters.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LIGHTCLUSTERS_SSE2
+#include <emmintrin.h>
+#endif
+
+static_assert(LightClusters::TileCount % 4 == 0, "Tiles are tested in groups of four");
+
+void LightClusters::setProjection(const QMatrix4x4 &projection)
+{
+    if (!m_slices.empty() && projection == m_projection)
+        return;
+    m_projection = projection;
+
+    // for a GL perspective matrix m(2, 2) = -(f + n) / (f - n) and m(2, 3) = -2fn / (f - n)
+    const auto m22 = projection(2, 2);
+    const auto m23 = projection(2, 3);
+    m_near = m23 / (m22 - 1.0f);
+    m_far = m23 / (m22 + 1.0f);
+
+    // view-space x = ndcX * depth / m(0, 0), y likewise
+    const auto scaleX = 1.0f / projection(0, 0);
+    const auto scaleY = 1.0f / projection(1, 1);
+
+    m_slices.resize(Slices);
+    for (int z = 0; z < Slices; ++z) {
+        const auto nearDepth = m_near * std::pow(m_far / m_near, float(z) / Slices);
+        const auto farDepth = m_near * std::pow(m_far / m_near, float(z + 1) / Slices);
+        auto &slice = m_slices[size_t(z)];
+        slice.minZ = -farDepth;
+        slice.maxZ = -nearDepth;
+        for (int y = 0; y < TilesY; ++y) {
+            const auto ndcMinY = -1.0f + 2.0f * y / TilesY;
+            const auto ndcMaxY = -1.0f + 2.0f * (y + 1) / TilesY;
+            for (int x = 0; x < TilesX; ++x) {
+                const auto ndcMinX = -1.0f + 2.0f * x / TilesX;
+                const auto ndcMaxX = -1.0f + 2.0f * (x + 1) / TilesX;
+                const auto tile = x + TilesX * y;
+                slice.minX[tile] = std::min(ndcMinX * nearDepth, ndcMinX * farDepth) * scaleX;
+                slice.maxX[tile] = std::max(ndcMaxX * nearDepth, ndcMaxX * farDepth) * scaleX;
+                slice.minY[tile] = std::min(ndcMinY * nearDepth, ndcMinY * farDepth) * scaleY;
+                slice.maxY[tile] = std::max(ndcMaxY * nearDepth, ndcMaxY * farDepth) * scaleY;
+            }
+        }
+    }
+}
+
+float LightClusters::sliceScale() const noexcept
+{
+    return Slices / std::log(m_far / m_near);
+}
+
+float LightClusters::sliceBias() const noexcept
+{
+    return -Slices * std::log(m_near) / std::log(m_far / m_near);
+}
+
+void LightClusters::build(const std::vector<QVector4D> &lights)
+{
+    Q_ASSERT(!m_slices.empty());
+    Q_ASSERT(lights.size() <= 0x10000);
+
+    m_pairs.clear();
+    for (size_t i = 0; i < lights.size(); ++i) {
+        const auto &light = lights[i];
+        const auto depth = -light.z();
+        const auto radius = light.w();
+        if (depth + radius < m_near || depth - radius > m_far)
+            continue;
+
+        const auto first = slice(depth - radius);
+        const auto last = slice(depth + radius);
+        for (int z = first; z <= last; ++z)
+            testSlice(z, light, quint32(i));
+    }
+
+    // counting sort of the (cluster, light) pairs by cluster
+    m_grid.assign(2 * ClusterCount, 0);
+    for (const auto &pair: m_pairs)
+        ++m_grid[2 * pair.cluster + 1];
+
+    quint32 offset = 0;
+    for (int cluster = 0; cluster < ClusterCount; ++cluster) {
+        m_grid[size_t(2 * cluster)] = offset;
+        offset += m_grid[size_t(2 * cluster + 1)];
+    }
+
+    m_lightIndices.resize(m_pairs.size());
+    std::vector<quint32> cursor(ClusterCount);
+    for (const auto &pair: m_pairs) {
+        const auto position = m_grid[2 * pair.cluster] + cursor[pair.cluster]++;
+        m_lightIndices[position] = quint16(pair.light);
+    }
+}
+
+int LightClusters::slice(float depth) const
+{
+    if (depth <= m_near)
+        return 0;
+    const auto result = int(std::log(depth) * sliceScale() + sliceBias());
+    return std::min(std::max(result, 0), Slices - 1);
+}
+
+void LightClusters::testSlice(int z, const QVector4D &light, quint32 index)
+{
+    const auto &slice = m_slices[size_t(z)];
+    const auto dz = std::max({slice.minZ - light.z(), light.z() - slice.maxZ, 0.0f});
+    const auto radius2 = light.w() * light.w();
+    const auto remaining = radius2 - dz * dz;
+    if (remaining < 0.0f)
+        return;
+
+    const auto base = quint32(z * TileCount);
+
+#ifdef LIGHTCLUSTERS_SSE2
+    if (m_simd) {
+        const auto x = _mm_set1_ps(light.x());
+        const auto y = _mm_set1_ps(light.y());
+        const auto limit = _mm_set1_ps(remaining);
+        const auto zero = _mm_setzero_ps();
+        for (int tile = 0; tile < TileCount; tile += 4) {
+            // distance from the sphere's center to the AABB along x and y, 0 inside
+            const auto dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(slice.minX + tile), x),
+                                                  _mm_sub_ps(x, _mm_loadu_ps(slice.maxX + tile))), zero);
+            const auto dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(slice.minY + tile), y),
+                                                  _mm_sub_ps(y, _mm_loadu_ps(slice.maxY + tile))), zero);
+            const auto distance2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+            auto mask = _mm_movemask_ps(_mm_cmple_ps(distance2, limit));
+            while (mask) {
+                const auto lane = mask & -mask;
+                const auto bit = lane == 1 ? 0 : lane == 2 ? 1 : lane == 4 ? 2 : 3;
+                m_pairs.push_back({base + quint32(tile + bit), index});
+                mask &= mask - 1;
+            }
+        }
+        return;
+    }
+#endif
+
+    for (int tile = 0; tile < TileCount; ++tile) {
+        const auto dx = std::max({slice.minX[tile] - light.x(), light.x() - slice.maxX[tile], 0.0f});
+        const auto dy = std::max({slice.minY[tile] - light.y(), light.y() - slice.maxY[tile], 0.0f});
+        if (dx * dx + dy * dy <= remaining)
+            m_pairs.push_back({base + quint32(tile), index});
+    }
+}
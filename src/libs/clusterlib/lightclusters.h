@@ -0,0 +1,76 @@
+#ifndef LIGHTCLUSTERS_H
+#define LIGHTCLUSTERS_H
+
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QVector4D>
+
+#include <vector>
+
+// Assigns point lights to the clusters of the view frustum for clustered forward shading.
+// The frustum is split into TilesX x TilesY screen tiles and Slices depth slices, the slices
+// are spaced exponentially between the near and the far planes. Cluster (x, y, z) has the index
+// x + TilesX * (y + TilesY * z), tile (0, 0) is the bottom left one as in gl_FragCoord.
+// build() takes view-space spheres (x, y, z, radius) and fills grid() with the (offset, count)
+// pair of every cluster into lightIndices(). Spheres are tested against the clusters' AABBs,
+// four tiles at a time with SSE2 when available.
+class LightClusters
+{
+public:
+    static constexpr int TilesX = 16;
+    static constexpr int TilesY = 9;
+    static constexpr int Slices = 24;
+    static constexpr int TileCount = TilesX * TilesY;
+    static constexpr int ClusterCount = TileCount * Slices;
+
+    LightClusters() = default;
+
+    // Recomputes the clusters' bounds when the projection changes, expects a symmetric perspective
+    void setProjection(const QMatrix4x4 &projection);
+
+    float nearPlane() const noexcept { return m_near; }
+    float farPlane() const noexcept { return m_far; }
+
+    // slice = log(depth) * scale + bias, for the fragment shader
+    float sliceScale() const noexcept;
+    float sliceBias() const noexcept;
+
+    bool isSimdEnabled() const noexcept { return m_simd; }
+    void setSimdEnabled(bool enabled) noexcept { m_simd = enabled; }
+
+    void build(const std::vector<QVector4D> &lights);
+
+    const std::vector<quint32> &grid() const noexcept { return m_grid; }
+    const std::vector<quint16> &lightIndices() const noexcept { return m_lightIndices; }
+
+private:
+    struct Slice
+    {
+        float minZ {0.0f};
+        float maxZ {0.0f};
+        float minX[TileCount];
+        float maxX[TileCount];
+        float minY[TileCount];
+        float maxY[TileCount];
+    };
+
+    struct Pair
+    {
+        quint32 cluster;
+        quint32 light;
+    };
+
+    int slice(float depth) const;
+    void testSlice(int z, const QVector4D &light, quint32 index);
+
+private:
+    QMatrix4x4 m_projection;
+    float m_near {0.0f};
+    float m_far {0.0f};
+    bool m_simd {true};
+    std::vector<Slice> m_slices;
+    std::vector<Pair> m_pairs;
+    std::vector<quint32> m_grid;
+    std::vector<quint16> m_lightIndices;
+};
+
+#endif // LIGHTCLUSTERS_H
@@ -0,0 +1,127 @@
+#include "cubefield.h"
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <QtCore/QDebug>
+#include <QtCore/QLoggingCategory>
+
+#include <algorithm>
+#include <random>
+#include <type_traits>
+
+Q_LOGGING_CATEGORY(lcCubeField, "learnopengl.cubefield", QtInfoMsg)
+
+namespace {
+
+constexpr QVector3D cubePositions[] = {
+    {0.0f,  0.0f,  0.0f},
+    {2.0f,  5.0f, -15.0f},
+    {-1.5f, -2.2f, -2.5f},
+    {-3.8f, -2.0f, -12.3f},
+    {2.4f, -0.4f, -3.5f},
+    {-1.7f,  3.0f, -7.5f},
+    {1.3f, -2.0f, -2.5f},
+    {1.5f,  2.0f, -2.5f},
+    {1.5f,  0.2f, -1.5f},
+    {-1.3f,  1.0f, -1.5f}
+};
+
+constexpr int defaultCount = std::extent<decltype(cubePositions)>::value;
+
+// mat4 model + mat3 normal matrix
+constexpr int instanceFloats = 16 + 9;
+
+std::vector<GLfloat> instanceData(const std::vector<QMatrix4x4> &models)
+{
+    std::vector<GLfloat> data(models.size() * instanceFloats);
+    auto it = data.begin();
+    for (const auto &model: models) {
+        // both are column-major, as GL expects
+        it = std::copy(model.constData(), model.constData() + 16, it);
+        const auto normalMatrix = model.normalMatrix();
+        it = std::copy(normalMatrix.constData(), normalMatrix.constData() + 9, it);
+    }
+    return data;
+}
+
+} // namespace
+
+CubeField::CubeField(const QStringList &arguments)
+{
+    int count = defaultCount;
+    for (int i = 1; i < arguments.size(); ++i) {
+        if (arguments.at(i) == QLatin1String("--instanced")) {
+            m_instanced = true;
+        } else if (arguments.at(i) == QLatin1String("--cubes") && i + 1 < arguments.size()) {
+            count = std::max(1, arguments.at(++i).toInt());
+        }
+    }
+
+    const QVector3D axis(1.0f, 0.3f, 0.5f);
+    m_scene.reserve(count);
+    for (int i = 0; i < std::min(count, defaultCount); i++)
+        m_scene.addNode(-1, cubePositions[i], QQuaternion::fromAxisAndAngle(axis, 20.0f * i));
+
+    // the rest is scattered in front of the camera, within the far plane
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> xy(-40.0f, 40.0f);
+    std::uniform_real_distribution<float> z(-95.0f, -5.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+    for (int i = defaultCount; i < count; i++) {
+        // the arguments' evaluation order is unspecified, keep the sequence deterministic
+        const auto x = xy(generator);
+        const auto y = xy(generator);
+        const QVector3D position(x, y, z(generator));
+        m_scene.addNode(-1, position, QQuaternion::fromAxisAndAngle(axis, angle(generator)));
+    }
+    m_scene.update();
+}
+
+void CubeField::createInstanceBuffer(QOpenGLFunctions_3_3_Core *funcs, int modelLocation,
+                                     int normalMatrixLocation)
+{
+    const auto data = instanceData(models());
+
+    m_instanceVbo.create();
+    m_instanceVbo.bind();
+    m_instanceVbo.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    m_instanceVbo.allocate(data.data(), int(data.size() * sizeof(GLfloat)));
+
+    const auto stride = instanceFloats * sizeof(GLfloat);
+
+    // a mat4 attribute takes 4 consecutive vec4 locations
+    for (int column = 0; column < 4; ++column) {
+        const auto location = GLuint(modelLocation + column);
+        const auto offset = column * 4 * sizeof(GLfloat);
+        funcs->glEnableVertexAttribArray(location);
+        funcs->glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<GLvoid *>(offset));
+        funcs->glVertexAttribDivisor(location, 1);
+    }
+
+    if (normalMatrixLocation >= 0) {
+        for (int column = 0; column < 3; ++column) {
+            const auto location = GLuint(normalMatrixLocation + column);
+            const auto offset = (16 + column * 3) * sizeof(GLfloat);
+            funcs->glEnableVertexAttribArray(location);
+            funcs->glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<GLvoid *>(offset));
+            funcs->glVertexAttribDivisor(location, 1);
+        }
+    }
+
+    m_instanceVbo.release();
+
+    qCDebug(lcCubeField) << "Cube field:" << count() << "cubes," << data.size() * sizeof(GLfloat) / 1024 << "KiB of instance data";
+}
+
+void CubeField::updateInstanceBuffer(const GLfloat *data, int instanceCount)
+{
+    Q_ASSERT(instanceCount <= count());
+    m_instanceVbo.bind();
+    m_instanceVbo.write(0, data, instanceCount * instanceFloats * int(sizeof(GLfloat)));
+    m_instanceVbo.release();
+}
+
+void CubeField::destroy()
+{
+    m_instanceVbo.destroy();
+}
@@ -0,0 +1,47 @@
+#ifndef CUBEFIELD_H
+#define CUBEFIELD_H
+
+#include <scenegraph.h>
+
+#include <QOpenGLBuffer>
+
+#include <QtCore/QStringList>
+
+#include <vector>
+
+class QOpenGLFunctions_3_3_Core;
+
+// Model matrices of the examples' cubes: the ten classic cubePositions followed by
+// randomly placed cubes when more are requested with "--cubes <count>". The cubes are root
+// nodes of a SceneGraph, node i is cube i, so the matrices are computed once and then cached.
+// With "--instanced" (or setInstanced()) the cubes are meant to be drawn with a single
+// glDraw*Instanced call, reading the matrices from the instance buffer.
+class CubeField
+{
+public:
+    explicit CubeField(const QStringList &arguments);
+
+    int count() const noexcept { return m_scene.count(); }
+    const std::vector<QMatrix4x4> &models() const noexcept { return m_scene.worldMatrices(); }
+    const SceneGraph &scene() const noexcept { return m_scene; }
+
+    bool isInstanced() const noexcept { return m_instanced; }
+    void setInstanced(bool instanced) noexcept { m_instanced = instanced; }
+
+    // Uploads per-instance data and sets up the attributes of the currently bound VAO:
+    // mat4 model at modelLocation (4 slots) and mat3 normal matrix at normalMatrixLocation
+    // (3 slots), pass -1 to skip the normal matrix.
+    void createInstanceBuffer(QOpenGLFunctions_3_3_Core *funcs, int modelLocation,
+                              int normalMatrixLocation = -1);
+    // Rewrites the first instanceCount instances with data packed as mat4 model followed by
+    // mat3 normal matrix, e.g. RenderList::data()
+    void updateInstanceBuffer(const GLfloat *data, int instanceCount);
+    void destroy();
+
+private:
+    bool m_instanced {false};
+    SceneGraph m_scene;
+    QOpenGLBuffer m_instanceVbo {QOpenGLBuffer::VertexBuffer};
+};
+
+#endif // CUBEFIELD_H
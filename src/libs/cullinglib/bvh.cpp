@@ -0,0 +1,307 @@
+#include "bvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// spreads the lower 10 bits so that two zero bits follow each of them
+quint32 expandBits(quint32 v)
+{
+    v = (v * 0x00010001u) & 0xff0000ffu;
+    v = (v * 0x00000101u) & 0x0f00f00fu;
+    v = (v * 0x00000011u) & 0xc30c30c3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+quint32 quantize(float value)
+{
+    return quint32(std::min(std::max(value * 1024.0f, 0.0f), 1023.0f));
+}
+
+quint32 morton(const QVector3D &unit)
+{
+    return expandBits(quantize(unit.x())) << 2 | expandBits(quantize(unit.y())) << 1
+            | expandBits(quantize(unit.z()));
+}
+
+int highestBit(quint32 value)
+{
+    int result = -1;
+    for (; value; value >>= 1)
+        ++result;
+    return result;
+}
+
+QVector3D minimum(const QVector3D &lhs, const QVector3D &rhs)
+{
+    return {std::min(lhs.x(), rhs.x()), std::min(lhs.y(), rhs.y()), std::min(lhs.z(), rhs.z())};
+}
+
+QVector3D maximum(const QVector3D &lhs, const QVector3D &rhs)
+{
+    return {std::max(lhs.x(), rhs.x()), std::max(lhs.y(), rhs.y()), std::max(lhs.z(), rhs.z())};
+}
+
+QVector3D absolute(const QVector3D &vector)
+{
+    return {std::abs(vector.x()), std::abs(vector.y()), std::abs(vector.z())};
+}
+
+enum class Side {
+    Outside,
+    Intersects,
+    Inside
+};
+
+// Tests a box against the planes whose bits are set in mask and clears the bits of the planes
+// the box is entirely in front of
+Side classify(const std::array<QVector4D, 6> &planes, const QVector3D &min, const QVector3D &max, int &mask)
+{
+    const auto center = (min + max) * 0.5f;
+    const auto extent = (max - min) * 0.5f;
+    for (int i = 0; i < 6; ++i) {
+        if (!(mask & (1 << i)))
+            continue;
+
+        const auto normal = planes[size_t(i)].toVector3D();
+        const auto distance = QVector3D::dotProduct(normal, center) + planes[size_t(i)].w();
+        const auto radius = QVector3D::dotProduct(absolute(normal), extent);
+        if (distance + radius < 0.0f)
+            return Side::Outside;
+        if (distance - radius >= 0.0f)
+            mask &= ~(1 << i);
+    }
+    return mask ? Side::Intersects : Side::Inside;
+}
+
+// Distance along the ray to the box or infinity, inverse is 1 / direction
+float intersect(const QVector3D &origin, const QVector3D &inverse, const QVector3D &min, const QVector3D &max)
+{
+    const auto t1 = (min - origin) * inverse;
+    const auto t2 = (max - origin) * inverse;
+    const auto tNear = std::max({std::min(t1.x(), t2.x()), std::min(t1.y(), t2.y()), std::min(t1.z(), t2.z()), 0.0f});
+    const auto tFar = std::min({std::max(t1.x(), t2.x()), std::max(t1.y(), t2.y()), std::max(t1.z(), t2.z())});
+    return tNear <= tFar ? tNear : std::numeric_limits<float>::infinity();
+}
+
+} // namespace
+
+void Bvh::build(const std::vector<Box> &boxes)
+{
+    m_boxes = boxes;
+    m_nodes.clear();
+    m_depth = 0;
+
+    const auto count = int(boxes.size());
+    m_objects.resize(boxes.size());
+    m_codes.resize(boxes.size());
+    m_objectLeaves.resize(boxes.size());
+    if (count == 0)
+        return;
+
+    // Morton codes of the box centers within the bounds of all centers
+    QVector3D min = (boxes.front().min + boxes.front().max) * 0.5f;
+    QVector3D max = min;
+    for (const auto &box: boxes) {
+        const auto center = (box.min + box.max) * 0.5f;
+        min = minimum(min, center);
+        max = maximum(max, center);
+    }
+    const auto size = max - min;
+    const QVector3D scale(size.x() > 0.0f ? 1.0f / size.x() : 0.0f,
+                          size.y() > 0.0f ? 1.0f / size.y() : 0.0f,
+                          size.z() > 0.0f ? 1.0f / size.z() : 0.0f);
+
+    // the code and the object in one key keep the sort direct and stable
+    std::vector<quint64> keys(boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        const auto code = morton(((boxes[i].min + boxes[i].max) * 0.5f - min) * scale);
+        keys[i] = quint64(code) << 32 | quint64(i);
+    }
+    std::sort(keys.begin(), keys.end());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        m_codes[i] = quint32(keys[i] >> 32);
+        m_objects[i] = int(keys[i] & 0xffffffffu);
+    }
+
+    m_nodes.reserve(size_t(2 * (count / LeafSize + 1)));
+    m_nodes.push_back({});
+    split(0, 0, count, -1, 1);
+}
+
+void Bvh::split(int index, int begin, int end, int parent, int depth)
+{
+    m_depth = std::max(m_depth, depth);
+    m_nodes[size_t(index)].begin = begin;
+    m_nodes[size_t(index)].end = end;
+    m_nodes[size_t(index)].parent = parent;
+
+    if (end - begin <= LeafSize) {
+        m_nodes[size_t(index)].left = -1;
+        for (int i = begin; i < end; ++i)
+            m_objectLeaves[size_t(m_objects[size_t(i)])] = index;
+        updateNode(m_nodes[size_t(index)]);
+        return;
+    }
+
+    // the objects are sorted, so the ones with the highest differing bit cleared come first
+    const auto first = m_codes[size_t(begin)];
+    const auto last = m_codes[size_t(end - 1)];
+    int middle = begin + (end - begin) / 2;
+    if (first != last) {
+        const auto bit = highestBit(first ^ last);
+        middle = int(std::partition_point(m_codes.begin() + begin, m_codes.begin() + end, [bit](quint32 code) {
+            return !((code >> bit) & 1u);
+        }) - m_codes.begin());
+    }
+
+    const auto left = int(m_nodes.size());
+    m_nodes[size_t(index)].left = left;
+    m_nodes.push_back({});
+    m_nodes.push_back({});
+    split(left, begin, middle, index, depth + 1);
+    split(left + 1, middle, end, index, depth + 1);
+    updateNode(m_nodes[size_t(index)]);
+}
+
+void Bvh::updateNode(Node &node) const
+{
+    if (node.left >= 0) {
+        const auto &left = m_nodes[size_t(node.left)];
+        const auto &right = m_nodes[size_t(node.left + 1)];
+        node.min = minimum(left.min, right.min);
+        node.max = maximum(left.max, right.max);
+        return;
+    }
+
+    const auto &first = m_boxes[size_t(m_objects[size_t(node.begin)])];
+    node.min = first.min;
+    node.max = first.max;
+    for (int i = node.begin + 1; i < node.end; ++i) {
+        const auto &box = m_boxes[size_t(m_objects[size_t(i)])];
+        node.min = minimum(node.min, box.min);
+        node.max = maximum(node.max, box.max);
+    }
+}
+
+void Bvh::setBox(int object, const Box &box)
+{
+    m_boxes[size_t(object)] = box;
+
+    // stop as soon as a node's box doesn't change, its ancestors won't either
+    for (int index = m_objectLeaves[size_t(object)]; index >= 0; index = m_nodes[size_t(index)].parent) {
+        auto &node = m_nodes[size_t(index)];
+        const auto min = node.min;
+        const auto max = node.max;
+        updateNode(node);
+        if (node.min == min && node.max == max)
+            break;
+    }
+}
+
+void Bvh::refit(const std::vector<Box> &boxes)
+{
+    Q_ASSERT(boxes.size() == m_boxes.size());
+    m_boxes = boxes;
+
+    // children are always stored after their parents
+    for (auto it = m_nodes.rbegin(); it != m_nodes.rend(); ++it)
+        updateNode(*it);
+}
+
+void Bvh::cull(const QMatrix4x4 &viewProjection, std::vector<int> &visible) const
+{
+    if (m_nodes.empty())
+        return;
+
+    const auto planes = FrustumCuller::planes(viewProjection);
+
+    struct Entry
+    {
+        int node;
+        int mask;
+    };
+    std::vector<Entry> stack;
+    stack.reserve(size_t(2 * m_depth + 1));
+    stack.push_back({0, 0x3f});
+
+    while (!stack.empty()) {
+        auto entry = stack.back();
+        stack.pop_back();
+
+        const auto &node = m_nodes[size_t(entry.node)];
+        const auto side = classify(planes, node.min, node.max, entry.mask);
+        if (side == Side::Outside)
+            continue;
+
+        if (side == Side::Inside) {
+            visible.insert(visible.end(), m_objects.begin() + node.begin, m_objects.begin() + node.end);
+        } else if (node.left < 0) {
+            for (int i = node.begin; i < node.end; ++i) {
+                const auto object = m_objects[size_t(i)];
+                auto mask = entry.mask;
+                const auto &box = m_boxes[size_t(object)];
+                if (classify(planes, box.min, box.max, mask) != Side::Outside)
+                    visible.push_back(object);
+            }
+        } else {
+            stack.push_back({node.left + 1, entry.mask});
+            stack.push_back({node.left, entry.mask});
+        }
+    }
+}
+
+int Bvh::pick(const QVector3D &origin, const QVector3D &direction, float *distance) const
+{
+    int result = -1;
+    auto nearest = std::numeric_limits<float>::infinity();
+    if (m_nodes.empty())
+        return result;
+
+    const QVector3D inverse(1.0f / direction.x(), 1.0f / direction.y(), 1.0f / direction.z());
+
+    std::vector<int> stack;
+    stack.reserve(size_t(2 * m_depth + 1));
+    stack.push_back(0);
+
+    while (!stack.empty()) {
+        const auto &node = m_nodes[size_t(stack.back())];
+        stack.pop_back();
+
+        if (!(intersect(origin, inverse, node.min, node.max) < nearest))
+            continue;
+
+        if (node.left < 0) {
+            for (int i = node.begin; i < node.end; ++i) {
+                const auto object = m_objects[size_t(i)];
+                const auto &box = m_boxes[size_t(object)];
+                const auto t = intersect(origin, inverse, box.min, box.max);
+                if (t < nearest) {
+                    nearest = t;
+                    result = object;
+                }
+            }
+            continue;
+        }
+
+        // the nearer child is visited first, so it can prune the other one
+        const auto &left = m_nodes[size_t(node.left)];
+        const auto &right = m_nodes[size_t(node.left + 1)];
+        const auto leftDistance = intersect(origin, inverse, left.min, left.max);
+        const auto rightDistance = intersect(origin, inverse, right.min, right.max);
+        if (leftDistance < rightDistance) {
+            stack.push_back(node.left + 1);
+            stack.push_back(node.left);
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.left + 1);
+        }
+    }
+
+    if (distance && result >= 0)
+        *distance = nearest;
+    return result;
+}
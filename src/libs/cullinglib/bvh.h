@@ -0,0 +1,61 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include "frustumculler.h"
+
+#include <vector>
+
+// Bounding volume hierarchy over object AABBs, built as an LBVH: objects are sorted by the
+// Morton codes of their centers and split top-down at the highest differing bit, leaves hold
+// up to LeafSize objects. Every node covers a contiguous range of the sorted objects, so a node
+// that is entirely inside the frustum is appended without visiting its children.
+// Moving objects keep the topology: setBox() refits the path from the object's leaf to the root,
+// refit() refits all nodes; rebuild when the objects moved far and the queries get slower.
+class Bvh
+{
+public:
+    using Box = FrustumCuller::Box;
+
+    static constexpr int LeafSize = 4;
+
+    Bvh() = default;
+
+    void build(const std::vector<Box> &boxes);
+
+    void setBox(int object, const Box &box);
+    void refit(const std::vector<Box> &boxes);
+
+    int count() const noexcept { return int(m_boxes.size()); }
+    int nodeCount() const noexcept { return int(m_nodes.size()); }
+    int depth() const noexcept { return m_depth; }
+
+    // Appends the objects whose boxes intersect the frustum of viewProjection, in BVH order
+    void cull(const QMatrix4x4 &viewProjection, std::vector<int> &visible) const;
+
+    // The object whose box the ray hits first or -1, distance is along direction
+    int pick(const QVector3D &origin, const QVector3D &direction, float *distance = nullptr) const;
+
+private:
+    struct Node
+    {
+        QVector3D min;
+        QVector3D max;
+        int begin;
+        int end;
+        int left; // the right child is left + 1, -1 for leaves
+        int parent;
+    };
+
+    void split(int index, int begin, int end, int parent, int depth);
+    void updateNode(Node &node) const;
+
+private:
+    std::vector<Box> m_boxes;
+    std::vector<quint32> m_codes;
+    std::vector<int> m_objects;
+    std::vector<int> m_objectLeaves;
+    std::vector<Node> m_nodes;
+    int m_depth {0};
+};
+
+#endif // BVH_H
@@ -0,0 +1,233 @@
+#include "frustumculler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRUSTUMCULLER_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX is compiled per function and selected at runtime, the rest of the build stays baseline x86-64
+#if defined(FRUSTUMCULLER_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define FRUSTUMCULLER_AVX
+#define FRUSTUMCULLER_AVX_TARGET __attribute__((target("avx")))
+#include <immintrin.h>
+#endif
+
+namespace {
+
+#ifdef FRUSTUMCULLER_SSE2
+int *appendMask(int *out, int mask, int first)
+{
+    for (; mask; mask >>= 1, ++first) {
+        if (mask & 1)
+            *out++ = first;
+    }
+    return out;
+}
+#endif
+
+} // namespace
+
+FrustumCuller::Instructions FrustumCuller::bestInstructions() noexcept
+{
+#if defined(FRUSTUMCULLER_AVX)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx"))
+        return Instructions::Avx;
+#endif
+#if defined(FRUSTUMCULLER_SSE2)
+    return Instructions::Sse2;
+#else
+    return Instructions::Scalar;
+#endif
+}
+
+void FrustumCuller::setInstructions(Instructions instructions) noexcept
+{
+    m_instructions = std::min(instructions, bestInstructions());
+}
+
+void FrustumCuller::setSpheres(const std::vector<QVector4D> &spheres)
+{
+    m_boxes = false;
+    m_x.resize(spheres.size());
+    m_y.resize(spheres.size());
+    m_z.resize(spheres.size());
+    m_radius.resize(spheres.size());
+    for (size_t i = 0; i < spheres.size(); ++i) {
+        m_x[i] = spheres[i].x();
+        m_y[i] = spheres[i].y();
+        m_z[i] = spheres[i].z();
+        m_radius[i] = spheres[i].w();
+    }
+    m_extentX.clear();
+    m_extentY.clear();
+    m_extentZ.clear();
+}
+
+void FrustumCuller::setBoxes(const std::vector<Box> &boxes)
+{
+    m_boxes = true;
+    m_x.resize(boxes.size());
+    m_y.resize(boxes.size());
+    m_z.resize(boxes.size());
+    m_extentX.resize(boxes.size());
+    m_extentY.resize(boxes.size());
+    m_extentZ.resize(boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        const auto center = (boxes[i].min + boxes[i].max) * 0.5f;
+        const auto extent = (boxes[i].max - boxes[i].min) * 0.5f;
+        m_x[i] = center.x();
+        m_y[i] = center.y();
+        m_z[i] = center.z();
+        m_extentX[i] = extent.x();
+        m_extentY[i] = extent.y();
+        m_extentZ[i] = extent.z();
+    }
+    m_radius.clear();
+}
+
+std::array<QVector4D, 6> FrustumCuller::planes(const QMatrix4x4 &viewProjection)
+{
+    // Gribb-Hartmann: a clip-space point is inside when -w <= x, y, z <= w
+    const auto w = viewProjection.row(3);
+    std::array<QVector4D, 6> result = {{
+        w + viewProjection.row(0),
+        w - viewProjection.row(0),
+        w + viewProjection.row(1),
+        w - viewProjection.row(1),
+        w + viewProjection.row(2),
+        w - viewProjection.row(2),
+    }};
+    for (auto &plane: result)
+        plane /= plane.toVector3D().length();
+    return result;
+}
+
+void FrustumCuller::setViewProjection(const QMatrix4x4 &viewProjection)
+{
+    const auto planes = FrustumCuller::planes(viewProjection);
+    for (size_t i = 0; i < m_planes.size(); ++i)
+        m_planes[i] = {planes[i].x(), planes[i].y(), planes[i].z(), planes[i].w()};
+}
+
+const std::vector<int> &FrustumCuller::cull()
+{
+    m_visible.clear();
+    cull(0, count(), m_visible);
+    return m_visible;
+}
+
+void FrustumCuller::cull(int begin, int end, std::vector<int> &visible) const
+{
+    Q_ASSERT(begin >= 0 && begin <= end && end <= count());
+    const auto offset = visible.size();
+    visible.resize(offset + size_t(end - begin));
+    auto out = visible.data() + offset;
+
+    auto i = begin;
+    if (m_instructions == Instructions::Avx) {
+        i = begin + ((end - begin) & ~7);
+        out = cullAvx(begin, i, out);
+    } else if (m_instructions == Instructions::Sse2) {
+        i = begin + ((end - begin) & ~3);
+        out = cullSse2(begin, i, out);
+    }
+
+    out = cullScalar(i, end, out);
+    visible.resize(size_t(out - visible.data()));
+}
+
+int *FrustumCuller::cullScalar(int begin, int end, int *out) const
+{
+    for (auto i = size_t(begin); i < size_t(end); ++i) {
+        bool visible = true;
+        for (const auto &plane: m_planes) {
+            // same operation order as the SIMD loops, so all paths agree on the boundary
+            const auto distance = (plane.a * m_x[i] + plane.b * m_y[i]) + (plane.c * m_z[i] + plane.d);
+            const auto radius = m_boxes
+                    ? std::abs(plane.a) * m_extentX[i] + std::abs(plane.b) * m_extentY[i]
+                      + std::abs(plane.c) * m_extentZ[i]
+                    : m_radius[i];
+            if (!(distance + radius >= 0.0f)) {
+                visible = false;
+                break;
+            }
+        }
+        if (visible)
+            *out++ = int(i);
+    }
+    return out;
+}
+
+int *FrustumCuller::cullSse2(int begin, int end, int *out) const
+{
+#ifdef FRUSTUMCULLER_SSE2
+    for (int i = begin; i < end; i += 4) {
+        const auto x = _mm_loadu_ps(m_x.data() + i);
+        const auto y = _mm_loadu_ps(m_y.data() + i);
+        const auto z = _mm_loadu_ps(m_z.data() + i);
+
+        auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const auto &plane: m_planes) {
+            const auto distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.a), x),
+                                                        _mm_mul_ps(_mm_set1_ps(plane.b), y)),
+                                             _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.c), z),
+                                                        _mm_set1_ps(plane.d)));
+            __m128 radius;
+            if (m_boxes) {
+                radius = _mm_add_ps(_mm_add_ps(
+                        _mm_mul_ps(_mm_set1_ps(std::abs(plane.a)), _mm_loadu_ps(m_extentX.data() + i)),
+                        _mm_mul_ps(_mm_set1_ps(std::abs(plane.b)), _mm_loadu_ps(m_extentY.data() + i))),
+                        _mm_mul_ps(_mm_set1_ps(std::abs(plane.c)), _mm_loadu_ps(m_extentZ.data() + i)));
+            } else {
+                radius = _mm_loadu_ps(m_radius.data() + i);
+            }
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+        out = appendMask(out, _mm_movemask_ps(inside), i);
+    }
+    return out;
+#else
+    return cullScalar(begin, end, out);
+#endif
+}
+
+#ifdef FRUSTUMCULLER_AVX
+FRUSTUMCULLER_AVX_TARGET
+#endif
+int *FrustumCuller::cullAvx(int begin, int end, int *out) const
+{
+#ifdef FRUSTUMCULLER_AVX
+    for (int i = begin; i < end; i += 8) {
+        const auto x = _mm256_loadu_ps(m_x.data() + i);
+        const auto y = _mm256_loadu_ps(m_y.data() + i);
+        const auto z = _mm256_loadu_ps(m_z.data() + i);
+
+        auto inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const auto &plane: m_planes) {
+            const auto distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.a), x),
+                                                              _mm256_mul_ps(_mm256_set1_ps(plane.b), y)),
+                                                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.c), z),
+                                                              _mm256_set1_ps(plane.d)));
+            __m256 radius;
+            if (m_boxes) {
+                radius = _mm256_add_ps(_mm256_add_ps(
+                        _mm256_mul_ps(_mm256_set1_ps(std::abs(plane.a)), _mm256_loadu_ps(m_extentX.data() + i)),
+                        _mm256_mul_ps(_mm256_set1_ps(std::abs(plane.b)), _mm256_loadu_ps(m_extentY.data() + i))),
+                        _mm256_mul_ps(_mm256_set1_ps(std::abs(plane.c)), _mm256_loadu_ps(m_extentZ.data() + i)));
+            } else {
+                radius = _mm256_loadu_ps(m_radius.data() + i);
+            }
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius),
+                                                         _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        out = appendMask(out, _mm256_movemask_ps(inside), i);
+    }
+    return out;
+#else
+    return cullSse2(begin, end, out);
+#endif
+}
@@ -0,0 +1,91 @@
+#ifndef FRUSTUMCULLER_H
+#define FRUSTUMCULLER_H
+
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QVector3D>
+#include <QtGui/QVector4D>
+
+#include <array>
+#include <vector>
+
+// Tests bounding volumes against the view frustum and returns the indices of the visible ones.
+// The planes are extracted from projection * view, so the bounds are in world space.
+// Bounds are either spheres or AABBs, stored as structure of arrays and tested four at a time
+// with SSE2 or eight at a time with AVX when the CPU supports it. The tests are conservative:
+// volumes that intersect the planes but lie outside a corner of the frustum pass.
+class FrustumCuller
+{
+public:
+    enum class Instructions {
+        Scalar,
+        Sse2,
+        Avx
+    };
+
+    struct Box
+    {
+        QVector3D min;
+        QVector3D max;
+    };
+
+    FrustumCuller() = default;
+
+    // The best instruction set available on this CPU
+    static Instructions bestInstructions() noexcept;
+
+    // Normalized left, right, bottom, top, near and far planes (a, b, c, d), pointing inside
+    static std::array<QVector4D, 6> planes(const QMatrix4x4 &viewProjection);
+
+    Instructions instructions() const noexcept { return m_instructions; }
+    // Falls back to the best available set if the requested one is not supported
+    void setInstructions(Instructions instructions) noexcept;
+
+    int count() const noexcept { return int(m_x.size()); }
+
+    // (x, y, z, radius)
+    void setSpheres(const std::vector<QVector4D> &spheres);
+    void setBoxes(const std::vector<Box> &boxes);
+
+    void setViewProjection(const QMatrix4x4 &viewProjection);
+
+    // Fills visible() in the original order
+    const std::vector<int> &cull();
+    const std::vector<int> &visible() const noexcept { return m_visible; }
+
+    // Appends the visible volumes among [begin, end) to visible, in the original order;
+    // doesn't touch visible(), so threads can cull disjoint ranges at the same time
+    void cull(int begin, int end, std::vector<int> &visible) const;
+
+private:
+    struct Plane
+    {
+        float a;
+        float b;
+        float c;
+        float d;
+    };
+
+    // All of them test [begin, end) and return the end of the written indices,
+    // the SIMD ones expect the range to be a multiple of their width
+    int *cullScalar(int begin, int end, int *out) const;
+    int *cullSse2(int begin, int end, int *out) const;
+    int *cullAvx(int begin, int end, int *out) const;
+
+private:
+    Instructions m_instructions {bestInstructions()};
+    bool m_boxes {false};
+    std::array<Plane, 6> m_planes {};
+
+    // sphere centers and radii or box centers and half extents
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_z;
+    std::vector<float> m_radius;
+    std::vector<float> m_extentX;
+    std::vector<float> m_extentY;
+    std::vector<float> m_extentZ;
+
+    std::vector<int> m_visible;
+};
+
+#endif // FRUSTUMCULLER_H
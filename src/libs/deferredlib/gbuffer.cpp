@@ -0,0 +1,106 @@
+#include "gbuffer.h"
+
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <QtCore/QDebug>
+#include <QtCore/QLoggingCategory>
+
+Q_LOGGING_CATEGORY(lcGBuffer, "learnopengl.gbuffer", QtInfoMsg)
+
+GBuffer::GBuffer() = default;
+
+GBuffer::~GBuffer() = default;
+
+bool GBuffer::create(QOpenGLFunctions_3_3_Core *funcs, const QSize &size)
+{
+    if (m_fbo && size == m_size)
+        return true;
+
+    destroy();
+    if (size.isEmpty())
+        return false;
+
+    m_funcs = funcs;
+    m_size = size;
+    m_fbo = std::make_unique<QOpenGLFramebufferObject>(size, QOpenGLFramebufferObject::Depth,
+                                                       GL_TEXTURE_2D, GL_RGBA32F);
+    m_fbo->addColorAttachment(size, GL_RGBA16F);
+    m_fbo->addColorAttachment(size, GL_RGBA8);
+    if (!m_fbo->isValid()) {
+        qWarning() << "Can't create G-buffer of size" << size;
+        m_fbo.reset();
+        return false;
+    }
+
+    // the passes read the attachments with texelFetch, no mipmaps and no filtering
+    for (const auto texture: m_fbo->textures()) {
+        m_funcs->glBindTexture(GL_TEXTURE_2D, texture);
+        m_funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        m_funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    m_funcs->glBindTexture(GL_TEXTURE_2D, 0);
+
+    // draw buffers are framebuffer state, so they are set only once
+    GLint previousFramebuffer = 0;
+    m_funcs->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    m_fbo->bind();
+    const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2};
+    m_funcs->glDrawBuffers(AttachmentCount, drawBuffers);
+    m_funcs->glBindFramebuffer(GL_FRAMEBUFFER, GLuint(previousFramebuffer));
+
+    qCDebug(lcGBuffer) << "G-buffer:" << size << "," << size.width() * size.height() * (16 + 8 + 4 + 4) / 1024 << "KiB";
+    return true;
+}
+
+void GBuffer::destroy()
+{
+    m_fbo.reset();
+    m_size = QSize();
+}
+
+void GBuffer::bind()
+{
+    m_funcs->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_previousFramebuffer);
+    m_funcs->glGetIntegerv(GL_VIEWPORT, m_previousViewport);
+    m_fbo->bind();
+    m_funcs->glViewport(0, 0, m_size.width(), m_size.height());
+
+    // the depth in Position.a stays at the far plane where nothing is drawn
+    const GLfloat farPosition[] = {0.0f, 0.0f, 0.0f, 1.0f};
+    const GLfloat zero[] = {0.0f, 0.0f, 0.0f, 0.0f};
+    m_funcs->glClearBufferfv(GL_COLOR, Position, farPosition);
+    m_funcs->glClearBufferfv(GL_COLOR, Normal, zero);
+    m_funcs->glClearBufferfv(GL_COLOR, AlbedoSpecular, zero);
+    m_funcs->glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void GBuffer::release()
+{
+    m_funcs->glBindFramebuffer(GL_FRAMEBUFFER, GLuint(m_previousFramebuffer));
+    m_funcs->glViewport(m_previousViewport[0], m_previousViewport[1],
+                        m_previousViewport[2], m_previousViewport[3]);
+}
+
+void GBuffer::bindTextures(int firstUnit)
+{
+    for (int i = 0; i < AttachmentCount; ++i) {
+        m_funcs->glActiveTexture(GLenum(GL_TEXTURE0 + firstUnit + i));
+        m_funcs->glBindTexture(GL_TEXTURE_2D, texture(Attachment(i)));
+    }
+    m_funcs->glActiveTexture(GL_TEXTURE0);
+}
+
+void GBuffer::releaseTextures(int firstUnit)
+{
+    for (int i = 0; i < AttachmentCount; ++i) {
+        m_funcs->glActiveTexture(GLenum(GL_TEXTURE0 + firstUnit + i));
+        m_funcs->glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    m_funcs->glActiveTexture(GL_TEXTURE0);
+}
+
+GLuint GBuffer::texture(Attachment attachment) const
+{
+    return m_fbo ? m_fbo->textures().at(attachment) : 0;
+}
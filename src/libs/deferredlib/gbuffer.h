@@ -0,0 +1,63 @@
+#ifndef GBUFFER_H
+#define GBUFFER_H
+
+#include <QtCore/QSize>
+
+#include <QtGui/qopengl.h>
+
+#include <memory>
+
+class QOpenGLFramebufferObject;
+class QOpenGLFunctions_3_3_Core;
+
+// Geometry buffer of the deferred renderer, a QOpenGLFramebufferObject with a depth buffer and
+// three color attachments written by the geometry pass:
+//  - Position: world-space position in rgb and the window-space depth in a, RGBA32F;
+//  - Normal: world-space normal in rgb, RGBA16F;
+//  - AlbedoSpecular: diffuse color in rgb and specular intensity in a, RGBA8.
+// Pixels not covered by geometry have depth 1.0, the lighting passes read the attachments
+// with texelFetch at gl_FragCoord.
+class GBuffer
+{
+public:
+    enum Attachment {
+        Position,
+        Normal,
+        AlbedoSpecular,
+        AttachmentCount
+    };
+
+    GBuffer();
+    GBuffer(const GBuffer &) = delete;
+    ~GBuffer();
+
+    GBuffer &operator=(const GBuffer &) = delete;
+
+    bool isCreated() const noexcept { return m_fbo != nullptr; }
+    QSize size() const noexcept { return m_size; }
+
+    // (Re)creates the attachments when the size changes. size is in device pixels and must be
+    // the size of the framebuffer the lighting passes draw into, they texelFetch at gl_FragCoord
+    bool create(QOpenGLFunctions_3_3_Core *funcs, const QSize &size);
+    void destroy();
+
+    // Binds the framebuffer for the geometry pass, sets the viewport to its size and clears it,
+    // release() binds the framebuffer that was bound before, e.g. the offscreen runner's one
+    // rather than the context's default, and restores its viewport
+    void bind();
+    void release();
+    // Binds the attachments to the texture units firstUnit, firstUnit + 1 and firstUnit + 2
+    void bindTextures(int firstUnit);
+    void releaseTextures(int firstUnit);
+
+    GLuint texture(Attachment attachment) const;
+
+private:
+    QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
+    std::unique_ptr<QOpenGLFramebufferObject> m_fbo;
+    QSize m_size;
+    GLint m_previousFramebuffer {0};
+    GLint m_previousViewport[4] {};
+};
+
+#endif // GBUFFER_H
@@ -0,0 +1,48 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QQuaternion>
+#include <QtGui/QVector3D>
+
+// Components of the renderable entities, stored by EntityWorld
+
+struct Transform
+{
+    QVector3D position;
+    QQuaternion rotation;
+    QVector3D scale {1.0f, 1.0f, 1.0f};
+};
+
+// Written by updateModelMatrices() from the Transform
+struct ModelMatrix
+{
+    QMatrix4x4 matrix;
+};
+
+// Index into the meshes owned by the renderer
+struct MeshInstance
+{
+    int mesh {0};
+};
+
+// Texture units of the maps and the specular exponent, as in the examples' Material struct
+struct Material
+{
+    int diffuse {0};
+    int specular {1};
+    float shininess {32.0f};
+};
+
+// Point light placed at the entity's Transform position
+struct Light
+{
+    QVector3D ambient {0.2f, 0.2f, 0.2f};
+    QVector3D diffuse {0.5f, 0.5f, 0.5f};
+    QVector3D specular {1.0f, 1.0f, 1.0f};
+    float constant {1.0f};
+    float linear {0.09f};
+    float quadratic {0.032f};
+};
+
+#endif // COMPONENTS_H
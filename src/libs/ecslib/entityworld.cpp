@@ -0,0 +1,180 @@
+#include "entityworld.h"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <mutex>
+
+namespace {
+
+constexpr int arrayAlignment = int(alignof(std::max_align_t));
+
+// sizes of the registered component types, indexed by EntityWorld::componentType()
+std::array<int, EntityWorld::MaxComponentTypes> componentSizes;
+
+int alignUp(int value, int alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+EntityWorld::~EntityWorld() = default;
+
+void EntityWorld::destroy(Entity entity)
+{
+    Q_ASSERT(isAlive(entity));
+    release(m_locations[size_t(entity)]);
+    m_locations[size_t(entity)] = {-1, -1, -1};
+    m_freeEntities.push_back(entity);
+    --m_count;
+}
+
+bool EntityWorld::isAlive(Entity entity) const noexcept
+{
+    return entity >= 0 && size_t(entity) < m_locations.size() && m_locations[size_t(entity)].archetype >= 0;
+}
+
+int EntityWorld::chunkCount() const noexcept
+{
+    int result = 0;
+    for (const auto &archetype: m_archetypes)
+        result += int(archetype.chunks.size());
+    return result;
+}
+
+EntityWorld::Mask EntityWorld::mask(Entity entity) const
+{
+    Q_ASSERT(isAlive(entity));
+    return m_archetypes[size_t(m_locations[size_t(entity)].archetype)].mask;
+}
+
+int EntityWorld::registerComponent(int size)
+{
+    // types register on their first use, which may happen on any thread
+    static std::mutex mutex;
+    static int count = 0;
+    std::lock_guard<std::mutex> lock(mutex);
+    // checked in release builds too, the type would index past componentSizes and the Mask bits
+    if (count >= MaxComponentTypes)
+        qFatal("EntityWorld: more than %d component types", MaxComponentTypes);
+    componentSizes[size_t(count)] = size;
+    return count++;
+}
+
+int EntityWorld::archetype(Mask mask)
+{
+    for (size_t i = 0; i < m_archetypes.size(); ++i) {
+        if (m_archetypes[i].mask == mask)
+            return int(i);
+    }
+
+    Archetype archetype;
+    archetype.mask = mask;
+    std::fill(std::begin(archetype.offsets), std::end(archetype.offsets), -1);
+    std::fill(std::begin(archetype.sizes), std::end(archetype.sizes), 0);
+
+    int rowBytes = int(sizeof(Entity));
+    for (int type = 0; type < MaxComponentTypes; ++type) {
+        if (mask & (Mask(1) << type)) {
+            archetype.sizes[type] = componentSizes[size_t(type)];
+            rowBytes += archetype.sizes[type];
+        }
+    }
+
+    // the entity ids come first, then one array per component, each aligned for SIMD loads
+    const auto layout = [&archetype](int capacity) {
+        int offset = alignUp(capacity * int(sizeof(Entity)), arrayAlignment);
+        for (int type = 0; type < MaxComponentTypes; ++type) {
+            if (archetype.sizes[type] == 0)
+                continue;
+            archetype.offsets[type] = offset;
+            offset = alignUp(offset + capacity * archetype.sizes[type], arrayAlignment);
+        }
+        return offset;
+    };
+
+    archetype.capacity = std::max(1, ChunkBytes / rowBytes);
+    while (archetype.capacity > 1 && layout(archetype.capacity) > ChunkBytes)
+        --archetype.capacity;
+    archetype.chunkBytes = layout(archetype.capacity);
+
+    m_archetypes.push_back(std::move(archetype));
+    return int(m_archetypes.size()) - 1;
+}
+
+EntityWorld::Entity EntityWorld::newEntity()
+{
+    ++m_count;
+    if (!m_freeEntities.empty()) {
+        const auto entity = m_freeEntities.back();
+        m_freeEntities.pop_back();
+        return entity;
+    }
+    m_locations.push_back({-1, -1, -1});
+    return Entity(m_locations.size() - 1);
+}
+
+EntityWorld::Location EntityWorld::allocate(int index, Entity entity)
+{
+    auto &archetype = m_archetypes[size_t(index)];
+    if (archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity) {
+        const auto words = size_t(alignUp(archetype.chunkBytes, arrayAlignment) / arrayAlignment);
+        Chunk chunk;
+        chunk.data.reset(new std::max_align_t[words]);
+        archetype.chunks.push_back(std::move(chunk));
+    }
+
+    auto &chunk = archetype.chunks.back();
+    const Location location {index, int(archetype.chunks.size()) - 1, chunk.count++};
+    chunk.entities()[location.row] = entity;
+    m_locations[size_t(entity)] = location;
+    return location;
+}
+
+void EntityWorld::release(Location location)
+{
+    auto &archetype = m_archetypes[size_t(location.archetype)];
+    auto &last = archetype.chunks.back();
+    const Location lastLocation {location.archetype, int(archetype.chunks.size()) - 1, last.count - 1};
+
+    // keep the rows dense, the last one fills the hole
+    if (lastLocation.chunk != location.chunk || lastLocation.row != location.row) {
+        for (int type = 0; type < MaxComponentTypes; ++type) {
+            if (archetype.sizes[type] > 0) {
+                std::memcpy(component(location, type), component(lastLocation, type),
+                            size_t(archetype.sizes[type]));
+            }
+        }
+        const auto moved = last.entities()[lastLocation.row];
+        archetype.chunks[size_t(location.chunk)].entities()[location.row] = moved;
+        m_locations[size_t(moved)] = location;
+    }
+
+    if (--last.count == 0)
+        archetype.chunks.pop_back();
+}
+
+void EntityWorld::move(Entity entity, Mask mask)
+{
+    const auto from = m_locations[size_t(entity)];
+    const auto to = allocate(archetype(mask), entity);
+
+    const auto shared = m_archetypes[size_t(from.archetype)].mask & mask;
+    for (int type = 0; type < MaxComponentTypes; ++type) {
+        if (shared & (Mask(1) << type))
+            std::memcpy(component(to, type), component(from, type), size_t(componentSizes[size_t(type)]));
+    }
+
+    release(from);
+}
+
+void *EntityWorld::component(const Location &location, int type) const
+{
+    const auto &archetype = m_archetypes[size_t(location.archetype)];
+    const auto offset = archetype.offsets[type];
+    if (offset < 0)
+        return nullptr;
+    const auto &chunk = archetype.chunks[size_t(location.chunk)];
+    return chunk.bytes() + offset + location.row * archetype.sizes[type];
+}
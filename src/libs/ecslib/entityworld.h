@@ -0,0 +1,182 @@
+#ifndef ENTITYWORLD_H
+#define ENTITYWORLD_H
+
+#include <QtCore/QtGlobal>
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Entity-component storage grouped by archetype: entities with the same set of components share
+// an archetype and are stored in its fixed-size chunks. Inside a chunk every component has its own
+// tightly packed array, so a system reads only the arrays of the components it asks for.
+// The rows of an archetype stay dense, destroy() moves the archetype's last row into the hole.
+// Components are copied with memcpy and must be trivially copyable; entity ids are reused after
+// destroy(). Don't create, destroy, add or remove components while iterating.
+class EntityWorld
+{
+public:
+    using Entity = int;
+    using Mask = quint32;
+
+    static constexpr int ChunkBytes = 16 * 1024;
+    static constexpr int MaxComponentTypes = 32;
+
+    EntityWorld() = default;
+    EntityWorld(const EntityWorld &) = delete;
+    EntityWorld &operator=(const EntityWorld &) = delete;
+    ~EntityWorld();
+
+    template<typename... Components>
+    Entity create(const Components &... components);
+    void destroy(Entity entity);
+    bool isAlive(Entity entity) const noexcept;
+
+    int count() const noexcept { return m_count; }
+    int archetypeCount() const noexcept { return int(m_archetypes.size()); }
+    int chunkCount() const noexcept;
+
+    // nullptr when the entity has no such component
+    template<typename Component>
+    Component *get(Entity entity);
+    template<typename Component>
+    bool has(Entity entity) const { return mask(entity) & mask<Component>(); }
+    // Both move the entity to another archetype, add() overwrites an existing component
+    template<typename Component>
+    void add(Entity entity, const Component &component);
+    template<typename Component>
+    void remove(Entity entity);
+
+    // Calls function(count, const Entity *, Components *...) for every non-empty chunk
+    // that holds all of the Components
+    template<typename... Components, typename Function>
+    void forEachChunk(Function function);
+    // Calls function(Components &...) for every entity that holds all of the Components
+    template<typename... Components, typename Function>
+    void forEach(Function function);
+
+    template<typename Component>
+    static int componentType();
+    template<typename... Components>
+    static Mask mask();
+    Mask mask(Entity entity) const;
+
+private:
+    struct Chunk
+    {
+        char *bytes() const noexcept { return reinterpret_cast<char *>(data.get()); }
+        Entity *entities() const noexcept { return reinterpret_cast<Entity *>(bytes()); }
+
+        std::unique_ptr<std::max_align_t[]> data;
+        int count {0};
+    };
+
+    struct Archetype
+    {
+        Mask mask {0};
+        int capacity {0};
+        int chunkBytes {0};
+        int offsets[MaxComponentTypes]; // -1 for the missing components, entities are at 0
+        int sizes[MaxComponentTypes];
+        std::vector<Chunk> chunks;
+    };
+
+    struct Location
+    {
+        int archetype;
+        int chunk;
+        int row;
+    };
+
+    static int registerComponent(int size);
+    int archetype(Mask mask);
+    Entity newEntity();
+    Location allocate(int archetype, Entity entity);
+    void release(Location location);
+    void move(Entity entity, Mask mask);
+    void *component(const Location &location, int type) const;
+
+private:
+    std::vector<Archetype> m_archetypes;
+    std::vector<Location> m_locations;
+    std::vector<Entity> m_freeEntities;
+    int m_count {0};
+};
+
+template<typename Component>
+int EntityWorld::componentType()
+{
+    static_assert(std::is_trivially_copyable<Component>::value, "Components are copied with memcpy");
+    static_assert(alignof(Component) <= alignof(std::max_align_t), "Chunks are max_align_t aligned");
+    static const int type = registerComponent(int(sizeof(Component)));
+    return type;
+}
+
+template<typename... Components>
+EntityWorld::Mask EntityWorld::mask()
+{
+    Mask result = 0;
+    using Expand = int[];
+    (void)Expand {0, (result |= Mask(1) << componentType<Components>(), 0)...};
+    return result;
+}
+
+template<typename... Components>
+EntityWorld::Entity EntityWorld::create(const Components &... components)
+{
+    const auto entity = newEntity();
+    const auto location = allocate(archetype(mask<Components...>()), entity);
+    using Expand = int[];
+    (void)Expand {0, (std::memcpy(component(location, componentType<Components>()),
+                                  &components, sizeof(Components)), 0)...};
+    return entity;
+}
+
+template<typename Component>
+Component *EntityWorld::get(Entity entity)
+{
+    Q_ASSERT(isAlive(entity));
+    return static_cast<Component *>(component(m_locations[size_t(entity)], componentType<Component>()));
+}
+
+template<typename Component>
+void EntityWorld::add(Entity entity, const Component &component)
+{
+    if (!has<Component>(entity))
+        move(entity, mask(entity) | mask<Component>());
+    *get<Component>(entity) = component;
+}
+
+template<typename Component>
+void EntityWorld::remove(Entity entity)
+{
+    if (has<Component>(entity))
+        move(entity, mask(entity) & ~mask<Component>());
+}
+
+template<typename... Components, typename Function>
+void EntityWorld::forEachChunk(Function function)
+{
+    const auto required = mask<Components...>();
+    for (const auto &archetype: m_archetypes) {
+        if ((archetype.mask & required) != required)
+            continue;
+        for (const auto &chunk: archetype.chunks) {
+            function(chunk.count, static_cast<const Entity *>(chunk.entities()),
+                     reinterpret_cast<Components *>(chunk.bytes() + archetype.offsets[componentType<Components>()])...);
+        }
+    }
+}
+
+template<typename... Components, typename Function>
+void EntityWorld::forEach(Function function)
+{
+    forEachChunk<Components...>([&function](int count, const Entity *, Components *... components) {
+        for (int i = 0; i < count; ++i)
+            function(components[i]...);
+    });
+}
+
+#endif // ENTITYWORLD_H
@@ -0,0 +1,17 @@
+#include "systems.h"
+#include "components.h"
+
+void updateModelMatrices(EntityWorld &world)
+{
+    world.forEachChunk<Transform, ModelMatrix>([](int count, const EntityWorld::Entity *,
+                                                  const Transform *transforms, ModelMatrix *models) {
+        for (int i = 0; i < count; ++i) {
+            const auto &transform = transforms[i];
+            auto &model = models[i].matrix;
+            model.setToIdentity();
+            model.translate(transform.position);
+            model.rotate(transform.rotation);
+            model.scale(transform.scale);
+        }
+    });
+}
@@ -0,0 +1,9 @@
+#ifndef SYSTEMS_H
+#define SYSTEMS_H
+
+#include "entityworld.h"
+
+// Recomputes ModelMatrix from Transform for every entity that has both
+void updateModelMatrices(EntityWorld &world);
+
+#endif // SYSTEMS_H
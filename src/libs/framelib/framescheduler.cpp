@@ -0,0 +1,84 @@
+#include "framescheduler.h"
+
+#include <QOpenGLWindow>
+
+#include <algorithm>
+
+namespace {
+
+// longer frames (window dragging, breakpoints) would otherwise make the camera jump
+constexpr float maxFrameSeconds = 0.25f;
+
+} // namespace
+
+FrameScheduler::FrameScheduler(QOpenGLWindow *window, const QStringList &arguments) :
+    m_window(window)
+{
+    for (int i = 1; i < arguments.size(); ++i) {
+        if (arguments.at(i) == QLatin1String("--uncapped")) {
+            m_mode = Mode::Uncapped;
+        } else if (arguments.at(i) == QLatin1String("--fixed-step") && i + 1 < arguments.size()) {
+            m_mode = Mode::FixedStep;
+            m_stepSeconds = 1.0f / std::max(1, arguments.at(++i).toInt());
+        }
+    }
+
+    if (m_mode == Mode::Uncapped) {
+        auto format = m_window->format();
+        format.setSwapInterval(0);
+        m_window->setFormat(format);
+    }
+
+    connect(m_window, &QOpenGLWindow::frameSwapped, this, &FrameScheduler::onFrameSwapped);
+}
+
+void FrameScheduler::start()
+{
+    if (m_active)
+        return;
+
+    m_active = true;
+    m_frameCount = 0;
+    m_accumulator = 0.0f;
+    m_window->requestUpdate();
+}
+
+void FrameScheduler::stop()
+{
+    m_active = false;
+}
+
+void FrameScheduler::onFrameSwapped()
+{
+    if (!m_active)
+        return;
+
+    // the first frame only starts the clock
+    float seconds = 0.0f;
+    if (m_frameCount++ == 0) {
+        m_timer.start();
+        m_lastNsecs = 0;
+    } else {
+        const auto nsecs = m_timer.nsecsElapsed();
+        seconds = std::min((nsecs - m_lastNsecs) / 1e9f, maxFrameSeconds);
+        m_lastNsecs = nsecs;
+    }
+
+    if (m_mode == Mode::FixedStep) {
+        m_accumulator += seconds;
+        while (m_accumulator >= m_stepSeconds) {
+            emit step(m_stepSeconds);
+            m_time += m_stepSeconds;
+            m_accumulator -= m_stepSeconds;
+        }
+        emit frame(m_accumulator / m_stepSeconds);
+    } else {
+        emit step(seconds);
+        m_time += seconds;
+        emit frame(1.0f);
+    }
+
+    // requestUpdate() is throttled to the display refresh by the platform where possible,
+    // in Uncapped mode the swap interval of 0 keeps swapBuffers() from blocking
+    m_window->requestUpdate();
+}
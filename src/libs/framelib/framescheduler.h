@@ -0,0 +1,67 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+
+class QOpenGLWindow;
+
+// Drives the window's frames: every frameSwapped() advances the simulation by the elapsed time
+// and requests the next frame.
+// Modes:
+//  - VSync (default): one frame per display refresh, step() gets the measured frame time;
+//  - Uncapped ("--uncapped"): same, but with swap interval 0, for benchmarking;
+//  - FixedStep ("--fixed-step <hz>"): step() is emitted with a constant time step as many times
+//    as needed to catch up, frame() gets the interpolation factor between the last two steps.
+// Must be constructed before the window is shown, Uncapped changes the window's format.
+class FrameScheduler : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(FrameScheduler)
+public:
+    enum class Mode {
+        VSync,
+        Uncapped,
+        FixedStep
+    };
+    Q_ENUM(Mode)
+
+    explicit FrameScheduler(QOpenGLWindow *window, const QStringList &arguments = {});
+    FrameScheduler(FrameScheduler &&) = delete;
+    ~FrameScheduler() override = default;
+
+    FrameScheduler &operator=(FrameScheduler &&) = delete;
+
+    Mode mode() const noexcept { return m_mode; }
+    float stepSeconds() const noexcept { return m_stepSeconds; }
+
+    // simulated time in seconds
+    double time() const noexcept { return m_time; }
+    qint64 frameCount() const noexcept { return m_frameCount; }
+
+    bool isActive() const noexcept { return m_active; }
+    void start();
+    void stop();
+
+signals:
+    void step(float seconds);
+    void frame(float alpha);
+
+private:
+    void onFrameSwapped();
+
+private:
+    QOpenGLWindow *m_window {nullptr};
+    Mode m_mode {Mode::VSync};
+    float m_stepSeconds {1.0f / 60.0f};
+
+    bool m_active {false};
+    QElapsedTimer m_timer;
+    qint64 m_lastNsecs {0};
+    float m_accumulator {0.0f};
+    double m_time {0.0};
+    qint64 m_frameCount {0};
+};
+
+#endif // FRAMESCHEDULER_H
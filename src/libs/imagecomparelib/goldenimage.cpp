@@ -0,0 +1,54 @@
+#include "goldenimage.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QFileInfo>
+
+GoldenImage::GoldenImage(const QStringList &arguments)
+{
+    for (int i = 1; i < arguments.size(); ++i) {
+        if (arguments.at(i) == QLatin1String("--golden-update"))
+            m_update = true;
+        else if (i + 1 == arguments.size())
+            break;
+        else if (arguments.at(i) == QLatin1String("--golden"))
+            m_referenceFile = arguments.at(++i);
+        else if (arguments.at(i) == QLatin1String("--golden-threshold"))
+            m_options.channelThreshold = arguments.at(++i).toInt();
+        else if (arguments.at(i) == QLatin1String("--golden-ssim"))
+            m_options.minSsim = arguments.at(++i).toDouble();
+    }
+}
+
+bool GoldenImage::check(const QImage &image) const
+{
+    if (m_update) {
+        if (!image.save(m_referenceFile)) {
+            qCritical() << "Can't write" << m_referenceFile;
+            return false;
+        }
+        qDebug() << "Updated" << m_referenceFile;
+        return true;
+    }
+
+    const QImage reference(m_referenceFile);
+    if (reference.isNull()) {
+        qCritical() << "Can't load reference image" << m_referenceFile;
+        return false;
+    }
+
+    const ImageComparison comparison(image, reference, m_options);
+    if (comparison.matches()) {
+        qDebug().noquote() << QStringLiteral("Matches %1: %2").arg(m_referenceFile, comparison.summary());
+        return true;
+    }
+
+    qCritical().noquote() << QStringLiteral("Doesn't match %1: %2").arg(m_referenceFile, comparison.summary());
+    const auto baseName = QFileInfo(m_referenceFile).completeBaseName();
+    const auto actualFile = baseName + QStringLiteral("-actual.png");
+    const auto diffFile = baseName + QStringLiteral("-diff.png");
+    if (!image.save(actualFile))
+        qCritical() << "Can't write" << actualFile;
+    if (!comparison.diffImage().isNull() && !comparison.diffImage().save(diffFile))
+        qCritical() << "Can't write" << diffFile;
+    return false;
+}
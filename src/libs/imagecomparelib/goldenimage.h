@@ -0,0 +1,30 @@
+#ifndef GOLDENIMAGE_H
+#define GOLDENIMAGE_H
+
+#include "imagecomparison.h"
+
+#include <QtCore/QStringList>
+
+// Checks a rendered frame against the reference image given with "--golden <file>", with
+// "--golden-update" the frame is written as the new reference instead. The tolerance of
+// ImageComparison is set with "--golden-threshold <channel difference>" and
+// "--golden-ssim <min SSIM>". On a mismatch the frame and the diff image are written to the
+// current directory as <reference name>-actual.png and <reference name>-diff.png.
+class GoldenImage
+{
+public:
+    explicit GoldenImage(const QStringList &arguments);
+
+    bool isEnabled() const noexcept { return !m_referenceFile.isEmpty(); }
+    QString referenceFile() const { return m_referenceFile; }
+
+    // Returns false on a mismatch or an I/O error, the result is printed
+    bool check(const QImage &image) const;
+
+private:
+    QString m_referenceFile;
+    bool m_update {false};
+    ImageComparison::Options m_options;
+};
+
+#endif // GOLDENIMAGE_H
@@ -0,0 +1,116 @@
+#include "imagecomparison.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+constexpr int ssimWindow = 8;
+constexpr int ssimStride = 4;
+// (0.01 * 255)^2 and (0.03 * 255)^2 from the SSIM paper
+constexpr double c1 = 6.5025;
+constexpr double c2 = 58.5225;
+
+std::vector<double> luma(const QImage &image)
+{
+    std::vector<double> result(size_t(image.width()) * size_t(image.height()));
+    auto out = result.begin();
+    for (int y = 0; y < image.height(); ++y) {
+        const auto line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+        for (int x = 0; x < image.width(); ++x)
+            *out++ = 0.299 * qRed(line[x]) + 0.587 * qGreen(line[x]) + 0.114 * qBlue(line[x]);
+    }
+    return result;
+}
+
+double ssim(const QImage &actual, const QImage &reference)
+{
+    const auto width = actual.width();
+    const auto height = actual.height();
+    const auto lhs = luma(actual);
+    const auto rhs = luma(reference);
+    const auto window = std::min({ssimWindow, width, height});
+    const auto samples = double(window * window);
+
+    double sum = 0.0;
+    int windows = 0;
+    for (int top = 0; top + window <= height; top += ssimStride) {
+        for (int left = 0; left + window <= width; left += ssimStride) {
+            double meanX = 0.0, meanY = 0.0;
+            for (int y = top; y < top + window; ++y) {
+                for (int x = left; x < left + window; ++x) {
+                    meanX += lhs[size_t(y * width + x)];
+                    meanY += rhs[size_t(y * width + x)];
+                }
+            }
+            meanX /= samples;
+            meanY /= samples;
+
+            double varianceX = 0.0, varianceY = 0.0, covariance = 0.0;
+            for (int y = top; y < top + window; ++y) {
+                for (int x = left; x < left + window; ++x) {
+                    const auto dx = lhs[size_t(y * width + x)] - meanX;
+                    const auto dy = rhs[size_t(y * width + x)] - meanY;
+                    varianceX += dx * dx;
+                    varianceY += dy * dy;
+                    covariance += dx * dy;
+                }
+            }
+            varianceX /= samples;
+            varianceY /= samples;
+            covariance /= samples;
+
+            sum += (2 * meanX * meanY + c1) * (2 * covariance + c2)
+                    / ((meanX * meanX + meanY * meanY + c1) * (varianceX + varianceY + c2));
+            ++windows;
+        }
+    }
+    return windows ? sum / windows : 1.0;
+}
+
+} // namespace
+
+ImageComparison::ImageComparison(const QImage &actual, const QImage &reference, const Options &options)
+{
+    m_sizesMatch = !actual.isNull() && actual.size() == reference.size();
+    if (!m_sizesMatch)
+        return;
+
+    const auto lhs = actual.convertToFormat(QImage::Format_RGB32);
+    const auto rhs = reference.convertToFormat(QImage::Format_RGB32);
+    m_diffImage = QImage(rhs.size(), QImage::Format_RGB32);
+    for (int y = 0; y < rhs.height(); ++y) {
+        const auto actualLine = reinterpret_cast<const QRgb *>(lhs.constScanLine(y));
+        const auto referenceLine = reinterpret_cast<const QRgb *>(rhs.constScanLine(y));
+        const auto diffLine = reinterpret_cast<QRgb *>(m_diffImage.scanLine(y));
+        for (int x = 0; x < rhs.width(); ++x) {
+            const auto difference = std::max({std::abs(qRed(actualLine[x]) - qRed(referenceLine[x])),
+                                              std::abs(qGreen(actualLine[x]) - qGreen(referenceLine[x])),
+                                              std::abs(qBlue(actualLine[x]) - qBlue(referenceLine[x]))});
+            m_maxDifference = std::max(m_maxDifference, difference);
+            if (difference > options.channelThreshold) {
+                ++m_differentPixels;
+                diffLine[x] = qRgb(std::min(128 + difference, 255), 0, 0);
+            } else {
+                const auto gray = qGray(referenceLine[x]) / 3;
+                diffLine[x] = qRgb(gray, gray, gray);
+            }
+        }
+    }
+
+    m_ssim = ::ssim(lhs, rhs);
+    const auto pixels = double(rhs.width()) * rhs.height();
+    m_matches = m_differentPixels <= options.maxDifferentPixels * pixels && m_ssim >= options.minSsim;
+}
+
+QString ImageComparison::summary() const
+{
+    if (!m_sizesMatch)
+        return QStringLiteral("image sizes differ");
+
+    return QStringLiteral("%1 pixels differ (max %2), SSIM %3")
+            .arg(m_differentPixels)
+            .arg(m_maxDifference)
+            .arg(m_ssim, 0, 'f', 4);
+}
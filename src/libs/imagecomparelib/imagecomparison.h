@@ -0,0 +1,46 @@
+#ifndef IMAGECOMPARISON_H
+#define IMAGECOMPARISON_H
+
+#include <QtGui/QImage>
+
+#include <QtCore/QString>
+
+// Compares a rendered frame with a reference image, tolerant to the small differences between
+// GL drivers: a pixel differs when one of its channels is off by more than channelThreshold,
+// the images match when at most maxDifferentPixels of the pixels differ and the structural
+// similarity (SSIM of the luma in 8x8 windows) is at least minSsim. Alpha is ignored.
+class ImageComparison
+{
+public:
+    struct Options
+    {
+        int channelThreshold {8};
+        double maxDifferentPixels {0.001};
+        double minSsim {0.98};
+    };
+
+    ImageComparison() = default;
+    ImageComparison(const QImage &actual, const QImage &reference, const Options &options);
+
+    bool matches() const noexcept { return m_matches; }
+    int differentPixels() const noexcept { return m_differentPixels; }
+    int maxDifference() const noexcept { return m_maxDifference; }
+    double ssim() const noexcept { return m_ssim; }
+
+    // The reference dimmed to gray with the differing pixels in red, brighter for larger
+    // differences; null if the sizes don't match
+    const QImage &diffImage() const noexcept { return m_diffImage; }
+
+    // e.g. "12 pixels differ (max 31), SSIM 0.9973"
+    QString summary() const;
+
+private:
+    bool m_matches {false};
+    bool m_sizesMatch {false};
+    int m_differentPixels {0};
+    int m_maxDifference {0};
+    double m_ssim {0.0};
+    QImage m_diffImage;
+};
+
+#endif // IMAGECOMPARISON_H
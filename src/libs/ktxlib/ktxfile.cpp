@@ -0,0 +1,318 @@
+#include "ktxfile.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uchar identifier[12] = {0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a, '\n'};
+
+constexpr int headerSize = 80;
+constexpr int levelIndexEntrySize = 24;
+
+// VkFormat values
+constexpr quint32 vkFormatRGBA8 = 37;  // VK_FORMAT_R8G8B8A8_UNORM
+constexpr quint32 vkFormatBC1 = 131;   // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+
+constexpr char orientationKey[] = "KTXorientation";
+constexpr int orientationKeySize = sizeof(orientationKey); // with the terminating zero
+
+quint32 read32(const uchar *data)
+{
+    return qFromLittleEndian<quint32>(data);
+}
+
+quint64 read64(const uchar *data)
+{
+    return qFromLittleEndian<quint64>(data);
+}
+
+void append32(QByteArray &data, quint32 value)
+{
+    uchar bytes[4];
+    qToLittleEndian(value, bytes);
+    data.append(reinterpret_cast<const char *>(bytes), 4);
+}
+
+void append64(QByteArray &data, quint64 value)
+{
+    uchar bytes[8];
+    qToLittleEndian(value, bytes);
+    data.append(reinterpret_cast<const char *>(bytes), 8);
+}
+
+void pad(QByteArray &data, int alignment)
+{
+    while (data.size() % alignment != 0)
+        data.append('\0');
+}
+
+qint64 levelSize(KtxFile::Format format, int width, int height)
+{
+    if (format == KtxFile::Format::BC1)
+        return qint64((width + 3) / 4) * ((height + 3) / 4) * 8;
+    return qint64(width) * height * 4;
+}
+
+// A Khronos basic data format descriptor, the part of the file that tells other tools
+// how to interpret the texels.
+QByteArray dataFormatDescriptor(KtxFile::Format format)
+{
+    struct Sample
+    {
+        quint32 bitOffset;
+        quint32 bitLength;
+        quint32 channel;
+        quint32 upper;
+    };
+
+    std::vector<Sample> samples;
+    quint32 colorModel = 0;
+    quint32 blockDimensions = 0;
+    quint32 bytesPlane0 = 0;
+    if (format == KtxFile::Format::BC1) {
+        colorModel = 128; // KHR_DF_MODEL_BC1A
+        blockDimensions = 3 | 3 << 8; // 4x4, stored as size - 1
+        bytesPlane0 = 8;
+        samples.push_back({0, 64, 0, 0xffffffffu});
+    } else {
+        colorModel = 1; // KHR_DF_MODEL_RGBSDA
+        bytesPlane0 = 4;
+        samples.push_back({0, 8, 0, 255});   // R
+        samples.push_back({8, 8, 1, 255});   // G
+        samples.push_back({16, 8, 2, 255});  // B
+        samples.push_back({24, 8, 15, 255}); // A
+    }
+
+    const auto blockSize = quint32(24 + 16 * samples.size());
+    QByteArray result;
+    append32(result, 4 + blockSize);
+    append32(result, 0); // Khronos vendor, basic descriptor type
+    append32(result, 2 | blockSize << 16); // version 1.3
+    // BT.709 primaries, linear transfer function, straight alpha
+    append32(result, colorModel | 1 << 8 | 1 << 16);
+    append32(result, blockDimensions);
+    append32(result, bytesPlane0);
+    append32(result, 0);
+    for (const auto &sample: samples) {
+        append32(result, sample.bitOffset | (sample.bitLength - 1) << 16 | sample.channel << 24);
+        append32(result, 0);
+        append32(result, 0);
+        append32(result, sample.upper);
+    }
+    return result;
+}
+
+QByteArray keyValueData(KtxFile::Orientation orientation)
+{
+    QByteArray keyAndValue(orientationKey, orientationKeySize);
+    keyAndValue.append(orientation == KtxFile::Orientation::Up ? "ru" : "rd");
+    keyAndValue.append('\0');
+    QByteArray result;
+    append32(result, quint32(keyAndValue.size()));
+    result.append(keyAndValue);
+    pad(result, 4);
+    return result;
+}
+
+} // namespace
+
+KtxFile::~KtxFile()
+{
+    close();
+}
+
+bool KtxFile::open(const QString &fileName)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return fail(m_file.errorString());
+
+    const auto fileSize = m_file.size();
+    if (fileSize < headerSize)
+        return fail(QStringLiteral("File is too small"));
+
+    m_data = m_file.map(0, fileSize);
+    if (!m_data)
+        return fail(QStringLiteral("Can't map file: %1").arg(m_file.errorString()));
+
+    if (std::memcmp(m_data, identifier, sizeof(identifier)) != 0)
+        return fail(QStringLiteral("Not a KTX2 file"));
+
+    const auto vkFormat = read32(m_data + 12);
+    const auto width = read32(m_data + 20);
+    const auto height = read32(m_data + 24);
+    const auto depth = read32(m_data + 28);
+    const auto layerCount = read32(m_data + 32);
+    const auto faceCount = read32(m_data + 36);
+    const auto levelCount = read32(m_data + 40);
+    const auto supercompression = read32(m_data + 44);
+    const auto kvdOffset = read32(m_data + 56);
+    const auto kvdLength = read32(m_data + 60);
+
+    Format format = Format::Invalid;
+    if (vkFormat == vkFormatRGBA8)
+        format = Format::RGBA8;
+    else if (vkFormat == vkFormatBC1)
+        format = Format::BC1;
+    else
+        return fail(QStringLiteral("Unsupported format %1").arg(vkFormat));
+
+    if (width == 0 || height == 0 || depth != 0 || layerCount > 1 || faceCount != 1)
+        return fail(QStringLiteral("Only 2D textures are supported"));
+    if (supercompression != 0)
+        return fail(QStringLiteral("Supercompression is not supported"));
+    if (levelCount == 0 || levelCount > 32)
+        return fail(QStringLiteral("Unexpected number of levels %1").arg(levelCount));
+    if (headerSize + qint64(levelCount) * levelIndexEntrySize > fileSize
+            || qint64(kvdOffset) + kvdLength > fileSize) {
+        return fail(QStringLiteral("File is truncated"));
+    }
+
+    m_levels.reserve(levelCount);
+    for (quint32 i = 0; i < levelCount; ++i) {
+        const auto entry = m_data + headerSize + i * levelIndexEntrySize;
+        const auto offset = read64(entry);
+        const auto length = read64(entry + 8);
+
+        Level level;
+        level.width = int(std::max(width >> i, 1u));
+        level.height = int(std::max(height >> i, 1u));
+        level.data = m_data + offset;
+        level.size = qint64(length);
+        if (offset + length > quint64(fileSize) || level.size != levelSize(format, level.width, level.height))
+            return fail(QStringLiteral("Invalid level %1").arg(i));
+        m_levels.push_back(level);
+    }
+
+    for (quint32 offset = kvdOffset; offset + 4 <= kvdOffset + kvdLength;) {
+        const auto length = read32(m_data + offset);
+        const auto keyAndValue = QByteArray::fromRawData(reinterpret_cast<const char *>(m_data + offset + 4),
+                                                         int(std::min(length, kvdOffset + kvdLength - offset - 4)));
+        if (keyAndValue.size() > orientationKeySize + 1
+                && std::memcmp(keyAndValue.constData(), orientationKey, orientationKeySize) == 0) {
+            const auto rows = keyAndValue.at(orientationKeySize + 1);
+            m_orientation = rows == 'u' ? Orientation::Up : Orientation::Down;
+        }
+        offset += 4 + ((length + 3) & ~3u);
+    }
+
+    m_format = format;
+    m_width = int(width);
+    m_height = int(height);
+    return true;
+}
+
+void KtxFile::close()
+{
+    if (m_data)
+        m_file.unmap(m_data);
+    m_data = nullptr;
+    m_file.close();
+    m_format = Format::Invalid;
+    m_orientation = Orientation::Down;
+    m_width = 0;
+    m_height = 0;
+    m_levels.clear();
+}
+
+bool KtxFile::write(const QString &fileName, Format format, Orientation orientation,
+                    int width, int height, const std::vector<QByteArray> &levels,
+                    QString *errorString)
+{
+    const auto setError = [errorString](const QString &error) {
+        if (errorString)
+            *errorString = error;
+        return false;
+    };
+
+    if (format == Format::Invalid || width <= 0 || height <= 0 || levels.empty())
+        return setError(QStringLiteral("Nothing to write"));
+
+    for (size_t i = 0; i < levels.size(); ++i) {
+        const auto levelWidth = std::max(width >> i, 1);
+        const auto levelHeight = std::max(height >> i, 1);
+        if (levels[i].size() != levelSize(format, levelWidth, levelHeight))
+            return setError(QStringLiteral("Level %1 has unexpected size %2").arg(i).arg(levels[i].size()));
+    }
+
+    const auto dfd = dataFormatDescriptor(format);
+    const auto kvd = keyValueData(orientation);
+    const auto levelCount = quint32(levels.size());
+    const auto dfdOffset = quint32(headerSize) + levelCount * levelIndexEntrySize;
+    const auto kvdOffset = dfdOffset + quint32(dfd.size());
+
+    // the level data follows the metadata, the smallest level first,
+    // each level is aligned to lcm(texel block size, 4)
+    const int alignment = format == Format::BC1 ? 8 : 4;
+    QByteArray data;
+    data.reserve(int(kvdOffset) + kvd.size());
+    data.append(reinterpret_cast<const char *>(identifier), sizeof(identifier));
+    append32(data, format == Format::BC1 ? vkFormatBC1 : vkFormatRGBA8);
+    append32(data, 1); // typeSize
+    append32(data, quint32(width));
+    append32(data, quint32(height));
+    append32(data, 0); // depth
+    append32(data, 0); // layers
+    append32(data, 1); // faces
+    append32(data, levelCount);
+    append32(data, 0); // supercompression
+    append32(data, dfdOffset);
+    append32(data, quint32(dfd.size()));
+    append32(data, kvdOffset);
+    append32(data, quint32(kvd.size()));
+    append64(data, 0); // supercompression global data
+    append64(data, 0);
+
+    std::vector<quint64> offsets(levels.size());
+    quint64 offset = kvdOffset + quint32(kvd.size());
+    for (size_t i = levels.size(); i-- > 0;) {
+        offset = (offset + alignment - 1) / alignment * alignment;
+        offsets[i] = offset;
+        offset += quint64(levels[i].size());
+    }
+    for (size_t i = 0; i < levels.size(); ++i) {
+        append64(data, offsets[i]);
+        append64(data, quint64(levels[i].size()));
+        append64(data, quint64(levels[i].size()));
+    }
+    data.append(dfd);
+    data.append(kvd);
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return setError(file.errorString());
+    file.write(data);
+    auto position = quint64(data.size());
+    for (size_t i = levels.size(); i-- > 0;) {
+        file.write(QByteArray(int(offsets[i] - position), '\0'));
+        file.write(levels[i]);
+        position = offsets[i] + quint64(levels[i].size());
+    }
+    if (!file.commit())
+        return setError(file.errorString());
+    return true;
+}
+
+QString KtxFile::bakedFileName(const QString &fileName)
+{
+    const auto directory = QDir(QCoreApplication::applicationDirPath())
+            .filePath(QStringLiteral("../share/learnopengl-qt/textures"));
+    return QDir::cleanPath(directory + QLatin1Char('/') + QFileInfo(fileName).completeBaseName()
+                           + QStringLiteral(".ktx2"));
+}
+
+bool KtxFile::fail(const QString &errorString)
+{
+    close();
+    m_errorString = errorString;
+    return false;
+}
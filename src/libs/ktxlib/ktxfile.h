@@ -0,0 +1,80 @@
+#ifndef KTXFILE_H
+#define KTXFILE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QString>
+
+#include <vector>
+
+// A KTX2 file with a single 2D image and its mip chain, as written by the texturebaker tool.
+// open() maps the file into memory, level() points straight into the mapping, so the levels
+// can be passed to glTexImage2D/glCompressedTexImage2D without reading or copying the file.
+// Only uncompressed RGBA8 and BC1 (DXT1) data without supercompression is supported.
+class KtxFile
+{
+public:
+    enum class Format {
+        Invalid,
+        RGBA8,
+        BC1
+    };
+
+    struct Level
+    {
+        int width {0};
+        int height {0};
+        const uchar *data {nullptr};
+        qint64 size {0};
+    };
+
+    // Rows of the baked level data: Down is the image's top row first (the file's natural
+    // orientation), Up is bottom row first, i.e. flipped for GL's texture coordinates.
+    enum class Orientation {
+        Down,
+        Up
+    };
+
+    KtxFile() = default;
+    KtxFile(const KtxFile &) = delete;
+    ~KtxFile();
+
+    KtxFile &operator=(const KtxFile &) = delete;
+
+    bool open(const QString &fileName);
+    void close();
+
+    bool isOpen() const noexcept { return m_format != Format::Invalid; }
+    QString errorString() const { return m_errorString; }
+
+    Format format() const noexcept { return m_format; }
+    Orientation orientation() const noexcept { return m_orientation; }
+    int width() const noexcept { return m_width; }
+    int height() const noexcept { return m_height; }
+    int levelCount() const noexcept { return int(m_levels.size()); }
+    Level level(int level) const { return m_levels.at(size_t(level)); }
+
+    // levels[0] is the base level, each next one is half the size of the previous one
+    static bool write(const QString &fileName, Format format, Orientation orientation,
+                      int width, int height, const std::vector<QByteArray> &levels,
+                      QString *errorString = nullptr);
+
+    // Baked copy of a source image, e.g. ":/container2.png" ->
+    // "<application dir>/../share/learnopengl-qt/textures/container2.ktx2"
+    static QString bakedFileName(const QString &fileName);
+
+private:
+    bool fail(const QString &errorString);
+
+private:
+    QFile m_file;
+    uchar *m_data {nullptr};
+    Format m_format {Format::Invalid};
+    Orientation m_orientation {Orientation::Down};
+    int m_width {0};
+    int m_height {0};
+    std::vector<Level> m_levels;
+    QString m_errorString;
+};
+
+#endif // KTXFILE_H
@@ -0,0 +1,289 @@
+#include "mesh.h"
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <QtCore/QDebug>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/qfloat16.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <numeric>
+
+Q_LOGGING_CATEGORY(lcMesh, "learnopengl.mesh", QtInfoMsg)
+
+namespace {
+
+using FloatVertex = std::array<GLfloat, Mesh::FloatsPerVertex>;
+
+struct PackedVertex
+{
+    quint16 position[4]; // half floats, the 4th one keeps the normal 4-byte aligned
+    quint32 normal;      // GL_INT_2_10_10_10_REV
+    quint16 texCoords[2];
+};
+
+static_assert(sizeof(FloatVertex) == 32, "Unexpected float vertex size");
+static_assert(sizeof(PackedVertex) == 16, "Unexpected packed vertex size");
+
+quint16 packHalf(GLfloat value)
+{
+    const qfloat16 half(value);
+    quint16 result;
+    std::memcpy(&result, &half, sizeof(result));
+    return result;
+}
+
+quint32 packSnorm10(GLfloat value)
+{
+    const auto clamped = std::min(std::max(value, -1.0f), 1.0f);
+    return quint32(qRound(clamped * 511.0f)) & 0x3ffu;
+}
+
+quint32 packNormal(GLfloat x, GLfloat y, GLfloat z)
+{
+    return packSnorm10(x) | packSnorm10(y) << 10 | packSnorm10(z) << 20;
+}
+
+quint16 packUnorm16(GLfloat value)
+{
+    const auto clamped = std::min(std::max(value, 0.0f), 1.0f);
+    return quint16(qRound(clamped * 65535.0f));
+}
+
+PackedVertex pack(const FloatVertex &vertex)
+{
+    PackedVertex result;
+    result.position[0] = packHalf(vertex[0]);
+    result.position[1] = packHalf(vertex[1]);
+    result.position[2] = packHalf(vertex[2]);
+    result.position[3] = packHalf(1.0f);
+    result.normal = packNormal(vertex[3], vertex[4], vertex[5]);
+    result.texCoords[0] = packUnorm16(vertex[6]);
+    result.texCoords[1] = packUnorm16(vertex[7]);
+    return result;
+}
+
+} // namespace
+
+Mesh::VertexFormat Mesh::vertexFormat(const QStringList &arguments)
+{
+    return arguments.contains(QStringLiteral("--packed-vertices")) ? VertexFormat::Packed : VertexFormat::Float;
+}
+
+std::vector<GLfloat> Mesh::sphereVertices(int slices, int stacks)
+{
+    const auto vertex = [slices, stacks](int stack, int slice) {
+        const auto theta = float(M_PI) * stack / stacks;
+        const auto phi = 2.0f * float(M_PI) * slice / slices;
+        const auto x = std::sin(theta) * std::cos(phi);
+        const auto y = std::cos(theta);
+        const auto z = std::sin(theta) * std::sin(phi);
+        return FloatVertex {{x, y, z, x, y, z, float(slice) / slices, 1.0f - float(stack) / stacks}};
+    };
+
+    std::vector<GLfloat> result;
+    const auto append = [&result](const FloatVertex &a, const FloatVertex &b, const FloatVertex &c) {
+        for (const auto &v: {a, b, c})
+            result.insert(result.end(), v.begin(), v.end());
+    };
+
+    for (int stack = 0; stack < stacks; ++stack) {
+        for (int slice = 0; slice < slices; ++slice) {
+            const auto a = vertex(stack, slice);
+            const auto b = vertex(stack + 1, slice);
+            const auto c = vertex(stack + 1, slice + 1);
+            const auto d = vertex(stack, slice + 1);
+            // the triangles touching the poles are degenerate
+            if (stack != stacks - 1)
+                append(a, c, b);
+            if (stack != 0)
+                append(a, d, c);
+        }
+    }
+    return result;
+}
+
+Mesh::Geometry Mesh::weld(const GLfloat *vertices, int vertexCount, VertexFormat format)
+{
+    // weld identical vertices
+    std::vector<FloatVertex> unique;
+    Geometry result;
+    std::map<FloatVertex, GLushort> lookup;
+    result.indices.reserve(size_t(vertexCount));
+    for (int i = 0; i < vertexCount; ++i) {
+        FloatVertex vertex;
+        std::copy(vertices + i * FloatsPerVertex, vertices + (i + 1) * FloatsPerVertex, vertex.begin());
+        const auto it = lookup.find(vertex);
+        if (it != lookup.end()) {
+            result.indices.push_back(it->second);
+            continue;
+        }
+        Q_ASSERT(unique.size() <= std::numeric_limits<GLushort>::max());
+        const auto index = GLushort(unique.size());
+        lookup.emplace(vertex, index);
+        unique.push_back(vertex);
+        result.indices.push_back(index);
+    }
+
+    result.vertexCount = int(unique.size());
+    result.vertexData.resize(unique.size() * size_t(vertexSize(format)));
+    if (format == VertexFormat::Packed) {
+        std::vector<PackedVertex> packed;
+        packed.reserve(unique.size());
+        std::transform(unique.begin(), unique.end(), std::back_inserter(packed), pack);
+        std::memcpy(result.vertexData.data(), packed.data(), result.vertexData.size());
+    } else {
+        std::memcpy(result.vertexData.data(), unique.data(), result.vertexData.size());
+    }
+    return result;
+}
+
+int Mesh::vertexSize(VertexFormat format) noexcept
+{
+    return format == VertexFormat::Packed ? int(sizeof(PackedVertex)) : int(sizeof(FloatVertex));
+}
+
+int Mesh::floatsPerVertex(const Layout &layout) noexcept
+{
+    return std::accumulate(layout.begin(), layout.end(), 0);
+}
+
+int Mesh::vertexSize() const noexcept
+{
+    return m_layout.empty() ? vertexSize(m_format) : floatsPerVertex(m_layout) * int(sizeof(GLfloat));
+}
+
+void Mesh::create(QOpenGLFunctions_3_3_Core *funcs, const GLfloat *vertices, int vertexCount)
+{
+    m_funcs = funcs;
+
+    const auto geometry = weld(vertices, vertexCount, m_format);
+    m_vertexCount = geometry.vertexCount;
+    m_indexCount = int(geometry.indices.size());
+
+    m_vbo.create();
+    m_vbo.bind();
+    m_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_vbo.allocate(geometry.vertexData.data(), int(geometry.vertexData.size()));
+
+    m_ibo.create();
+    m_ibo.bind();
+    m_ibo.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_ibo.allocate(geometry.indices.data(), int(geometry.indices.size() * sizeof(GLushort)));
+
+    setupAttributes();
+
+    // with the post-transform cache every unique vertex is fetched once per draw
+    const int arraysSize = vertexCount * int(sizeof(FloatVertex));
+    const int indexedSize = m_vertexCount * vertexSize() + m_indexCount * int(sizeof(GLushort));
+    qCDebug(lcMesh).noquote() << QStringLiteral("Mesh: %1 -> %2 vertices + %3 indices, %4 -> %5 bytes per draw (%6% less)")
+                                 .arg(vertexCount).arg(m_vertexCount).arg(m_indexCount)
+                                 .arg(arraysSize).arg(indexedSize)
+                                 .arg(100 - indexedSize * 100 / arraysSize);
+}
+
+void Mesh::create(QOpenGLFunctions_3_3_Core *funcs, const Layout &layout,
+                  const GLfloat *vertices, int vertexCount,
+                  const GLushort *indices, int indexCount)
+{
+    Q_ASSERT(!layout.empty());
+    m_funcs = funcs;
+    m_layout = layout;
+    m_vertexCount = vertexCount;
+    m_indexCount = indices ? indexCount : 0;
+
+    m_vbo.create();
+    m_vbo.bind();
+    m_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_vbo.allocate(vertices, vertexCount * vertexSize());
+
+    if (m_indexCount) {
+        m_ibo.create();
+        m_ibo.bind();
+        m_ibo.setUsagePattern(QOpenGLBuffer::StaticDraw);
+        m_ibo.allocate(indices, m_indexCount * int(sizeof(GLushort)));
+    }
+
+    setupAttributes();
+}
+
+void Mesh::destroy()
+{
+    m_vbo.destroy();
+    m_ibo.destroy();
+}
+
+void Mesh::setupVertexAttributes(QOpenGLFunctions_3_3_Core *funcs, VertexFormat format)
+{
+    const auto stride = vertexSize(format);
+    if (format == VertexFormat::Packed) {
+        funcs->glEnableVertexAttribArray(0);
+        funcs->glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, stride,
+                                     reinterpret_cast<GLvoid *>(offsetof(PackedVertex, position)));
+
+        funcs->glEnableVertexAttribArray(1);
+        funcs->glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride,
+                                     reinterpret_cast<GLvoid *>(offsetof(PackedVertex, normal)));
+
+        funcs->glEnableVertexAttribArray(2);
+        funcs->glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride,
+                                     reinterpret_cast<GLvoid *>(offsetof(PackedVertex, texCoords)));
+    } else {
+        funcs->glEnableVertexAttribArray(0);
+        funcs->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, nullptr);
+
+        funcs->glEnableVertexAttribArray(1);
+        funcs->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<GLvoid *>(3 * sizeof(GLfloat)));
+
+        funcs->glEnableVertexAttribArray(2);
+        funcs->glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<GLvoid *>(6 * sizeof(GLfloat)));
+    }
+}
+
+void Mesh::setupAttributes()
+{
+    m_vbo.bind();
+    if (m_indexCount)
+        m_ibo.bind();
+
+    if (m_layout.empty()) {
+        setupVertexAttributes(m_funcs, m_format);
+    } else {
+        const auto stride = vertexSize();
+        int offset = 0;
+        for (GLuint location = 0; location < GLuint(m_layout.size()); ++location) {
+            m_funcs->glEnableVertexAttribArray(location);
+            m_funcs->glVertexAttribPointer(location, m_layout[location], GL_FLOAT, GL_FALSE, stride,
+                                           reinterpret_cast<GLvoid *>(offset * sizeof(GLfloat)));
+            offset += m_layout[location];
+        }
+    }
+
+    // the index buffer binding is VAO state, so only the vertex buffer is released
+    m_vbo.release();
+}
+
+void Mesh::draw()
+{
+    if (!m_indexCount) {
+        m_funcs->glDrawArrays(GL_TRIANGLES, 0, m_vertexCount);
+        return;
+    }
+    m_funcs->glDrawElements(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_SHORT, nullptr);
+}
+
+void Mesh::drawInstanced(int instanceCount)
+{
+    if (!m_indexCount) {
+        m_funcs->glDrawArraysInstanced(GL_TRIANGLES, 0, m_vertexCount, instanceCount);
+        return;
+    }
+    m_funcs->glDrawElementsInstanced(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_SHORT, nullptr, instanceCount);
+}
@@ -0,0 +1,100 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <QOpenGLBuffer>
+
+#include <QtCore/QStringList>
+
+#include <vector>
+
+class QOpenGLFunctions_3_3_Core;
+
+// Indexed mesh built from the examples' unindexed vertex arrays of 8 floats per vertex:
+// position (location 0), normal (location 1) and texture coords (location 2).
+// Identical vertices are welded, so the classic cube becomes 24 vertices and 36 GL_UNSIGNED_SHORT
+// indices. The Packed format stores half-float positions, GL_INT_2_10_10_10_REV normals and
+// normalized unsigned short texture coords, 16 bytes per vertex instead of 32.
+// A Layout mesh keeps the vertices of the getting started examples as they are: float attributes
+// at locations 0, 1... with optional indices, drawn with glDrawArrays when there are none.
+class Mesh
+{
+public:
+    enum class VertexFormat {
+        Float,
+        Packed
+    };
+
+    static constexpr int FloatsPerVertex = 8;
+
+    // Component count of each attribute, e.g. {3, 2} for a position and texture coords
+    using Layout = std::vector<int>;
+
+    // Welded vertices in the given format and their indices
+    struct Geometry
+    {
+        std::vector<char> vertexData;
+        std::vector<GLushort> indices;
+        int vertexCount {0};
+    };
+
+    explicit Mesh(VertexFormat format = VertexFormat::Float) noexcept : m_format(format) {}
+
+    // "--packed-vertices" selects VertexFormat::Packed
+    static VertexFormat vertexFormat(const QStringList &arguments);
+
+    // Unindexed vertices of a unit UV sphere with counter-clockwise outward faces, for create()
+    static std::vector<GLfloat> sphereVertices(int slices, int stacks);
+
+    static Geometry weld(const GLfloat *vertices, int vertexCount, VertexFormat format);
+    static int vertexSize(VertexFormat format) noexcept;
+    static int floatsPerVertex(const Layout &layout) noexcept;
+    // Sets up the attributes of the currently bound VAO for the currently bound GL_ARRAY_BUFFER
+    static void setupVertexAttributes(QOpenGLFunctions_3_3_Core *funcs, VertexFormat format);
+
+    VertexFormat format() const noexcept { return m_format; }
+    int vertexCount() const noexcept { return m_vertexCount; }
+    int indexCount() const noexcept { return m_indexCount; }
+    int vertexSize() const noexcept;
+
+    // Uploads the mesh and sets up the attributes of the currently bound VAO
+    void create(QOpenGLFunctions_3_3_Core *funcs, const GLfloat *vertices, int vertexCount);
+    template<size_t N>
+    void create(QOpenGLFunctions_3_3_Core *funcs, const GLfloat (&vertices)[N])
+    {
+        static_assert(N % FloatsPerVertex == 0, "Vertices must have 8 floats each");
+        create(funcs, vertices, int(N / FloatsPerVertex));
+    }
+    // Uploads the vertices of the layout without welding them
+    void create(QOpenGLFunctions_3_3_Core *funcs, const Layout &layout,
+                const GLfloat *vertices, int vertexCount,
+                const GLushort *indices = nullptr, int indexCount = 0);
+    template<size_t N>
+    void create(QOpenGLFunctions_3_3_Core *funcs, const Layout &layout, const GLfloat (&vertices)[N])
+    {
+        create(funcs, layout, vertices, int(N) / floatsPerVertex(layout));
+    }
+    template<size_t N, size_t M>
+    void create(QOpenGLFunctions_3_3_Core *funcs, const Layout &layout,
+                const GLfloat (&vertices)[N], const GLushort (&indices)[M])
+    {
+        create(funcs, layout, vertices, int(N) / floatsPerVertex(layout), indices, int(M));
+    }
+    void destroy();
+
+    // Sets up the attributes of another VAO, e.g. the lamp's one
+    void setupAttributes();
+
+    void draw();
+    void drawInstanced(int instanceCount);
+
+private:
+    VertexFormat m_format {VertexFormat::Float};
+    Layout m_layout;
+    QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
+    QOpenGLBuffer m_vbo {QOpenGLBuffer::VertexBuffer};
+    QOpenGLBuffer m_ibo {QOpenGLBuffer::IndexBuffer};
+    int m_vertexCount {0};
+    int m_indexCount {0};
+};
+
+#endif // MESH_H
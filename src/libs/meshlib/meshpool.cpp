@@ -0,0 +1,72 @@
+#include "meshpool.h"
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <QtCore/QDebug>
+#include <QtCore/QLoggingCategory>
+
+Q_LOGGING_CATEGORY(lcMeshPool, "learnopengl.meshpool", QtInfoMsg)
+
+int MeshPool::add(const GLfloat *vertices, int vertexCount)
+{
+    const auto geometry = Mesh::weld(vertices, vertexCount, m_format);
+
+    Range range;
+    range.firstIndex = int(m_indices.size());
+    range.indexCount = int(geometry.indices.size());
+    range.baseVertex = m_vertexCount;
+    m_ranges.push_back(range);
+
+    m_vertexData.insert(m_vertexData.end(), geometry.vertexData.begin(), geometry.vertexData.end());
+    m_indices.insert(m_indices.end(), geometry.indices.begin(), geometry.indices.end());
+    m_vertexCount += geometry.vertexCount;
+    return count() - 1;
+}
+
+void MeshPool::create(QOpenGLFunctions_3_3_Core *funcs)
+{
+    m_funcs = funcs;
+
+    m_vbo.create();
+    m_vbo.bind();
+    m_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_vbo.allocate(m_vertexData.data(), int(m_vertexData.size()));
+    m_vbo.release();
+
+    m_ibo.create();
+    m_ibo.bind();
+    m_ibo.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_ibo.allocate(m_indices.data(), int(m_indices.size() * sizeof(GLushort)));
+    m_ibo.release();
+
+    qCDebug(lcMeshPool).noquote() << QStringLiteral("Mesh pool: %1 meshes, %2 vertices + %3 indices")
+                                     .arg(count()).arg(m_vertexCount).arg(int(m_indices.size()));
+
+    m_vertexData = {};
+    m_indices = {};
+}
+
+void MeshPool::destroy()
+{
+    m_vbo.destroy();
+    m_ibo.destroy();
+}
+
+void MeshPool::setupAttributes()
+{
+    m_vbo.bind();
+    m_ibo.bind();
+
+    Mesh::setupVertexAttributes(m_funcs, m_format);
+
+    // the index buffer binding is VAO state, so only the vertex buffer is released
+    m_vbo.release();
+}
+
+void MeshPool::draw(int mesh)
+{
+    const auto &range = this->range(mesh);
+    const auto indices = reinterpret_cast<GLvoid *>(size_t(range.firstIndex) * sizeof(GLushort));
+    m_funcs->glDrawElementsBaseVertex(GL_TRIANGLES, range.indexCount, GL_UNSIGNED_SHORT, indices,
+                                      range.baseVertex);
+}
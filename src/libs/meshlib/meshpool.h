@@ -0,0 +1,60 @@
+#ifndef MESHPOOL_H
+#define MESHPOOL_H
+
+#include "mesh.h"
+
+#include <QOpenGLBuffer>
+
+#include <vector>
+
+class QOpenGLFunctions_3_3_Core;
+
+// Meshes of one vertex format packed into a single vertex and a single index buffer, so draws of
+// different meshes share one VAO and can be submitted together (DrawBatch). Every mesh keeps its
+// own GL_UNSIGNED_SHORT indices, a draw adds the mesh's baseVertex.
+class MeshPool
+{
+public:
+    struct Range
+    {
+        int firstIndex {0};
+        int indexCount {0};
+        int baseVertex {0};
+    };
+
+    explicit MeshPool(Mesh::VertexFormat format = Mesh::VertexFormat::Float) noexcept : m_format(format) {}
+
+    // Adds the unindexed vertices of Mesh::create() and returns the mesh's id, call before create()
+    int add(const GLfloat *vertices, int vertexCount);
+    template<size_t N>
+    int add(const GLfloat (&vertices)[N])
+    {
+        static_assert(N % Mesh::FloatsPerVertex == 0, "Vertices must have 8 floats each");
+        return add(vertices, int(N / Mesh::FloatsPerVertex));
+    }
+
+    int count() const noexcept { return int(m_ranges.size()); }
+    const Range &range(int mesh) const { return m_ranges[size_t(mesh)]; }
+    Mesh::VertexFormat format() const noexcept { return m_format; }
+
+    // Uploads all meshes, the CPU copies are released
+    void create(QOpenGLFunctions_3_3_Core *funcs);
+    void destroy();
+
+    // Binds both buffers to the currently bound VAO and sets up the vertex attributes
+    void setupAttributes();
+    // Draws one instance of the mesh, a VAO set up by setupAttributes() must be bound
+    void draw(int mesh);
+
+private:
+    Mesh::VertexFormat m_format {Mesh::VertexFormat::Float};
+    QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
+    std::vector<Range> m_ranges;
+    std::vector<char> m_vertexData;
+    std::vector<GLushort> m_indices;
+    int m_vertexCount {0};
+    QOpenGLBuffer m_vbo {QOpenGLBuffer::VertexBuffer};
+    QOpenGLBuffer m_ibo {QOpenGLBuffer::IndexBuffer};
+};
+
+#endif // MESHPOOL_H
@@ -0,0 +1,319 @@
+#include "frameprofiler.h"
+
+#include <QOpenGLTimeMonitor>
+
+#include <QtGui/QWindow>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QVector>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr size_t maxScopes = 32;
+constexpr size_t historySize = 300;
+constexpr qint64 titleUpdateNsecs = 1000 * 1000 * 1000;
+
+enum TraceThread {
+    CpuThread = 1,
+    GpuThread = 2
+};
+
+void append(std::deque<double> &history, double value)
+{
+    history.push_back(value);
+    if (history.size() > historySize)
+        history.pop_front();
+}
+
+FrameProfiler::Statistics statistics(const std::deque<double> &history)
+{
+    FrameProfiler::Statistics result;
+    if (history.empty())
+        return result;
+
+    std::vector<double> sorted(history.begin(), history.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0;
+    for (const auto value: sorted)
+        sum += value;
+
+    const auto p99 = size_t(std::ceil(0.99 * sorted.size())) - 1;
+    result.min = sorted.front();
+    result.avg = sum / sorted.size();
+    result.p99 = sorted[p99];
+    return result;
+}
+
+QJsonObject traceEvent(const QByteArray &name, int thread, double beginUsecs, double durationUsecs)
+{
+    return QJsonObject {
+        {QStringLiteral("name"), QString::fromLatin1(name)},
+        {QStringLiteral("cat"), thread == CpuThread ? QStringLiteral("cpu") : QStringLiteral("gpu")},
+        {QStringLiteral("ph"), QStringLiteral("X")},
+        {QStringLiteral("ts"), beginUsecs},
+        {QStringLiteral("dur"), durationUsecs},
+        {QStringLiteral("pid"), 1},
+        {QStringLiteral("tid"), thread},
+    };
+}
+
+QJsonObject threadName(int thread, const QString &name)
+{
+    return QJsonObject {
+        {QStringLiteral("name"), QStringLiteral("thread_name")},
+        {QStringLiteral("ph"), QStringLiteral("M")},
+        {QStringLiteral("pid"), 1},
+        {QStringLiteral("tid"), thread},
+        {QStringLiteral("args"), QJsonObject {{QStringLiteral("name"), name}}},
+    };
+}
+
+QString format(const FrameProfiler::Statistics &statistics)
+{
+    return QStringLiteral("%1/%2/%3")
+            .arg(statistics.min, 0, 'f', 3)
+            .arg(statistics.avg, 0, 'f', 3)
+            .arg(statistics.p99, 0, 'f', 3);
+}
+
+} // namespace
+
+FrameProfiler::FrameProfiler(const QStringList &arguments)
+{
+    for (int i = 1; i < arguments.size(); ++i) {
+        if (arguments.at(i) == QLatin1String("--profile")) {
+            m_enabled = true;
+        } else if (arguments.at(i) == QLatin1String("--trace") && i + 1 < arguments.size()) {
+            m_enabled = true;
+            m_traceFile = arguments.at(++i);
+        }
+    }
+}
+
+FrameProfiler::~FrameProfiler() = default;
+
+void FrameProfiler::create(QWindow *window)
+{
+    if (!m_enabled)
+        return;
+
+    m_window = window;
+    m_title = window->title().isEmpty() ? QCoreApplication::applicationName() : window->title();
+    m_timer.start();
+
+    m_hasGpuTimer = true;
+    for (auto &frame: m_frames) {
+        frame.monitor = std::make_unique<QOpenGLTimeMonitor>();
+        frame.monitor->setSampleCount(int(2 * maxScopes));
+        if (!frame.monitor->create()) {
+            m_hasGpuTimer = false;
+            break;
+        }
+    }
+
+    if (!m_hasGpuTimer) {
+        qWarning() << "Timer queries are not supported, GPU time is not available";
+        for (auto &frame: m_frames)
+            frame.monitor.reset();
+    }
+}
+
+void FrameProfiler::destroy()
+{
+    if (!m_enabled || !m_window)
+        return;
+
+    // the older frame is the one that would be reused next
+    collect(m_frames[m_frameIndex % 2], true);
+    collect(m_frames[(m_frameIndex + 1) % 2], true);
+    for (auto &frame: m_frames)
+        frame.monitor.reset();
+
+    if (!m_traceFile.isEmpty())
+        writeTrace(m_traceFile);
+    qInfo().noquote() << summaryText();
+
+    m_window->setTitle(m_title);
+    m_window = nullptr;
+}
+
+void FrameProfiler::beginFrame()
+{
+    if (!m_enabled)
+        return;
+
+    auto &frame = m_frames[m_frameIndex % 2];
+    if (frame.pending)
+        collect(frame, false);
+
+    frame.scopes.clear();
+    frame.samples = 0;
+    if (frame.monitor)
+        frame.monitor->reset();
+
+    m_frameScope = beginScope("frame");
+}
+
+void FrameProfiler::endFrame()
+{
+    if (!m_enabled)
+        return;
+
+    endScope(m_frameScope);
+    m_frames[m_frameIndex % 2].pending = true;
+    ++m_frameIndex;
+
+    const auto nsecs = m_timer.nsecsElapsed();
+    if (nsecs - m_lastTitleUpdate >= titleUpdateNsecs) {
+        m_lastTitleUpdate = nsecs;
+        updateTitle();
+    }
+}
+
+int FrameProfiler::beginScope(const char *name)
+{
+    if (!m_enabled)
+        return -1;
+
+    auto &frame = m_frames[m_frameIndex % 2];
+    if (frame.scopes.size() >= maxScopes)
+        return -1;
+
+    Scope scope;
+    scope.name = name;
+    scope.gpuBegin = recordSample(frame);
+    scope.cpuBegin = m_timer.nsecsElapsed();
+    frame.scopes.push_back(scope);
+    return int(frame.scopes.size()) - 1;
+}
+
+void FrameProfiler::endScope(int scope)
+{
+    if (!m_enabled || scope < 0)
+        return;
+
+    auto &frame = m_frames[m_frameIndex % 2];
+    frame.scopes[size_t(scope)].cpuEnd = m_timer.nsecsElapsed();
+    frame.scopes[size_t(scope)].gpuEnd = recordSample(frame);
+}
+
+std::vector<FrameProfiler::Summary> FrameProfiler::summary() const
+{
+    std::vector<Summary> result;
+    result.reserve(m_names.size());
+    for (const auto &name: m_names) {
+        const auto &series = *m_series.constFind(name);
+        Summary summary;
+        summary.name = name;
+        summary.cpu = statistics(series.cpu);
+        summary.gpu = statistics(series.gpu);
+        summary.samples = int(series.cpu.size());
+        summary.gpuSamples = int(series.gpu.size());
+        result.push_back(summary);
+    }
+    return result;
+}
+
+QString FrameProfiler::summaryText() const
+{
+    QString result = QStringLiteral("scope: cpu min/avg/p99, gpu min/avg/p99 (ms)");
+    for (const auto &scope: summary()) {
+        result += QStringLiteral("\n%1: %2, %3")
+                .arg(QString::fromLatin1(scope.name), -12)
+                .arg(format(scope.cpu))
+                .arg(scope.gpuSamples > 0 ? format(scope.gpu) : QStringLiteral("n/a"));
+    }
+    return result;
+}
+
+bool FrameProfiler::writeTrace(const QString &fileName) const
+{
+    QJsonArray events = m_traceEvents;
+    events.prepend(threadName(GpuThread, QStringLiteral("GPU")));
+    events.prepend(threadName(CpuThread, QStringLiteral("CPU")));
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCritical() << "Can't open" << fileName << ":" << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(QJsonObject {{QStringLiteral("traceEvents"), events}}).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+int FrameProfiler::recordSample(Frame &frame)
+{
+    if (!frame.monitor || frame.samples >= int(2 * maxScopes))
+        return -1;
+
+    ++frame.samples;
+    return frame.monitor->recordSample();
+}
+
+void FrameProfiler::collect(Frame &frame, bool wait)
+{
+    if (!frame.pending)
+        return;
+    frame.pending = false;
+
+    QVector<GLuint64> samples;
+    if (frame.monitor && frame.samples > 0 && (wait || frame.monitor->isResultAvailable()))
+        samples = frame.monitor->waitForSamples();
+
+    // GPU timestamps use their own clock, the trace aligns them to the start of the frame
+    const auto cpuOrigin = frame.scopes.empty() ? 0 : frame.scopes.front().cpuBegin;
+    const auto gpuOrigin = samples.isEmpty() ? 0 : samples.front();
+
+    for (const auto &scope: frame.scopes) {
+        if (scope.cpuEnd < scope.cpuBegin)
+            continue;
+
+        const auto name = QByteArray(scope.name);
+        auto it = m_series.find(name);
+        if (it == m_series.end()) {
+            m_names.push_back(name);
+            it = m_series.insert(name, {});
+        }
+
+        const auto cpuUsecs = (scope.cpuEnd - scope.cpuBegin) / 1e3;
+        append(it->cpu, cpuUsecs / 1e3);
+        if (!m_traceFile.isEmpty())
+            m_traceEvents.append(traceEvent(name, CpuThread, scope.cpuBegin / 1e3, cpuUsecs));
+
+        if (scope.gpuBegin < 0 || scope.gpuEnd < 0 || scope.gpuEnd >= samples.size())
+            continue;
+
+        const auto gpuUsecs = (samples[scope.gpuEnd] - samples[scope.gpuBegin]) / 1e3;
+        append(it->gpu, gpuUsecs / 1e3);
+        if (!m_traceFile.isEmpty()) {
+            const auto begin = cpuOrigin / 1e3 + (samples[scope.gpuBegin] - gpuOrigin) / 1e3;
+            m_traceEvents.append(traceEvent(name, GpuThread, begin, gpuUsecs));
+        }
+    }
+}
+
+void FrameProfiler::updateTitle()
+{
+    const auto it = m_series.constFind("frame");
+    if (!m_window || it == m_series.constEnd())
+        return;
+
+    const auto &series = *it;
+    const auto cpu = statistics(series.cpu);
+    const auto gpu = statistics(series.gpu);
+    auto title = QStringLiteral("%1 | cpu %2 ms (p99 %3)")
+            .arg(m_title)
+            .arg(cpu.avg, 0, 'f', 2)
+            .arg(cpu.p99, 0, 'f', 2);
+    if (!series.gpu.empty())
+        title += QStringLiteral(" | gpu %1 ms (p99 %2)").arg(gpu.avg, 0, 'f', 2).arg(gpu.p99, 0, 'f', 2);
+    m_window->setTitle(title);
+}
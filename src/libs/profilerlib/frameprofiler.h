@@ -0,0 +1,128 @@
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QJsonArray>
+#include <QtCore/QStringList>
+
+#include <array>
+#include <deque>
+#include <memory>
+#include <vector>
+
+class QOpenGLTimeMonitor;
+class QWindow;
+
+// CPU (QElapsedTimer) and GPU (QOpenGLTimeMonitor) timings of named scopes of a frame.
+// Enabled with "--profile", "--trace <file>" also writes all scopes as Chrome trace events
+// (chrome://tracing, Perfetto). GPU results are read two frames later from the other of two
+// monitors, frames whose results are not ready yet lose their GPU times instead of stalling.
+// The window title shows the rolling frame summary, the summary of every scope is printed
+// by destroy().
+class FrameProfiler
+{
+    Q_DISABLE_COPY(FrameProfiler)
+public:
+    struct Statistics
+    {
+        double min {0.0};
+        double avg {0.0};
+        double p99 {0.0};
+    };
+
+    struct Summary
+    {
+        QByteArray name;
+        Statistics cpu;
+        Statistics gpu;
+        int samples {0};
+        int gpuSamples {0};
+    };
+
+    explicit FrameProfiler(const QStringList &arguments);
+    FrameProfiler(FrameProfiler &&) = delete;
+    ~FrameProfiler();
+
+    FrameProfiler &operator=(FrameProfiler &&) = delete;
+
+    bool isEnabled() const noexcept { return m_enabled; }
+
+    // Must be called with the window's context current
+    void create(QWindow *window);
+    void destroy();
+
+    void beginFrame();
+    void endFrame();
+
+    int beginScope(const char *name);
+    void endScope(int scope);
+
+    // min/avg/p99 in milliseconds over the last frames
+    std::vector<Summary> summary() const;
+    QString summaryText() const;
+    bool writeTrace(const QString &fileName) const;
+
+private:
+    struct Scope
+    {
+        const char *name {nullptr};
+        qint64 cpuBegin {0};
+        qint64 cpuEnd {0};
+        int gpuBegin {-1};
+        int gpuEnd {-1};
+    };
+
+    struct Frame
+    {
+        std::unique_ptr<QOpenGLTimeMonitor> monitor;
+        std::vector<Scope> scopes;
+        int samples {0};
+        bool pending {false};
+    };
+
+    struct Series
+    {
+        std::deque<double> cpu;
+        std::deque<double> gpu;
+    };
+
+    int recordSample(Frame &frame);
+    void collect(Frame &frame, bool wait);
+    void updateTitle();
+
+private:
+    bool m_enabled {false};
+    QString m_traceFile;
+    QWindow *m_window {nullptr};
+    QString m_title;
+
+    QElapsedTimer m_timer;
+    qint64 m_lastTitleUpdate {0};
+    qint64 m_frameIndex {0};
+    int m_frameScope {-1};
+    bool m_hasGpuTimer {false};
+    std::array<Frame, 2> m_frames;
+
+    std::vector<QByteArray> m_names;
+    QHash<QByteArray, Series> m_series;
+    QJsonArray m_traceEvents;
+};
+
+// Measures the enclosing C++ scope
+class ProfileScope
+{
+    Q_DISABLE_COPY(ProfileScope)
+public:
+    ProfileScope(FrameProfiler &profiler, const char *name) :
+        m_profiler(profiler),
+        m_scope(profiler.beginScope(name))
+    {}
+    ~ProfileScope() { m_profiler.endScope(m_scope); }
+
+private:
+    FrameProfiler &m_profiler;
+    int m_scope {-1};
+};
+
+#endif // FRAMEPROFILER_H
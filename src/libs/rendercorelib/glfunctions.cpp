@@ -0,0 +1,32 @@
+#include "glfunctions.h"
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions_3_3_Core>
+
+#if QT_VERSION >= 0x060000
+#include <QtOpenGL/QOpenGLVersionFunctionsFactory>
+#endif
+
+#include <QtCore/QDebug>
+
+QOpenGLFunctions_3_3_Core *resolveCoreFunctions()
+{
+    const auto currentContext = QOpenGLContext::currentContext();
+    if (!currentContext) {
+        qCritical() << "Can't get OGL context";
+        return nullptr;
+    }
+
+#if QT_VERSION >= 0x060000
+    const auto funcs = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(currentContext);
+#else
+    const auto funcs = currentContext->versionFunctions<QOpenGLFunctions_3_3_Core>();
+#endif
+    if (!funcs) {
+        qCritical() << "Can't get OGL 3.3";
+        return nullptr;
+    }
+
+    funcs->initializeOpenGLFunctions();
+    return funcs;
+}
@@ -0,0 +1,11 @@
+#ifndef GLFUNCTIONS_H
+#define GLFUNCTIONS_H
+
+class QOpenGLFunctions_3_3_Core;
+
+// Returns the initialized GL 3.3 core functions of the current context, or nullptr when there
+// is no current context or it doesn't provide GL 3.3; the reason is printed then.
+// The functions are owned by the context.
+QOpenGLFunctions_3_3_Core *resolveCoreFunctions();
+
+#endif // GLFUNCTIONS_H
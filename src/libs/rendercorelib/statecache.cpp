@@ -0,0 +1,215 @@
+#include "statecache.h"
+
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <QtCore/QDebug>
+
+#include <algorithm>
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+namespace {
+
+// shadowed values that are unknown, the next call is always issued
+constexpr GLuint unknown = ~GLuint(0);
+
+constexpr GLenum bufferTargets[] = {
+    GL_ARRAY_BUFFER,
+    GL_ELEMENT_ARRAY_BUFFER,
+    GL_UNIFORM_BUFFER,
+    GL_DRAW_INDIRECT_BUFFER,
+    GL_PIXEL_UNPACK_BUFFER,
+};
+
+constexpr GLenum textureTargets[] = {
+    GL_TEXTURE_2D,
+    GL_TEXTURE_2D_ARRAY,
+    GL_TEXTURE_3D,
+    GL_TEXTURE_CUBE_MAP,
+};
+
+constexpr GLenum capabilities[] = {
+    GL_DEPTH_TEST,
+    GL_BLEND,
+    GL_CULL_FACE,
+    GL_SCISSOR_TEST,
+};
+
+// the index of value in values or -1, the state of unlisted targets isn't shadowed
+template<size_t Size>
+int indexOf(const GLenum (&values)[Size], GLenum value)
+{
+    const auto it = std::find(std::begin(values), std::end(values), value);
+    return it != std::end(values) ? int(it - std::begin(values)) : -1;
+}
+
+} // namespace
+
+StateCache::StateCache(const QStringList &arguments)
+{
+    m_enabled = !arguments.contains(QStringLiteral("--no-state-cache"));
+    m_statistics = arguments.contains(QStringLiteral("--state-stats"));
+    invalidate();
+}
+
+void StateCache::create(QOpenGLFunctions_3_3_Core *funcs)
+{
+    m_funcs = funcs;
+    invalidate();
+}
+
+void StateCache::destroy()
+{
+    if (!m_funcs)
+        return;
+
+    if (m_statistics && m_frames > 0) {
+        const auto issued = double(m_total.issued) / m_frames;
+        const auto elided = double(m_total.elided) / m_frames;
+        const auto calls = issued + elided;
+        qInfo().noquote() << QStringLiteral("GL state calls per frame: %1 issued, %2 elided (%3%) over %4 frames%5")
+                             .arg(issued, 0, 'f', 1)
+                             .arg(elided, 0, 'f', 1)
+                             .arg(calls > 0 ? 100.0 * elided / calls : 0.0, 0, 'f', 1)
+                             .arg(m_frames)
+                             .arg(m_enabled ? QString() : QStringLiteral(", cache disabled"));
+    }
+    m_funcs = nullptr;
+}
+
+void StateCache::invalidate()
+{
+    m_program = unknown;
+    m_vertexArray = unknown;
+    m_buffers.fill(unknown);
+    m_activeTexture = unknown;
+    for (auto &unit: m_textures)
+        unit.fill(unknown);
+    m_capabilities.fill(unknown);
+    m_depthFunc = unknown;
+    m_depthMask = unknown;
+    m_colorMask = unknown;
+    m_blendFunc.fill(unknown);
+    m_viewportKnown = false;
+}
+
+void StateCache::useProgram(GLuint program)
+{
+    if (elide(m_program == program))
+        return;
+    m_funcs->glUseProgram(program);
+    m_program = program;
+}
+
+void StateCache::bindVertexArray(GLuint vertexArray)
+{
+    if (elide(m_vertexArray == vertexArray))
+        return;
+    m_funcs->glBindVertexArray(vertexArray);
+    m_vertexArray = vertexArray;
+    m_buffers[size_t(indexOf(bufferTargets, GL_ELEMENT_ARRAY_BUFFER))] = unknown;
+}
+
+void StateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+    const auto index = indexOf(bufferTargets, target);
+    if (elide(index >= 0 && m_buffers[size_t(index)] == buffer))
+        return;
+    m_funcs->glBindBuffer(target, buffer);
+    if (index >= 0)
+        m_buffers[size_t(index)] = buffer;
+}
+
+void StateCache::bindTexture(int unit, GLenum target, GLuint texture)
+{
+    Q_ASSERT(unit >= 0 && unit < TextureUnits);
+    const auto index = indexOf(textureTargets, target);
+    auto &bound = m_textures[size_t(unit)];
+    if (elide(index >= 0 && bound[size_t(index)] == texture))
+        return;
+
+    if (!elide(m_activeTexture == GLuint(unit))) {
+        m_funcs->glActiveTexture(GLenum(GL_TEXTURE0 + unit));
+        m_activeTexture = GLuint(unit);
+    }
+    m_funcs->glBindTexture(target, texture);
+    if (index >= 0)
+        bound[size_t(index)] = texture;
+}
+
+void StateCache::setCapability(GLenum capability, bool enabled)
+{
+    const auto index = indexOf(capabilities, capability);
+    if (elide(index >= 0 && m_capabilities[size_t(index)] == GLuint(enabled)))
+        return;
+    if (enabled)
+        m_funcs->glEnable(capability);
+    else
+        m_funcs->glDisable(capability);
+    if (index >= 0)
+        m_capabilities[size_t(index)] = GLuint(enabled);
+}
+
+void StateCache::depthFunc(GLenum func)
+{
+    if (elide(m_depthFunc == func))
+        return;
+    m_funcs->glDepthFunc(func);
+    m_depthFunc = func;
+}
+
+void StateCache::depthMask(bool enabled)
+{
+    if (elide(m_depthMask == GLuint(enabled)))
+        return;
+    m_funcs->glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    m_depthMask = GLuint(enabled);
+}
+
+void StateCache::colorMask(bool enabled)
+{
+    if (elide(m_colorMask == GLuint(enabled)))
+        return;
+    const auto mask = enabled ? GL_TRUE : GL_FALSE;
+    m_funcs->glColorMask(mask, mask, mask, mask);
+    m_colorMask = GLuint(enabled);
+}
+
+void StateCache::blendFunc(GLenum source, GLenum destination)
+{
+    if (elide(m_blendFunc[0] == source && m_blendFunc[1] == destination))
+        return;
+    m_funcs->glBlendFunc(source, destination);
+    m_blendFunc = {source, destination};
+}
+
+void StateCache::viewport(int x, int y, int width, int height)
+{
+    const std::array<GLint, 4> viewport {x, y, width, height};
+    if (elide(m_viewportKnown && m_viewport == viewport))
+        return;
+    m_funcs->glViewport(x, y, width, height);
+    m_viewport = viewport;
+    m_viewportKnown = true;
+}
+
+void StateCache::endFrame()
+{
+    m_lastFrame = m_frame;
+    m_total.issued += m_frame.issued;
+    m_total.elided += m_frame.elided;
+    m_frame = {};
+    ++m_frames;
+}
+
+bool StateCache::elide(bool unchanged) noexcept
+{
+    if (m_enabled && unchanged) {
+        ++m_frame.elided;
+        return true;
+    }
+    ++m_frame.issued;
+    return false;
+}
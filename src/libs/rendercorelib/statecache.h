@@ -0,0 +1,90 @@
+#ifndef STATECACHE_H
+#define STATECACHE_H
+
+#include <QtGui/qopengl.h>
+
+#include <QtCore/QStringList>
+
+#include <array>
+
+class QOpenGLFunctions_3_3_Core;
+
+// Shadows the GL state that changes while drawing a frame - the program, the VAO, buffer and
+// texture bindings, depth, blend and color write state and the viewport - and skips the calls
+// that wouldn't change it. Bindings persist between frames, so code that changes the state
+// without the cache (e.g. QOpenGLVertexArrayObject::Binder or QOpenGLTexture::bind()) must be
+// followed by invalidate(). Until a value is set through the cache the next call is issued.
+// The calls issued and elided are counted per frame; with "--state-stats" destroy() prints
+// the averages, "--no-state-cache" issues every call for comparison.
+class StateCache
+{
+    Q_DISABLE_COPY(StateCache)
+public:
+    struct Counters
+    {
+        qint64 issued {0};
+        qint64 elided {0};
+    };
+
+    explicit StateCache(const QStringList &arguments);
+
+    bool isEnabled() const noexcept { return m_enabled; }
+
+    void create(QOpenGLFunctions_3_3_Core *funcs);
+    void destroy();
+
+    // Forgets the shadowed state, e.g. after textures were uploaded
+    void invalidate();
+
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vertexArray);
+    // GL_ELEMENT_ARRAY_BUFFER belongs to the VAO, it's forgotten when the VAO changes
+    void bindBuffer(GLenum target, GLuint buffer);
+    void bindTexture(int unit, GLenum target, GLuint texture);
+
+    // GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE or GL_SCISSOR_TEST
+    void setCapability(GLenum capability, bool enabled);
+    void depthFunc(GLenum func);
+    void depthMask(bool enabled);
+    void colorMask(bool enabled);
+    void blendFunc(GLenum source, GLenum destination);
+    void viewport(int x, int y, int width, int height);
+
+    // Finishes counting the frame
+    void endFrame();
+    Counters lastFrame() const noexcept { return m_lastFrame; }
+
+private:
+    static constexpr int TextureUnits = 16;
+    static constexpr int BufferTargets = 5;
+    static constexpr int TextureTargets = 4;
+    static constexpr int Capabilities = 4;
+
+    // counts the call, returns true if it can be skipped
+    bool elide(bool unchanged) noexcept;
+
+private:
+    QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
+    bool m_enabled {true};
+    bool m_statistics {false};
+
+    GLuint m_program;
+    GLuint m_vertexArray;
+    std::array<GLuint, BufferTargets> m_buffers;
+    GLuint m_activeTexture;
+    std::array<std::array<GLuint, TextureTargets>, TextureUnits> m_textures;
+    std::array<GLuint, Capabilities> m_capabilities;
+    GLuint m_depthFunc;
+    GLuint m_depthMask;
+    GLuint m_colorMask;
+    std::array<GLuint, 2> m_blendFunc;
+    std::array<GLint, 4> m_viewport {};
+    bool m_viewportKnown {false};
+
+    Counters m_frame;
+    Counters m_lastFrame;
+    Counters m_total;
+    int m_frames {0};
+};
+
+#endif // STATECACHE_H
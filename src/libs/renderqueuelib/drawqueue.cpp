@@ -0,0 +1,96 @@
+#include "drawqueue.h"
+#include "radixsort.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int depthShift = 0;
+constexpr int textureSetShift = depthShift + DrawQueue::DepthBits;
+constexpr int materialShift = textureSetShift + DrawQueue::TextureSetBits;
+constexpr int programShift = materialShift + DrawQueue::MaterialBits;
+constexpr int passShift = programShift + DrawQueue::ProgramBits;
+static_assert(passShift + DrawQueue::PassBits == 64, "The key fields must fill 64 bits");
+
+constexpr quint64 mask(int bits)
+{
+    return (quint64(1) << bits) - 1;
+}
+
+quint64 field(int value, int bits, int shift) noexcept
+{
+    Q_ASSERT_X(value >= 0 && quint64(value) <= mask(bits), "DrawQueue", "key field out of range");
+    return (quint64(value) & mask(bits)) << shift;
+}
+
+} // namespace
+
+quint64 DrawQueue::makeKey(int pass, int program, int material, int textureSet, float depth) noexcept
+{
+    // in double: with a 24-bit mantissa 0xffffff + 0.5f rounds to 0x1000000 in float
+    // NaN passes both std::min() and std::max() and llround(NaN) is unspecified
+    const auto clampedDepth = std::isnan(depth) ? 0.0 : std::min(std::max(double(depth), 0.0), 1.0);
+    const auto quantizedDepth = quint64(std::llround(clampedDepth * double(mask(DepthBits))));
+    Q_ASSERT_X(quantizedDepth <= mask(DepthBits), "DrawQueue", "depth out of range");
+    return field(pass, PassBits, passShift)
+            | field(program, ProgramBits, programShift)
+            | field(material, MaterialBits, materialShift)
+            | field(textureSet, TextureSetBits, textureSetShift)
+            | quantizedDepth << depthShift;
+}
+
+int DrawQueue::pass(quint64 key) noexcept
+{
+    return int((key >> passShift) & mask(PassBits));
+}
+
+int DrawQueue::program(quint64 key) noexcept
+{
+    return int((key >> programShift) & mask(ProgramBits));
+}
+
+int DrawQueue::material(quint64 key) noexcept
+{
+    return int((key >> materialShift) & mask(MaterialBits));
+}
+
+int DrawQueue::textureSet(quint64 key) noexcept
+{
+    return int((key >> textureSetShift) & mask(TextureSetBits));
+}
+
+void DrawQueue::reserve(int count)
+{
+    m_draws.reserve(size_t(count));
+    m_scratch.reserve(size_t(count));
+}
+
+void DrawQueue::clear()
+{
+    m_draws.clear();
+}
+
+void DrawQueue::add(quint64 key, int index)
+{
+    m_draws.push_back({key, index});
+}
+
+void DrawQueue::sort()
+{
+    radixSort(m_draws, m_scratch, [](const Draw &draw) { return draw.key; });
+}
+
+DrawQueue::StateChanges DrawQueue::stateChanges() const noexcept
+{
+    StateChanges result;
+    for (size_t i = 0; i < m_draws.size(); ++i) {
+        const auto key = m_draws[i].key;
+        const auto previous = i > 0 ? m_draws[i - 1].key : ~key;
+        const auto programChanged = program(key) != program(previous);
+        result.programs += programChanged;
+        result.materials += programChanged || material(key) != material(previous);
+        result.textureSets += textureSet(key) != textureSet(previous);
+    }
+    return result;
+}
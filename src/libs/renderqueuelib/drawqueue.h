@@ -0,0 +1,63 @@
+#ifndef DRAWQUEUE_H
+#define DRAWQUEUE_H
+
+#include <QtCore/QtGlobal>
+
+#include <vector>
+
+// Draws of a frame with a 64-bit sort key each, from the most significant bits: the pass (4 bits),
+// the program (10), the material (14), the texture set (12) and the depth (24). In key order the
+// passes come one after another and within a pass the draws that share a program are adjacent,
+// then those that share a material and then textures, so every program, material and texture set
+// is bound once per run; the depth orders the draws of a run front-to-back.
+// add() the draws in any order, sort() them and submit draws() in order, index is the caller's
+// reference to the draw, e.g. into its render list.
+class DrawQueue
+{
+public:
+    static constexpr int PassBits = 4;
+    static constexpr int ProgramBits = 10;
+    static constexpr int MaterialBits = 14;
+    static constexpr int TextureSetBits = 12;
+    static constexpr int DepthBits = 24;
+
+    struct Draw
+    {
+        quint64 key {0};
+        int index {0};
+    };
+
+    // The binds needed to submit draws() in their current order, the first draw binds everything.
+    // Materials are per program, so a new program needs its material again.
+    struct StateChanges
+    {
+        int programs {0};
+        int materials {0};
+        int textureSets {0};
+    };
+
+    // depth is clamped to [0, 1], NaN is 0, e.g. the view depth divided by the far plane; pass
+    // 1 - depth to draw back-to-front (e.g. blended draws)
+    static quint64 makeKey(int pass, int program, int material, int textureSet, float depth) noexcept;
+    static int pass(quint64 key) noexcept;
+    static int program(quint64 key) noexcept;
+    static int material(quint64 key) noexcept;
+    static int textureSet(quint64 key) noexcept;
+
+    int count() const noexcept { return int(m_draws.size()); }
+    void reserve(int count);
+    void clear();
+    void add(quint64 key, int index);
+
+    // Orders the draws by key with radixSort(), draws with equal keys keep the order of add()
+    void sort();
+    const std::vector<Draw> &draws() const noexcept { return m_draws; }
+
+    StateChanges stateChanges() const noexcept;
+
+private:
+    std::vector<Draw> m_draws;
+    std::vector<Draw> m_scratch;
+};
+
+#endif // DRAWQUEUE_H
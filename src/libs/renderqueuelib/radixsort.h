@@ -0,0 +1,56 @@
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+#include <QtCore/QtGlobal>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+// Sorts items by the 64-bit key(item) in ascending order, items with equal keys keep their order.
+// Least significant digit first with 8-bit digits: the histograms of all digits are counted in one
+// pass over the items, then every digit is one scattering pass, except the digits that are the
+// same in all items (e.g. the high bits of keys that share a pass and a program), which are skipped.
+// scratch is resized to the size of items, its contents are undefined afterwards.
+template<typename Item, typename Key>
+void radixSort(std::vector<Item> &items, std::vector<Item> &scratch, Key key)
+{
+    constexpr int digits = 8;
+    constexpr int buckets = 256;
+    // below this counting the histograms costs more than an insertion sort
+    constexpr size_t minItems = 64;
+    if (items.size() < minItems) {
+        const auto byKey = [&key](const Item &lhs, const Item &rhs) { return key(lhs) < key(rhs); };
+        for (auto it = items.begin(); it != items.end(); ++it)
+            std::rotate(std::upper_bound(items.begin(), it, *it, byKey), it, it + 1);
+        return;
+    }
+
+    std::array<std::array<size_t, buckets>, digits> offsets {};
+    for (const auto &item: items) {
+        const quint64 value = key(item);
+        for (int digit = 0; digit < digits; ++digit)
+            ++offsets[size_t(digit)][(value >> (8 * digit)) & 0xff];
+    }
+
+    scratch.resize(items.size());
+    const quint64 first = key(items.front());
+    for (int digit = 0; digit < digits; ++digit) {
+        const auto shift = 8 * digit;
+        auto &offset = offsets[size_t(digit)];
+        if (offset[(first >> shift) & 0xff] == items.size())
+            continue;
+
+        size_t sum = 0;
+        for (auto &bucket: offset) {
+            const auto count = bucket;
+            bucket = sum;
+            sum += count;
+        }
+        for (const auto &item: items)
+            scratch[offset[(quint64(key(item)) >> shift) & 0xff]++] = item;
+        items.swap(scratch);
+    }
+}
+
+#endif // RADIXSORT_H
@@ -0,0 +1,18 @@
+#include "renderlist.h"
+
+#include <algorithm>
+
+void RenderList::resize(int count)
+{
+    m_objects.resize(size_t(count));
+    m_data.resize(size_t(count) * PacketFloats);
+}
+
+void RenderList::pack(int packet, int object, const QMatrix4x4 &model)
+{
+    m_objects[size_t(packet)] = object;
+    auto it = m_data.begin() + std::ptrdiff_t(packet) * PacketFloats;
+    it = std::copy(model.constData(), model.constData() + 16, it);
+    const auto normalMatrix = model.normalMatrix();
+    std::copy(normalMatrix.constData(), normalMatrix.constData() + 9, it);
+}
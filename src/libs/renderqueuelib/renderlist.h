@@ -0,0 +1,37 @@
+#ifndef RENDERLIST_H
+#define RENDERLIST_H
+
+#include <QtGui/QMatrix4x4>
+#include <QtGui/qopengl.h>
+
+#include <vector>
+
+// Draw packets of a pass in draw order: the model of every packet and its uniform data, packed
+// as mat4 model + mat3 normal matrix (column-major, the layout of CubeField's instance buffer).
+// The GL thread only uploads data() as instance data or replays the packets one by one.
+// pack() may be called from several threads for different packets.
+class RenderList
+{
+public:
+    static constexpr int PacketFloats = 16 + 9;
+
+    RenderList() = default;
+
+    int count() const noexcept { return int(m_objects.size()); }
+    void resize(int count);
+
+    void pack(int packet, int object, const QMatrix4x4 &model);
+
+    int object(int packet) const { return m_objects[size_t(packet)]; }
+    const std::vector<int> &objects() const noexcept { return m_objects; }
+
+    const GLfloat *model(int packet) const { return m_data.data() + size_t(packet) * PacketFloats; }
+    const GLfloat *normalMatrix(int packet) const { return model(packet) + 16; }
+    const std::vector<GLfloat> &data() const noexcept { return m_data; }
+
+private:
+    std::vector<int> m_objects;
+    std::vector<GLfloat> m_data;
+};
+
+#endif // RENDERLIST_H
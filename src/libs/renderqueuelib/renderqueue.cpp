@@ -0,0 +1,427 @@
+#include "renderqueue.h"
+#include "radixsort.h"
+
+#include <bvh.h>
+#include <frustumculler.h>
+#include <statecache.h>
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLShaderProgram>
+
+#include <QtCore/QDebug>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace {
+
+// below this a task costs more to schedule than to run
+constexpr int minObjectsPerTask = 4096;
+
+int rangeBegin(int task, int taskCount, int count)
+{
+    return int(qint64(count) * task / taskCount);
+}
+
+// Orders like byDepth in update(): by depth, then by index. The float's bits are flipped so that
+// they compare as unsigned integers, -0 is turned into +0 first.
+quint64 depthKey(float depth, int index)
+{
+    depth += 0.0f;
+    quint32 bits = 0;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    bits = (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+    return quint64(bits) << 32 | quint32(index);
+}
+
+// must compute gl_Position exactly as the examples' vertex shaders do for GL_EQUAL to pass
+constexpr auto depthVertexShader = R"(
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 3) in mat4 instanceModel;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform bool instanced;
+
+invariant gl_Position;
+
+void main()
+{
+    mat4 cubeModel = model;
+    if (instanced)
+        cubeModel = instanceModel;
+
+    gl_Position = projection * view * cubeModel * vec4(position, 1.0f);
+}
+)";
+
+constexpr auto depthFragmentShader = R"(
+#version 330 core
+
+void main()
+{
+}
+)";
+
+} // namespace
+
+RenderQueue::RenderQueue(const QStringList &arguments) :
+    m_culler(std::make_unique<FrustumCuller>()),
+    m_bvh(std::make_unique<Bvh>())
+{
+    auto threadCount = QThread::idealThreadCount();
+    for (int i = 1; i < arguments.size(); ++i) {
+        if (arguments.at(i) == QLatin1String("--cull"))
+            m_culling = Culling::Frustum;
+        else if (arguments.at(i) == QLatin1String("--cull-bvh"))
+            m_culling = Culling::Hierarchy;
+        else if (arguments.at(i) == QLatin1String("--sort-draws"))
+            m_sorted = true;
+        else if (arguments.at(i) == QLatin1String("--depth-prepass"))
+            m_depthPrePass = true;
+        else if (arguments.at(i) == QLatin1String("--overdraw"))
+            m_overdrawEnabled = true;
+        else if (arguments.at(i) == QLatin1String("--threads") && i + 1 < arguments.size())
+            threadCount = arguments.at(++i).toInt();
+    }
+    setThreadCount(threadCount);
+    m_statisticsMode = modeText();
+}
+
+RenderQueue::~RenderQueue() = default;
+
+void RenderQueue::setCulling(Culling culling)
+{
+    if (m_culling == culling)
+        return;
+
+    m_culling = culling;
+    m_reportPending = true;
+}
+
+void RenderQueue::setSorted(bool sorted)
+{
+    if (m_sorted == sorted)
+        return;
+
+    m_sorted = sorted;
+    m_reportPending = true;
+}
+
+void RenderQueue::setDepthPrePass(bool enabled)
+{
+    if (m_depthPrePass == enabled)
+        return;
+
+    m_depthPrePass = enabled;
+    m_reportPending = true;
+}
+
+void RenderQueue::setThreadCount(int count)
+{
+    m_threadCount = std::max(1, count);
+    // the calling thread takes the first task
+    m_pool.setMaxThreadCount(std::max(1, m_threadCount - 1));
+}
+
+QString RenderQueue::modeText() const
+{
+    static const char *cullingNames[] = {"none", "frustum", "bvh"};
+    return QStringLiteral("culling: %1, sorted: %2, depth pre-pass: %3, threads: %4")
+            .arg(QString::fromLatin1(cullingNames[int(m_culling)]))
+            .arg(m_sorted ? QStringLiteral("yes") : QStringLiteral("no"))
+            .arg(m_depthPrePass ? QStringLiteral("yes") : QStringLiteral("no"))
+            .arg(m_threadCount);
+}
+
+void RenderQueue::create(QOpenGLFunctions_3_3_Core *funcs, StateCache *state)
+{
+    m_funcs = funcs;
+    m_state = state;
+
+    m_depthProgram = std::make_unique<QOpenGLShaderProgram>();
+    m_depthProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, depthVertexShader);
+    m_depthProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, depthFragmentShader);
+    if (!m_depthProgram->link())
+        qCritical() << "Can't link depth program" << m_depthProgram->log();
+
+    m_viewLocation = m_depthProgram->uniformLocation("view");
+    m_projectionLocation = m_depthProgram->uniformLocation("projection");
+    m_modelLocation = m_depthProgram->uniformLocation("model");
+    m_instancedLocation = m_depthProgram->uniformLocation("instanced");
+
+    if (m_overdrawEnabled) {
+        for (auto &query: m_queries)
+            m_funcs->glGenQueries(1, &query.id);
+    }
+}
+
+void RenderQueue::destroy()
+{
+    if (!m_funcs)
+        return;
+
+    report();
+    for (auto &query: m_queries) {
+        m_funcs->glDeleteQueries(1, &query.id);
+        query = {};
+    }
+    m_depthProgram.reset();
+    m_funcs = nullptr;
+}
+
+void RenderQueue::setModels(const std::vector<QMatrix4x4> &models, float radius)
+{
+    m_models = models;
+    m_order.clear();
+
+    // a scaled model would need its largest column length, the examples' models are rigid
+    m_spheres.resize(models.size());
+    std::vector<Bvh::Box> boxes(models.size());
+    const QVector3D extent(radius, radius, radius);
+    for (size_t i = 0; i < models.size(); ++i) {
+        const auto center = models[i].column(3).toVector3D();
+        m_spheres[i] = QVector4D(center, radius);
+        boxes[i] = {center - extent, center + extent};
+    }
+    m_culler->setSpheres(m_spheres);
+    m_bvh->build(boxes);
+    m_depths.resize(models.size());
+}
+
+int RenderQueue::taskCount(int objects) const noexcept
+{
+    return std::max(1, std::min(m_threadCount, objects / minObjectsPerTask));
+}
+
+// Runs function(task) for every task in [0, tasks) and waits for all of them,
+// the calling thread runs the first one
+template<typename Function>
+void RenderQueue::parallelFor(int tasks, Function function)
+{
+    if (tasks == 1) {
+        function(0);
+        return;
+    }
+
+    QSemaphore done;
+    for (int task = 1; task < tasks; ++task) {
+        m_pool.start([&function, &done, task]() {
+            function(task);
+            done.release();
+        });
+    }
+    function(0);
+    done.acquire(tasks - 1);
+}
+
+bool RenderQueue::update(const QMatrix4x4 &view, const QMatrix4x4 &projection)
+{
+    const auto viewProjection = projection * view;
+
+    // the hierarchy is walked on this thread, then its result is split like the models
+    const auto hierarchy = m_culling == Culling::Hierarchy;
+    if (hierarchy) {
+        m_candidates.clear();
+        m_bvh->cull(viewProjection, m_candidates);
+    } else if (m_culling == Culling::Frustum) {
+        m_culler->setViewProjection(viewProjection);
+    }
+
+    // only the z row of the view matrix is needed for the depth of a model's origin
+    const QVector4D zRow = view.row(2);
+    // ties are broken by index, so the order doesn't depend on how the models were split
+    const auto byDepth = [this](int lhs, int rhs) {
+        const auto lhsDepth = m_depths[size_t(lhs)];
+        const auto rhsDepth = m_depths[size_t(rhs)];
+        return lhsDepth < rhsDepth || (lhsDepth == rhsDepth && lhs < rhs);
+    };
+
+    const auto count = hierarchy ? int(m_candidates.size()) : int(m_models.size());
+    const auto tasks = taskCount(count);
+    m_runs.resize(size_t(tasks));
+    if (m_sorted) {
+        m_sortKeys.resize(size_t(tasks));
+        m_sortScratch.resize(size_t(tasks));
+    }
+    parallelFor(tasks, [&](int task) {
+        const auto begin = rangeBegin(task, tasks, count);
+        const auto end = rangeBegin(task + 1, tasks, count);
+        auto &run = m_runs[size_t(task)];
+        run.clear();
+        if (hierarchy) {
+            run.assign(m_candidates.begin() + begin, m_candidates.begin() + end);
+        } else if (m_culling == Culling::Frustum) {
+            m_culler->cull(begin, end, run);
+        } else {
+            run.resize(size_t(end - begin));
+            std::iota(run.begin(), run.end(), begin);
+        }
+
+        if (m_sorted) {
+            // every model is in one run only, so the tasks write disjoint depths
+            auto &keys = m_sortKeys[size_t(task)];
+            keys.clear();
+            for (const auto index: run) {
+                const auto &sphere = m_spheres[size_t(index)];
+                const auto depth = -QVector4D::dotProduct(zRow, QVector4D(sphere.toVector3D(), 1.0f));
+                m_depths[size_t(index)] = depth;
+                keys.push_back(depthKey(depth, index));
+            }
+            radixSort(keys, m_sortScratch[size_t(task)], [](quint64 key) { return key; });
+            for (size_t i = 0; i < run.size(); ++i)
+                run[i] = int(quint32(keys[i]));
+        }
+    });
+
+    m_previousOrder.swap(m_order);
+    m_order.clear();
+    m_runBounds.assign(1, 0);
+    for (const auto &run: m_runs) {
+        m_order.insert(m_order.end(), run.begin(), run.end());
+        m_runBounds.push_back(m_order.size());
+    }
+
+    // the sorted runs are merged pairwise, log2(tasks) passes
+    if (m_sorted) {
+        const auto runs = m_runs.size();
+        for (size_t width = 1; width < runs; width *= 2) {
+            for (size_t first = 0; first + width < runs; first += 2 * width) {
+                const auto begin = m_order.begin();
+                std::inplace_merge(begin + std::ptrdiff_t(m_runBounds[first]),
+                                   begin + std::ptrdiff_t(m_runBounds[first + width]),
+                                   begin + std::ptrdiff_t(m_runBounds[std::min(first + 2 * width, runs)]),
+                                   byDepth);
+            }
+        }
+    }
+
+    if (m_order == m_previousOrder)
+        return false;
+
+    // a normal matrix per packet, this is the most expensive part
+    const auto packets = int(m_order.size());
+    const auto packTasks = taskCount(packets);
+    m_renderList.resize(packets);
+    parallelFor(packTasks, [&](int task) {
+        const auto end = rangeBegin(task + 1, packTasks, packets);
+        for (auto packet = rangeBegin(task, packTasks, packets); packet < end; ++packet) {
+            const auto object = m_order[size_t(packet)];
+            m_renderList.pack(packet, object, m_models[size_t(object)]);
+        }
+    });
+    return true;
+}
+
+int RenderQueue::pick(const QVector3D &origin, const QVector3D &direction) const
+{
+    return m_bvh->pick(origin, direction);
+}
+
+QOpenGLShaderProgram *RenderQueue::beginDepthPrePass(const QMatrix4x4 &view, const QMatrix4x4 &projection,
+                                                     bool instanced)
+{
+    m_state->colorMask(false);
+
+    m_state->useProgram(m_depthProgram->programId());
+    m_depthProgram->setUniformValue(m_viewLocation, view);
+    m_depthProgram->setUniformValue(m_projectionLocation, projection);
+    m_depthProgram->setUniformValue(m_instancedLocation, instanced);
+    return m_depthProgram.get();
+}
+
+void RenderQueue::endDepthPrePass()
+{
+    m_state->colorMask(true);
+}
+
+void RenderQueue::beginMainPass()
+{
+    if (m_depthPrePass) {
+        m_state->depthFunc(GL_EQUAL);
+        m_state->depthMask(false);
+    }
+
+    if (!m_overdrawEnabled || !m_funcs)
+        return;
+
+    // key events come without a current context, so the statistics are reported here
+    if (m_reportPending) {
+        report();
+        m_reportPending = false;
+    }
+
+    auto &query = m_queries[size_t(m_frameIndex % 2)];
+    collect(query);
+
+    GLint viewport[4] = {};
+    m_funcs->glGetIntegerv(GL_VIEWPORT, viewport);
+    query.pixels = qint64(viewport[2]) * viewport[3];
+    m_funcs->glBeginQuery(GL_SAMPLES_PASSED, query.id);
+}
+
+void RenderQueue::endMainPass()
+{
+    if (m_overdrawEnabled && m_funcs) {
+        m_funcs->glEndQuery(GL_SAMPLES_PASSED);
+        m_queries[size_t(m_frameIndex % 2)].pending = true;
+        ++m_frameIndex;
+    }
+
+    if (m_depthPrePass) {
+        m_state->depthMask(true);
+        m_state->depthFunc(GL_LESS);
+    }
+}
+
+RenderQueue::Overdraw RenderQueue::overdraw() const noexcept
+{
+    Overdraw result;
+    result.frames = m_frames;
+    if (m_pixels > 0)
+        result.fragmentsPerPixel = double(m_fragments) / m_pixels;
+    return result;
+}
+
+void RenderQueue::collect(Query &query)
+{
+    if (!query.pending)
+        return;
+    query.pending = false;
+
+    // the query was issued two frames ago, so waiting for it rarely stalls
+    GLuint64 samples = 0;
+    m_funcs->glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &samples);
+    m_fragments += qint64(samples);
+    m_pixels += query.pixels;
+    ++m_frames;
+}
+
+void RenderQueue::report()
+{
+    if (!m_overdrawEnabled || !m_funcs)
+        return;
+
+    // the older query first, both were issued before the mode changed
+    collect(m_queries[size_t(m_frameIndex % 2)]);
+    collect(m_queries[size_t((m_frameIndex + 1) % 2)]);
+
+    const auto statistics = overdraw();
+    if (statistics.frames > 0) {
+        qInfo().noquote() << QStringLiteral("Overdraw (%1): %2 shaded fragments per pixel over %3 frames")
+                             .arg(m_statisticsMode)
+                             .arg(statistics.fragmentsPerPixel, 0, 'f', 3)
+                             .arg(statistics.frames);
+    }
+
+    m_frames = 0;
+    m_fragments = 0;
+    m_pixels = 0;
+    m_statisticsMode = modeText();
+}
@@ -0,0 +1,154 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include "renderlist.h"
+
+#include <QtGui/QMatrix4x4>
+#include <QtGui/qopengl.h>
+
+#include <QtCore/QStringList>
+#include <QtCore/QThreadPool>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+class Bvh;
+class FrustumCuller;
+class QOpenGLFunctions_3_3_Core;
+class QOpenGLShaderProgram;
+class StateCache;
+
+// Opaque draw stage of the lighting examples.
+// order() lists the models to draw: with "--cull" only those whose bounding spheres intersect
+// the view frustum (FrustumCuller), with "--cull-bvh" those whose bounding boxes do (Bvh),
+// with "--sort-draws" front-to-back by the view depth of their origins (with radixSort()),
+// otherwise all of them in their original order. Culling, sorting and packing renderList() are split between
+// "--threads <count>" threads (the ideal thread count by default, the calling thread is one of
+// them) once there are enough models. With "--depth-prepass" the models are drawn into the depth buffer
+// first with a depth-only program, the main pass then shades only the visible fragments with
+// glDepthFunc(GL_EQUAL); vertex shaders of the main pass must declare gl_Position invariant.
+// With "--overdraw" the fragments of the main pass are counted with GL_SAMPLES_PASSED queries,
+// read two frames later, and the average per window pixel is printed on every mode change and
+// by destroy(). The passes change the program and the depth and color write state through
+// the StateCache.
+class RenderQueue
+{
+    Q_DISABLE_COPY(RenderQueue)
+public:
+    enum class Culling {
+        None,
+        Frustum,
+        Hierarchy
+    };
+
+    struct Overdraw
+    {
+        int frames {0};
+        double fragmentsPerPixel {0.0};
+    };
+
+    explicit RenderQueue(const QStringList &arguments);
+    ~RenderQueue();
+
+    Culling culling() const noexcept { return m_culling; }
+    void setCulling(Culling culling);
+
+    bool isSorted() const noexcept { return m_sorted; }
+    void setSorted(bool sorted);
+
+    bool hasDepthPrePass() const noexcept { return m_depthPrePass; }
+    void setDepthPrePass(bool enabled);
+
+    int threadCount() const noexcept { return m_threadCount; }
+    void setThreadCount(int count);
+
+    // e.g. "culling: bvh, sorted: yes, depth pre-pass: no, threads: 8"
+    QString modeText() const;
+
+    void create(QOpenGLFunctions_3_3_Core *funcs, StateCache *state);
+    void destroy();
+
+    // radius is the bounding sphere of the mesh around its origin
+    void setModels(const std::vector<QMatrix4x4> &models, float radius);
+
+    // Rebuilds order() and, when it changed, renderList(); returns true in that case,
+    // e.g. to re-upload instance data
+    bool update(const QMatrix4x4 &view, const QMatrix4x4 &projection);
+    const std::vector<int> &order() const noexcept { return m_order; }
+    const RenderList &renderList() const noexcept { return m_renderList; }
+
+    // The model whose bounding box the ray hits first or -1
+    int pick(const QVector3D &origin, const QVector3D &direction) const;
+
+    // Uses the depth-only program with color writes disabled, draw the models with the returned
+    // program and depthModelLocation(), the instanced path reads the same attributes as the
+    // examples' vertex shaders: position at 0 and the instance model matrix at 3
+    QOpenGLShaderProgram *beginDepthPrePass(const QMatrix4x4 &view, const QMatrix4x4 &projection,
+                                            bool instanced);
+    void endDepthPrePass();
+    int depthModelLocation() const noexcept { return m_modelLocation; }
+    // e.g. to draw instanced meshes in a pre-pass that started without instancing
+    int depthInstancedLocation() const noexcept { return m_instancedLocation; }
+
+    // Wrap the main pass, sets up the depth test for the pre-pass and counts the fragments
+    void beginMainPass();
+    void endMainPass();
+
+    Overdraw overdraw() const noexcept;
+
+private:
+    struct Query
+    {
+        GLuint id {0};
+        qint64 pixels {0};
+        bool pending {false};
+    };
+
+    int taskCount(int objects) const noexcept;
+    template<typename Function>
+    void parallelFor(int tasks, Function function);
+
+    void collect(Query &query);
+    void report();
+
+private:
+    QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
+    StateCache *m_state {nullptr};
+    Culling m_culling {Culling::None};
+    bool m_sorted {false};
+    bool m_depthPrePass {false};
+    bool m_overdrawEnabled {false};
+    int m_threadCount {1};
+    QThreadPool m_pool;
+
+    std::vector<QMatrix4x4> m_models;
+    std::vector<QVector4D> m_spheres;
+    std::unique_ptr<FrustumCuller> m_culler;
+    std::unique_ptr<Bvh> m_bvh;
+    std::vector<int> m_candidates;
+    std::vector<std::vector<int>> m_runs;
+    std::vector<std::vector<quint64>> m_sortKeys;
+    std::vector<std::vector<quint64>> m_sortScratch;
+    std::vector<size_t> m_runBounds;
+    std::vector<int> m_order;
+    std::vector<int> m_previousOrder;
+    std::vector<float> m_depths;
+    RenderList m_renderList;
+
+    std::unique_ptr<QOpenGLShaderProgram> m_depthProgram;
+    int m_viewLocation {-1};
+    int m_projectionLocation {-1};
+    int m_modelLocation {-1};
+    int m_instancedLocation {-1};
+
+    std::array<Query, 2> m_queries;
+    int m_frameIndex {0};
+    bool m_reportPending {false};
+    QString m_statisticsMode;
+    int m_frames {0};
+    qint64 m_fragments {0};
+    qint64 m_pixels {0};
+};
+
+#endif // RENDERQUEUE_H
@@ -0,0 +1,93 @@
+#include "scenegraph.h"
+
+#include <algorithm>
+
+void SceneGraph::reserve(int count)
+{
+    const auto size = size_t(count);
+    m_parents.reserve(size);
+    m_translations.reserve(size);
+    m_rotations.reserve(size);
+    m_scales.reserve(size);
+    m_localMatrices.reserve(size);
+    m_worldMatrices.reserve(size);
+    m_dirty.reserve(size);
+}
+
+SceneGraph::Node SceneGraph::addNode(Node parent, const QVector3D &translation,
+                                     const QQuaternion &rotation, const QVector3D &scale)
+{
+    Q_ASSERT(parent < count());
+    const auto node = count();
+    m_parents.push_back(parent);
+    m_translations.push_back(translation);
+    m_rotations.push_back(rotation);
+    m_scales.push_back(scale);
+    m_localMatrices.emplace_back();
+    m_worldMatrices.emplace_back();
+    m_dirty.push_back(Clean);
+    markDirty(node);
+    return node;
+}
+
+void SceneGraph::setTranslation(Node node, const QVector3D &translation)
+{
+    m_translations[size_t(node)] = translation;
+    markDirty(node);
+}
+
+void SceneGraph::setRotation(Node node, const QQuaternion &rotation)
+{
+    m_rotations[size_t(node)] = rotation;
+    markDirty(node);
+}
+
+void SceneGraph::setScale(Node node, const QVector3D &scale)
+{
+    m_scales[size_t(node)] = scale;
+    markDirty(node);
+}
+
+int SceneGraph::update()
+{
+    const auto end = count();
+    if (m_firstDirty >= end)
+        return 0;
+
+    // parents precede their children, so a parent's flag is final when its children are visited;
+    // the flags are cleared afterwards so the children can see which parents were recomputed
+    int updated = 0;
+    for (auto i = size_t(m_firstDirty); i < size_t(end); ++i) {
+        auto dirty = m_dirty[i];
+        const auto parent = m_parents[i];
+        if (parent >= 0 && m_dirty[size_t(parent)] != Clean)
+            dirty |= WorldDirty;
+        if (dirty == Clean)
+            continue;
+        m_dirty[i] = dirty;
+
+        if (dirty & LocalDirty) {
+            auto &local = m_localMatrices[i];
+            local.setToIdentity();
+            local.translate(m_translations[i]);
+            local.rotate(m_rotations[i]);
+            local.scale(m_scales[i]);
+        }
+
+        m_worldMatrices[i] = parent >= 0
+                ? m_worldMatrices[size_t(parent)] * m_localMatrices[i]
+                : m_localMatrices[i];
+        ++updated;
+    }
+
+    std::fill(m_dirty.begin() + m_firstDirty, m_dirty.end(), quint8(Clean));
+    m_firstDirty = end;
+    ++m_revision;
+    return updated;
+}
+
+void SceneGraph::markDirty(Node node)
+{
+    m_dirty[size_t(node)] |= LocalDirty;
+    m_firstDirty = std::min(m_firstDirty, node);
+}
@@ -0,0 +1,70 @@
+#ifndef SCENEGRAPH_H
+#define SCENEGRAPH_H
+
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QQuaternion>
+#include <QtGui/QVector3D>
+
+#include <vector>
+
+// Transform hierarchy with cached world matrices. Nodes live in parallel arrays (one per
+// component) in creation order and a parent is always created before its children, so update()
+// is a single forward pass over the nodes changed since the previous update(). A static scene
+// costs nothing per frame: update() returns before touching any matrix.
+class SceneGraph
+{
+public:
+    using Node = int;
+
+    SceneGraph() = default;
+
+    void reserve(int count);
+
+    // parent must be an existing node or -1 for a root
+    Node addNode(Node parent = -1, const QVector3D &translation = {},
+                 const QQuaternion &rotation = {}, const QVector3D &scale = {1.0f, 1.0f, 1.0f});
+
+    int count() const noexcept { return int(m_parents.size()); }
+    Node parent(Node node) const { return m_parents[size_t(node)]; }
+
+    const QVector3D &translation(Node node) const { return m_translations[size_t(node)]; }
+    const QQuaternion &rotation(Node node) const { return m_rotations[size_t(node)]; }
+    const QVector3D &scale(Node node) const { return m_scales[size_t(node)]; }
+
+    void setTranslation(Node node, const QVector3D &translation);
+    void setRotation(Node node, const QQuaternion &rotation);
+    void setScale(Node node, const QVector3D &scale);
+
+    // Recomputes the world matrices of the changed nodes and their descendants,
+    // returns the number of recomputed matrices
+    int update();
+
+    // Valid after update(), indexed by node
+    const QMatrix4x4 &worldMatrix(Node node) const { return m_worldMatrices[size_t(node)]; }
+    const std::vector<QMatrix4x4> &worldMatrices() const noexcept { return m_worldMatrices; }
+
+    // Increased by every update() that recomputed something, compare to skip refreshing GPU copies
+    quint64 revision() const noexcept { return m_revision; }
+
+private:
+    enum Dirty : quint8 {
+        Clean = 0,
+        LocalDirty = 1, // translation, rotation or scale changed
+        WorldDirty = 2  // only the parent's world matrix changed
+    };
+
+    void markDirty(Node node);
+
+private:
+    std::vector<Node> m_parents;
+    std::vector<QVector3D> m_translations;
+    std::vector<QQuaternion> m_rotations;
+    std::vector<QVector3D> m_scales;
+    std::vector<QMatrix4x4> m_localMatrices;
+    std::vector<QMatrix4x4> m_worldMatrices;
+    std::vector<quint8> m_dirty;
+    Node m_firstDirty {0};
+    quint64 m_revision {0};
+};
+
+#endif // SCENEGRAPH_H
@@ -0,0 +1,169 @@
+#include "programcache.h"
+
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QtEndian>
+
+#include <algorithm>
+#include <vector>
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+namespace {
+
+constexpr char magic[4] = {'L', 'O', 'P', 'B'};
+constexpr int headerSize = 8; // magic + binary format
+
+bool isSupported(QOpenGLContext *context)
+{
+    const auto version = context->format().version();
+    if (version < qMakePair(4, 1) && !context->hasExtension(QByteArrayLiteral("GL_ARB_get_program_binary")))
+        return false;
+
+    GLint formats = 0;
+    context->functions()->glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+QByteArray cacheKey(QOpenGLContext *context, const std::vector<QByteArray> &sources)
+{
+    const auto funcs = context->functions();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const auto name: {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        const auto string = funcs->glGetString(GLenum(name));
+        hash.addData(QByteArray(string ? reinterpret_cast<const char *>(string) : ""));
+        hash.addData(QByteArrayLiteral("\n"));
+    }
+    for (const auto &source: sources) {
+        hash.addData(source);
+        hash.addData(QByteArrayLiteral("\n"));
+    }
+    return hash.result().toHex();
+}
+
+QString describe(std::initializer_list<ProgramCache::Shader> shaders)
+{
+    QStringList fileNames;
+    for (const auto &shader: shaders)
+        fileNames.append(shader.fileName);
+    return fileNames.join(QStringLiteral(" + "));
+}
+
+bool loadBinary(QOpenGLShaderProgram *program, const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const auto data = file.readAll();
+    if (data.size() <= headerSize || !data.startsWith(QByteArray(magic, sizeof(magic))))
+        return false;
+
+    const auto format = qFromLittleEndian<quint32>(data.constData() + sizeof(magic));
+    const auto funcs = QOpenGLContext::currentContext()->extraFunctions();
+    funcs->glProgramBinary(program->programId(), GLenum(format), data.constData() + headerSize,
+                           GLsizei(data.size() - headerSize));
+
+    // a binary from another driver build is rejected here, not treated as an error
+    GLint status = GL_FALSE;
+    funcs->glGetProgramiv(program->programId(), GL_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+        return false;
+
+    // with no shaders attached link() only picks up the link status
+    return program->link();
+}
+
+void saveBinary(QOpenGLShaderProgram *program, const QString &fileName)
+{
+    const auto funcs = QOpenGLContext::currentContext()->extraFunctions();
+    GLint length = 0;
+    funcs->glGetProgramiv(program->programId(), GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    QByteArray data(headerSize + length, Qt::Uninitialized);
+    GLenum format = 0;
+    funcs->glGetProgramBinary(program->programId(), length, nullptr, &format, data.data() + headerSize);
+    std::copy(magic, magic + sizeof(magic), data.begin());
+    qToLittleEndian(quint32(format), data.data() + sizeof(magic));
+
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit())
+        qWarning() << "Can't write program binary" << fileName << ":" << file.errorString();
+}
+
+} // namespace
+
+bool ProgramCache::link(QOpenGLShaderProgram *program, std::initializer_list<Shader> shaders)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    std::vector<QByteArray> sources;
+    sources.reserve(shaders.size());
+    for (const auto &shader: shaders) {
+        QFile file(shader.fileName);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "Can't open shader" << shader.fileName << ":" << file.errorString();
+            return false;
+        }
+        sources.push_back(file.readAll());
+    }
+
+    const auto context = QOpenGLContext::currentContext();
+    const bool cacheable = isSupported(context);
+    QString fileName;
+    if (cacheable) {
+        fileName = cacheDirectory() + QLatin1Char('/') + QString::fromLatin1(cacheKey(context, sources));
+        program->create();
+        if (QFile::exists(fileName) && loadBinary(program, fileName)) {
+            qDebug().noquote() << QStringLiteral("Program %1 loaded from cache in %2 ms")
+                                  .arg(describe(shaders)).arg(timer.nsecsElapsed() / 1e6, 0, 'f', 2);
+            return true;
+        }
+        context->extraFunctions()->glProgramParameteri(program->programId(),
+                                                       GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    auto shader = shaders.begin();
+    for (const auto &source: sources) {
+        if (!program->addShaderFromSourceCode(shader->type, source))
+            return false;
+        ++shader;
+    }
+    if (!program->link())
+        return false;
+
+    if (cacheable)
+        saveBinary(program, fileName);
+
+    qDebug().noquote() << QStringLiteral("Program %1 compiled in %2 ms%3")
+                          .arg(describe(shaders)).arg(timer.nsecsElapsed() / 1e6, 0, 'f', 2)
+                          .arg(cacheable ? QString() : QStringLiteral(" (program binaries are not supported)"));
+    return true;
+}
+
+QString ProgramCache::cacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/programs");
+}
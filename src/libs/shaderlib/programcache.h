@@ -0,0 +1,30 @@
+#ifndef PROGRAMCACHE_H
+#define PROGRAMCACHE_H
+
+#include <QOpenGLShader>
+
+#include <QtCore/QString>
+
+#include <initializer_list>
+
+class QOpenGLShaderProgram;
+
+// Links programs from shader files, keeping the linked binary (glGetProgramBinary) in the
+// cache directory for the next run. The binary is keyed by the hash of the sources and the
+// GL vendor/renderer/version strings, when the driver rejects it the program is compiled
+// from the sources as usual. Time spent on every program is printed with qDebug().
+class ProgramCache
+{
+public:
+    struct Shader
+    {
+        QOpenGLShader::ShaderType type;
+        QString fileName;
+    };
+
+    static bool link(QOpenGLShaderProgram *program, std::initializer_list<Shader> shaders);
+
+    static QString cacheDirectory();
+};
+
+#endif // PROGRAMCACHE_H
@@ -0,0 +1,170 @@
+#include "examplescene.h"
+
+#include <QtCore/QDebug>
+
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+
+namespace {
+
+using Example = ExampleScene::Example;
+
+const char *exampleNames[] = {"5.1.direct_light", "5.2.point_light", "5.3.spot_light", "6.multiple_lights"};
+
+constexpr float vertices[] = {
+    // positions          // normals           // texture coords
+    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
+     0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
+
+    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
+
+    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+
+     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+
+    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 0.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
+
+    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
+};
+
+constexpr int vertexCount = int(std::extent<decltype(vertices)>::value) / 8;
+
+// the examples' Camera before any input
+constexpr QVector3D cameraPosition {0.0f, 0.0f, 3.0f};
+constexpr QVector3D cameraFront {0.0f, 0.0f, -1.0f};
+
+// the lamp of the 5.x examples
+constexpr QVector3D lightPos {1.2f, 1.0f, 2.0f};
+
+constexpr QVector3D pointLightPositions[] = {
+    { 0.7f,  0.2f,  2.0f},
+    { 2.3f, -3.3f, -4.0f},
+    {-4.0f,  2.0f, -12.0f},
+    { 0.0f,  0.0f, -3.0f}
+};
+
+SoftRasterizer::Lights lights(Example example)
+{
+    SoftRasterizer::Lights result;
+    if (example == Example::DirectLight || example == Example::MultipleLights) {
+        SoftRasterizer::DirectionalLight light;
+        light.direction = {-0.2f, -1.0f, -0.3f};
+        result.directional.push_back(light);
+    }
+    if (example == Example::PointLight) {
+        SoftRasterizer::PointLight light;
+        light.position = lightPos;
+        result.point.push_back(light);
+    }
+    if (example == Example::MultipleLights) {
+        for (const auto &position: pointLightPositions) {
+            SoftRasterizer::PointLight light;
+            light.position = position;
+            result.point.push_back(light);
+        }
+    }
+    if (example == Example::SpotLight || example == Example::MultipleLights) {
+        SoftRasterizer::SpotLight light;
+        light.position = cameraPosition;
+        light.direction = cameraFront;
+        result.spot.push_back(light);
+    }
+    return result;
+}
+
+std::vector<QMatrix4x4> lampModels(Example example)
+{
+    std::vector<QMatrix4x4> result;
+    const auto addLamp = [&result](const QVector3D &position) {
+        QMatrix4x4 model;
+        model.translate(position);
+        model.scale({0.2f, 0.2f, 0.2f});
+        result.push_back(model);
+    };
+    if (example == Example::MultipleLights) {
+        for (const auto &position: pointLightPositions)
+            addLamp(position);
+    } else {
+        addLamp(lightPos);
+    }
+    return result;
+}
+
+} // namespace
+
+QStringList ExampleScene::names()
+{
+    QStringList result;
+    for (const auto name: exampleNames)
+        result.append(QLatin1String(name));
+    return result;
+}
+
+bool ExampleScene::fromName(const QString &name, Example *example)
+{
+    const auto found = std::find_if(std::begin(exampleNames), std::end(exampleNames),
+                                    [&name](const char *exampleName) { return name == QLatin1String(exampleName); });
+    if (found == std::end(exampleNames))
+        return false;
+    *example = Example(found - std::begin(exampleNames));
+    return true;
+}
+
+bool ExampleScene::setup(SoftRasterizer *rasterizer)
+{
+    QMatrix4x4 view;
+    view.lookAt(cameraPosition, cameraPosition + cameraFront, {0.0f, 1.0f, 0.0f});
+    QMatrix4x4 projection;
+    projection.perspective(45.0f, float(rasterizer->size().width()) / rasterizer->size().height(), 0.1f, 100.0f);
+    rasterizer->setCamera(view, projection, cameraPosition);
+    rasterizer->setLights(lights(m_example));
+
+    SoftRasterizer::Material container;
+    container.diffuse = QImage(QStringLiteral(":/container2.png"));
+    container.specular = QImage(QStringLiteral(":/container2_specular.png"));
+    if (container.diffuse.isNull() || container.specular.isNull()) {
+        qCritical() << "Can't load the container textures";
+        return false;
+    }
+    m_containerMaterial = rasterizer->addMaterial(container);
+    // flamp.glsl
+    m_lampMaterial = rasterizer->addMaterial({});
+    return true;
+}
+
+void ExampleScene::draw(SoftRasterizer *rasterizer, const std::vector<QMatrix4x4> &cubeModels) const
+{
+    Q_ASSERT(m_containerMaterial >= 0);
+    rasterizer->draw(vertices, vertexCount, cubeModels, m_containerMaterial);
+    rasterizer->draw(vertices, vertexCount, lampModels(m_example), m_lampMaterial);
+}
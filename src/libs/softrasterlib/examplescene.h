@@ -0,0 +1,45 @@
+#ifndef EXAMPLESCENE_H
+#define EXAMPLESCENE_H
+
+#include "softrasterizer.h"
+
+#include <QtCore/QStringList>
+
+#include <vector>
+
+// The first frame of a lighting example before any input as SoftRasterizer draws it: the
+// examples' camera, lights, container cubes and lamps. softrender and the golden image test
+// share it, so the test checks exactly what softrender writes as a reference.
+class ExampleScene
+{
+public:
+    enum class Example {
+        DirectLight,
+        PointLight,
+        SpotLight,
+        MultipleLights
+    };
+
+    // "5.1.direct_light", "5.2.point_light", "5.3.spot_light" and "6.multiple_lights"
+    static QStringList names();
+    // Returns false for an unknown name
+    static bool fromName(const QString &name, Example *example);
+
+    explicit ExampleScene(Example example) noexcept : m_example(example) {}
+
+    Example example() const noexcept { return m_example; }
+
+    // Sets the camera for the rasterizer's size and the lights, and adds the materials.
+    // Returns false if the container textures (":/container2.png" and
+    // ":/container2_specular.png") can't be loaded.
+    bool setup(SoftRasterizer *rasterizer);
+    // Queues the cubes with the given models and the lamps
+    void draw(SoftRasterizer *rasterizer, const std::vector<QMatrix4x4> &cubeModels) const;
+
+private:
+    Example m_example {Example::MultipleLights};
+    int m_containerMaterial {-1};
+    int m_lampMaterial {-1};
+};
+
+#endif // EXAMPLESCENE_H
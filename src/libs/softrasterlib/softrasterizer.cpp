@@ -0,0 +1,724 @@
+#include "softrasterizer.h"
+
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if (defined(__SSE2__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+#define SOFTRASTERIZER_AVX2
+#define SOFTRASTERIZER_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr int subpixelBits = 4;
+constexpr int fixedOne = 1 << subpixelBits;
+constexpr int fixedHalf = fixedOne / 2;
+constexpr int lanes = 8;
+constexpr int vertexFloats = 8;
+constexpr int maxClippedVertices = 9;
+
+// signed distance to the clip planes -w <= x, y, z <= w
+float planeDistance(const QVector4D &clip, int plane)
+{
+    const auto value = clip[plane / 2];
+    return plane % 2 ? clip.w() - value : clip.w() + value;
+}
+
+int outcode(const QVector4D &clip)
+{
+    int result = 0;
+    for (int plane = 0; plane < 6; ++plane) {
+        if (planeDistance(clip, plane) < 0.0f)
+            result |= 1 << plane;
+    }
+    return result;
+}
+
+// Sutherland-Hodgman against the planes in outcodes, returns the vertex count
+template<typename V>
+int clipPolygon(V *polygon, int count, int outcodes, V *scratch)
+{
+    for (int plane = 0; plane < 6 && count >= 3; ++plane) {
+        if (!(outcodes & (1 << plane)))
+            continue;
+
+        int clippedCount = 0;
+        for (int i = 0; i < count; ++i) {
+            const auto &current = polygon[i];
+            const auto &next = polygon[(i + 1) % count];
+            const auto currentDistance = planeDistance(current.clip, plane);
+            const auto nextDistance = planeDistance(next.clip, plane);
+            if (currentDistance >= 0.0f)
+                scratch[clippedCount++] = current;
+            if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f)) {
+                const auto t = currentDistance / (currentDistance - nextDistance);
+                auto &vertex = scratch[clippedCount++];
+                vertex.clip = current.clip + (next.clip - current.clip) * t;
+                for (int k = 0; k < vertexFloats; ++k)
+                    vertex.attributes[k] = current.attributes[k] + (next.attributes[k] - current.attributes[k]) * t;
+            }
+        }
+        std::copy(scratch, scratch + clippedCount, polygon);
+        count = clippedCount;
+    }
+    return count;
+}
+
+// Edge values at the first pixel of a rectangle and their steps per pixel, an edge that covers
+// the whole rectangle gets zeros. Returns false if an edge covers none of it.
+template<typename Triangle>
+bool setupEdges(const Triangle &triangle, int x0, int y0, int x1, int y1,
+                int *values, int *stepsX, int *stepsY) noexcept
+{
+    const auto left = std::int64_t(x0) * fixedOne + fixedHalf;
+    const auto top = std::int64_t(y0) * fixedOne + fixedHalf;
+    const auto right = std::int64_t(x1) * fixedOne + fixedHalf;
+    const auto bottom = std::int64_t(y1) * fixedOne + fixedHalf;
+    for (int edge = 0; edge < 3; ++edge) {
+        const auto a = std::int64_t(triangle.a[edge]);
+        const auto b = std::int64_t(triangle.b[edge]);
+        const auto c = triangle.c[edge];
+        const std::int64_t corners[] = {
+            a * left + b * top + c,
+            a * right + b * top + c,
+            a * left + b * bottom + c,
+            a * right + b * bottom + c
+        };
+        const auto range = std::minmax_element(std::begin(corners), std::end(corners));
+        if (*range.second < 0)
+            return false;
+        if (*range.first >= 0) {
+            values[edge] = 0;
+            stepsX[edge] = 0;
+            stepsY[edge] = 0;
+        } else {
+            // the edge crosses the rectangle, so the values are bounded by its size
+            values[edge] = int(corners[0]);
+            stepsX[edge] = triangle.a[edge] * fixedOne;
+            stepsY[edge] = triangle.b[edge] * fixedOne;
+        }
+    }
+    return true;
+}
+
+float dot(const float *lhs, const float *rhs)
+{
+    return lhs[0] * rhs[0] + lhs[1] * rhs[1] + lhs[2] * rhs[2];
+}
+
+void normalize(float *vector)
+{
+    const auto length = std::sqrt(dot(vector, vector));
+    if (length > 0.0f) {
+        vector[0] /= length;
+        vector[1] /= length;
+        vector[2] /= length;
+    }
+}
+
+// 8 shaded pixels in structure of arrays form
+struct Fragments
+{
+    float position[3][lanes];
+    float normal[3][lanes];
+    float viewDir[3][lanes];
+    float diffuse[3][lanes];
+    float specular[3][lanes];
+    float shininess[lanes];
+    float result[3][lanes];
+};
+
+// light * (ambient * diffuse map + diff * diffuse * diffuse map + spec * specular * specular map)
+void accumulate(Fragments &fragments, int lane, const QVector3D &ambient, const QVector3D &diffuse,
+                const QVector3D &specular, float diff, float spec, float scale)
+{
+    for (int c = 0; c < 3; ++c) {
+        fragments.result[c][lane] += (ambient[c] * fragments.diffuse[c][lane]
+                                      + diffuse[c] * diff * fragments.diffuse[c][lane]
+                                      + specular[c] * spec * fragments.specular[c][lane]) * scale;
+    }
+}
+
+// max(dot(normal, lightDir), 0) and pow(max(dot(viewDir, reflect(-lightDir, normal)), 0), shininess)
+void phong(const Fragments &fragments, int lane, const float *lightDir, float &diff, float &spec)
+{
+    const float normal[] = {fragments.normal[0][lane], fragments.normal[1][lane], fragments.normal[2][lane]};
+    const float viewDir[] = {fragments.viewDir[0][lane], fragments.viewDir[1][lane], fragments.viewDir[2][lane]};
+    const auto normalDotLight = dot(normal, lightDir);
+    diff = std::max(normalDotLight, 0.0f);
+    float reflectDir[3];
+    for (int c = 0; c < 3; ++c)
+        reflectDir[c] = 2.0f * normalDotLight * normal[c] - lightDir[c];
+    spec = std::pow(std::max(dot(viewDir, reflectDir), 0.0f), fragments.shininess[lane]);
+}
+
+} // namespace
+
+void SoftRasterizer::Texture::load(const QImage &image)
+{
+    if (image.isNull()) {
+        width = height = 0;
+        texels.clear();
+        return;
+    }
+
+    const auto converted = image.convertToFormat(QImage::Format_RGB32);
+    width = converted.width();
+    height = converted.height();
+    texels.resize(size_t(width) * size_t(height) * 3);
+    auto out = texels.begin();
+    for (int y = height - 1; y >= 0; --y) {
+        const auto line = reinterpret_cast<const QRgb *>(converted.constScanLine(y));
+        for (int x = 0; x < width; ++x) {
+            *out++ = qRed(line[x]) / 255.0f;
+            *out++ = qGreen(line[x]) / 255.0f;
+            *out++ = qBlue(line[x]) / 255.0f;
+        }
+    }
+}
+
+void SoftRasterizer::Texture::sample(float u, float v, float *rgb) const noexcept
+{
+    if (!width) {
+        std::fill(rgb, rgb + 3, 0.0f);
+        return;
+    }
+
+    const auto x = u * width - 0.5f;
+    const auto y = v * height - 0.5f;
+    const auto left = std::floor(x);
+    const auto top = std::floor(y);
+    const auto fx = x - left;
+    const auto fy = y - top;
+    // GL_REPEAT
+    const auto wrap = [](int value, int size) {
+        value %= size;
+        return value < 0 ? value + size : value;
+    };
+    const auto x0 = wrap(int(left), width);
+    const auto x1 = wrap(int(left) + 1, width);
+    const auto y0 = wrap(int(top), height);
+    const auto y1 = wrap(int(top) + 1, height);
+    const auto texel = [this](int x, int y) { return texels.data() + (size_t(y) * size_t(width) + size_t(x)) * 3; };
+    const auto t00 = texel(x0, y0);
+    const auto t10 = texel(x1, y0);
+    const auto t01 = texel(x0, y1);
+    const auto t11 = texel(x1, y1);
+    for (int c = 0; c < 3; ++c) {
+        const auto row0 = t00[c] + (t10[c] - t00[c]) * fx;
+        const auto row1 = t01[c] + (t11[c] - t01[c]) * fx;
+        rgb[c] = row0 + (row1 - row0) * fy;
+    }
+}
+
+SoftRasterizer::SoftRasterizer(const QStringList &arguments)
+{
+    auto threadCount = QThread::idealThreadCount();
+    for (int i = 1; i < arguments.size(); ++i) {
+        if (arguments.at(i) == QLatin1String("--threads") && i + 1 < arguments.size())
+            threadCount = arguments.at(++i).toInt();
+        else if (arguments.at(i) == QLatin1String("--no-simd"))
+            m_instructions = Instructions::Scalar;
+    }
+    setThreadCount(threadCount);
+}
+
+SoftRasterizer::~SoftRasterizer() = default;
+
+SoftRasterizer::Instructions SoftRasterizer::bestInstructions() noexcept
+{
+#if defined(SOFTRASTERIZER_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return Instructions::Avx2;
+#endif
+    return Instructions::Scalar;
+}
+
+void SoftRasterizer::setInstructions(Instructions instructions) noexcept
+{
+    m_instructions = std::min(instructions, bestInstructions());
+}
+
+void SoftRasterizer::setThreadCount(int count)
+{
+    m_threadCount = std::max(1, count);
+    // the calling thread takes the first task
+    m_pool.setMaxThreadCount(std::max(1, m_threadCount - 1));
+}
+
+void SoftRasterizer::resize(const QSize &size)
+{
+    m_size = size.boundedTo({MaxSize, MaxSize}).expandedTo({1, 1});
+}
+
+void SoftRasterizer::setCamera(const QMatrix4x4 &view, const QMatrix4x4 &projection, const QVector3D &position)
+{
+    m_viewProjection = projection * view;
+    m_viewPos = position;
+}
+
+int SoftRasterizer::addMaterial(const Material &material)
+{
+    MaterialData data;
+    data.diffuse.load(material.diffuse);
+    data.specular.load(material.specular);
+    data.shininess = material.shininess;
+    data.color = material.color;
+    data.flat = material.diffuse.isNull();
+    m_materials.push_back(std::move(data));
+    return int(m_materials.size()) - 1;
+}
+
+void SoftRasterizer::draw(const float *vertices, int vertexCount, const std::vector<QMatrix4x4> &models,
+                          int material)
+{
+    Q_ASSERT(material >= 0 && material < int(m_materials.size()));
+    m_draws.push_back({vertices, vertexCount, models, material});
+}
+
+// Runs function(task) for every task in [0, tasks) and waits for all of them,
+// the calling thread runs the first one
+template<typename Function>
+void SoftRasterizer::parallelFor(int tasks, Function function)
+{
+    if (tasks == 1) {
+        function(0);
+        return;
+    }
+
+    QSemaphore done;
+    for (int task = 1; task < tasks; ++task) {
+        m_pool.start([&function, &done, task]() {
+            function(task);
+            done.release();
+        });
+    }
+    function(0);
+    done.acquire(tasks - 1);
+}
+
+QImage SoftRasterizer::render()
+{
+    QImage image(m_size, QImage::Format_RGB32);
+
+    // transform and clip, every task takes a contiguous range of instances
+    int instanceCount = 0;
+    for (const auto &draw: m_draws)
+        instanceCount += int(draw.models.size());
+    const auto geometryTasks = std::max(1, std::min(m_threadCount, instanceCount));
+    m_taskTriangles.resize(size_t(geometryTasks));
+    parallelFor(geometryTasks, [&](int task) {
+        const auto begin = int(qint64(instanceCount) * task / geometryTasks);
+        const auto end = int(qint64(instanceCount) * (task + 1) / geometryTasks);
+        auto &triangles = m_taskTriangles[size_t(task)];
+        triangles.clear();
+        int offset = 0;
+        for (const auto &draw: m_draws) {
+            const auto count = int(draw.models.size());
+            const auto first = std::max(begin - offset, 0);
+            const auto last = std::min(end - offset, count);
+            if (first < last)
+                processGeometry(draw, first, last, triangles);
+            offset += count;
+        }
+    });
+    m_triangles.clear();
+    for (const auto &triangles: m_taskTriangles)
+        m_triangles.insert(m_triangles.end(), triangles.begin(), triangles.end());
+
+    // bin in submission order
+    m_tilesX = (m_size.width() + TileSize - 1) / TileSize;
+    m_tilesY = (m_size.height() + TileSize - 1) / TileSize;
+    const auto tileCount = m_tilesX * m_tilesY;
+    m_bins.resize(size_t(tileCount));
+    for (auto &bin: m_bins)
+        bin.clear();
+    for (int i = 0; i < int(m_triangles.size()); ++i) {
+        const auto &triangle = m_triangles[size_t(i)];
+        for (int tileY = triangle.minY / TileSize; tileY <= triangle.maxY / TileSize; ++tileY) {
+            for (int tileX = triangle.minX / TileSize; tileX <= triangle.maxX / TileSize; ++tileX)
+                m_bins[size_t(tileY * m_tilesX + tileX)].push_back(i);
+        }
+    }
+
+    const auto bits = image.bits();
+    const auto bytesPerLine = image.bytesPerLine();
+    std::atomic<int> nextTile {0};
+    parallelFor(std::min(m_threadCount, tileCount), [&](int) {
+        std::vector<float> depth(size_t(TileSize * TileSize));
+        std::vector<int> ids(size_t(TileSize * TileSize));
+        for (int tile = nextTile++; tile < tileCount; tile = nextTile++)
+            rasterizeTile(tile, depth.data(), ids.data(), bits, bytesPerLine);
+    });
+
+    m_draws.clear();
+    return image;
+}
+
+void SoftRasterizer::processGeometry(const Draw &draw, int firstInstance, int lastInstance,
+                                     std::vector<Triangle> &triangles) const
+{
+    Vertex polygon[maxClippedVertices];
+    Vertex scratch[maxClippedVertices];
+    for (int instance = firstInstance; instance < lastInstance; ++instance) {
+        const auto &model = draw.models[size_t(instance)];
+        const auto normalMatrix = model.normalMatrix();
+        const auto modelViewProjection = m_viewProjection * model;
+
+        for (int first = 0; first + 2 < draw.vertexCount; first += 3) {
+            int outcodes = 0;
+            int inside = ~0;
+            for (int i = 0; i < 3; ++i) {
+                const auto source = draw.vertices + (first + i) * vertexFloats;
+                const QVector3D position(source[0], source[1], source[2]);
+                auto &vertex = polygon[i];
+                vertex.clip = modelViewProjection * QVector4D(position, 1.0f);
+                const auto worldPosition = model.map(position);
+                for (int c = 0; c < 3; ++c) {
+                    vertex.attributes[c] = worldPosition[c];
+                    vertex.attributes[3 + c] = normalMatrix(c, 0) * source[3] + normalMatrix(c, 1) * source[4]
+                            + normalMatrix(c, 2) * source[5];
+                }
+                vertex.attributes[6] = source[6];
+                vertex.attributes[7] = source[7];
+
+                const auto code = outcode(vertex.clip);
+                outcodes |= code;
+                inside &= code;
+            }
+            if (inside)
+                continue;
+
+            const auto count = outcodes ? clipPolygon(polygon, 3, outcodes, scratch) : 3;
+            for (int i = 2; i < count; ++i)
+                setupTriangle(polygon[0], polygon[i - 1], polygon[i], draw.material, triangles);
+        }
+    }
+}
+
+void SoftRasterizer::setupTriangle(const Vertex &v0, const Vertex &v1, const Vertex &v2, int material,
+                                   std::vector<Triangle> &triangles) const
+{
+    const Vertex *vertices[] = {&v0, &v1, &v2};
+    int x[3];
+    int y[3];
+    float z[3];
+    float inverseW[3];
+    for (int i = 0; i < 3; ++i) {
+        const auto &clip = vertices[i]->clip;
+        inverseW[i] = 1.0f / clip.w();
+        // window coordinates with y pointing down like the image
+        const auto windowX = (clip.x() * inverseW[i] * 0.5f + 0.5f) * m_size.width();
+        const auto windowY = (0.5f - clip.y() * inverseW[i] * 0.5f) * m_size.height();
+        x[i] = int(std::lround(windowX * fixedOne));
+        y[i] = int(std::lround(windowY * fixedOne));
+        z[i] = clip.z() * inverseW[i] * 0.5f + 0.5f;
+    }
+
+    // nothing is culled, like in the examples, so both windings are made positive
+    auto area = std::int64_t(x[1] - x[0]) * (y[2] - y[0]) - std::int64_t(y[1] - y[0]) * (x[2] - x[0]);
+    if (area == 0)
+        return;
+    if (area < 0) {
+        std::swap(vertices[1], vertices[2]);
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(z[1], z[2]);
+        std::swap(inverseW[1], inverseW[2]);
+    }
+
+    Triangle triangle;
+    const auto minX = *std::min_element(x, x + 3);
+    const auto minY = *std::min_element(y, y + 3);
+    const auto maxX = *std::max_element(x, x + 3);
+    const auto maxY = *std::max_element(y, y + 3);
+    // pixels whose centers are inside the bounds
+    triangle.minX = std::max((minX - fixedHalf + fixedOne - 1) >> subpixelBits, 0);
+    triangle.minY = std::max((minY - fixedHalf + fixedOne - 1) >> subpixelBits, 0);
+    triangle.maxX = std::min((maxX - fixedHalf) >> subpixelBits, m_size.width() - 1);
+    triangle.maxY = std::min((maxY - fixedHalf) >> subpixelBits, m_size.height() - 1);
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+        return;
+
+    for (int edge = 0; edge < 3; ++edge) {
+        const auto from = edge;
+        const auto to = (edge + 1) % 3;
+        const auto dx = x[to] - x[from];
+        const auto dy = y[to] - y[from];
+        triangle.a[edge] = -dy;
+        triangle.b[edge] = dx;
+        // a shared edge runs the other way in the neighbour, so exactly one of them owns it
+        const auto owned = dy < 0 || (dy == 0 && dx > 0);
+        triangle.c[edge] = -(std::int64_t(triangle.a[edge]) * x[from] + std::int64_t(triangle.b[edge]) * y[from])
+                - (owned ? 0 : 1);
+    }
+
+    triangle.originX = float(x[0]) / fixedOne;
+    triangle.originY = float(y[0]) / fixedOne;
+    const auto ex1 = float(x[1] - x[0]) / fixedOne;
+    const auto ey1 = float(y[1] - y[0]) / fixedOne;
+    const auto ex2 = float(x[2] - x[0]) / fixedOne;
+    const auto ey2 = float(y[2] - y[0]) / fixedOne;
+    const auto determinant = ex1 * ey2 - ex2 * ey1;
+    triangle.l1dx = ey2 / determinant;
+    triangle.l1dy = -ex2 / determinant;
+    triangle.l2dx = -ey1 / determinant;
+    triangle.l2dy = ex1 / determinant;
+    triangle.z0 = z[0];
+    triangle.dzdx = (z[1] - z[0]) * triangle.l1dx + (z[2] - z[0]) * triangle.l2dx;
+    triangle.dzdy = (z[1] - z[0]) * triangle.l1dy + (z[2] - z[0]) * triangle.l2dy;
+
+    for (int i = 0; i < 3; ++i) {
+        triangle.inverseW[i] = inverseW[i];
+        std::copy(vertices[i]->attributes, vertices[i]->attributes + vertexFloats, triangle.attributes[i]);
+    }
+    triangle.material = material;
+    triangles.push_back(triangle);
+}
+
+void SoftRasterizer::rasterizeTile(int tile, float *depth, int *ids, uchar *bits, int bytesPerLine) const
+{
+    const auto tileX = tile % m_tilesX * TileSize;
+    const auto tileY = tile / m_tilesX * TileSize;
+    const auto lastX = std::min(tileX + TileSize, m_size.width()) - 1;
+    const auto lastY = std::min(tileY + TileSize, m_size.height()) - 1;
+
+    std::fill(depth, depth + TileSize * TileSize, 1.0f);
+    std::fill(ids, ids + TileSize * TileSize, -1);
+    for (const auto id: m_bins[size_t(tile)]) {
+        const auto &triangle = m_triangles[size_t(id)];
+        const auto x0 = std::max(tileX, triangle.minX);
+        const auto y0 = std::max(tileY, triangle.minY);
+        const auto x1 = std::min(lastX, triangle.maxX);
+        const auto y1 = std::min(lastY, triangle.maxY);
+#ifdef SOFTRASTERIZER_AVX2
+        if (m_instructions == Instructions::Avx2) {
+            resolveVisibilityAvx2(triangle, id, x0, y0, x1, y1, tileX, tileY, depth, ids);
+            continue;
+        }
+#endif
+        resolveVisibility(triangle, id, x0, y0, x1, y1, tileX, tileY, depth, ids);
+    }
+
+    const auto toByte = [](float value) { return int(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f); };
+    const auto clearColor = qRgb(toByte(m_clearColor.x()), toByte(m_clearColor.y()), toByte(m_clearColor.z()));
+    int pixelX[lanes];
+    int pixelY[lanes];
+    int triangleIds[lanes];
+    float rgb[3][lanes];
+    int count = 0;
+    const auto flush = [&]() {
+        shade(pixelX, pixelY, triangleIds, count, rgb[0]);
+        for (int lane = 0; lane < count; ++lane) {
+            const auto line = reinterpret_cast<QRgb *>(bits + qptrdiff(pixelY[lane]) * bytesPerLine);
+            line[pixelX[lane]] = qRgb(toByte(rgb[0][lane]), toByte(rgb[1][lane]), toByte(rgb[2][lane]));
+        }
+        count = 0;
+    };
+    for (int y = tileY; y <= lastY; ++y) {
+        const auto line = reinterpret_cast<QRgb *>(bits + qptrdiff(y) * bytesPerLine);
+        const auto row = ids + (y - tileY) * TileSize - tileX;
+        for (int x = tileX; x <= lastX; ++x) {
+            if (row[x] < 0) {
+                line[x] = clearColor;
+                continue;
+            }
+            pixelX[count] = x;
+            pixelY[count] = y;
+            triangleIds[count] = row[x];
+            if (++count == lanes)
+                flush();
+        }
+    }
+    if (count)
+        flush();
+}
+
+void SoftRasterizer::resolveVisibility(const Triangle &triangle, int triangleId, int x0, int y0, int x1, int y1,
+                                       int tileX, int tileY, float *depth, int *ids) const noexcept
+{
+    int rowValues[3];
+    int stepsX[3];
+    int stepsY[3];
+    if (!setupEdges(triangle, x0, y0, x1, y1, rowValues, stepsX, stepsY))
+        return;
+
+    for (int y = y0; y <= y1; ++y) {
+        const auto fy = float(y) + 0.5f - triangle.originY;
+        int values[] = {rowValues[0], rowValues[1], rowValues[2]};
+        for (int x = x0; x <= x1; ++x) {
+            if ((values[0] | values[1] | values[2]) >= 0) {
+                const auto fx = float(x) + 0.5f - triangle.originX;
+                const auto z = triangle.z0 + triangle.dzdx * fx + triangle.dzdy * fy;
+                const auto index = (y - tileY) * TileSize + (x - tileX);
+                if (z < depth[index]) {
+                    depth[index] = z;
+                    ids[index] = triangleId;
+                }
+            }
+            for (int edge = 0; edge < 3; ++edge)
+                values[edge] += stepsX[edge];
+        }
+        for (int edge = 0; edge < 3; ++edge)
+            rowValues[edge] += stepsY[edge];
+    }
+}
+
+#ifdef SOFTRASTERIZER_AVX2
+SOFTRASTERIZER_AVX2_TARGET
+void SoftRasterizer::resolveVisibilityAvx2(const Triangle &triangle, int triangleId, int x0, int y0, int x1, int y1,
+                                           int tileX, int tileY, float *depth, int *ids) const noexcept
+{
+    int rowValues[3];
+    int stepsX[3];
+    int stepsY[3];
+    if (!setupEdges(triangle, x0, y0, x1, y1, rowValues, stepsX, stepsY))
+        return;
+
+    const auto laneIndices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i laneSteps[3];
+    __m256i blockSteps[3];
+    for (int edge = 0; edge < 3; ++edge) {
+        laneSteps[edge] = _mm256_mullo_epi32(laneIndices, _mm256_set1_epi32(stepsX[edge]));
+        blockSteps[edge] = _mm256_set1_epi32(stepsX[edge] * lanes);
+    }
+    const auto half = _mm256_set1_ps(0.5f);
+    const auto originX = _mm256_set1_ps(triangle.originX);
+    const auto z0 = _mm256_set1_ps(triangle.z0);
+    const auto dzdx = _mm256_set1_ps(triangle.dzdx);
+    const auto dzdy = _mm256_set1_ps(triangle.dzdy);
+    const auto id = _mm256_set1_epi32(triangleId);
+    const auto minusOne = _mm256_set1_epi32(-1);
+
+    for (int y = y0; y <= y1; ++y) {
+        const auto fy = _mm256_set1_ps(float(y) + 0.5f - triangle.originY);
+        __m256i values[3];
+        for (int edge = 0; edge < 3; ++edge)
+            values[edge] = _mm256_add_epi32(_mm256_set1_epi32(rowValues[edge]), laneSteps[edge]);
+        const auto offset = (y - tileY) * TileSize - tileX;
+        for (int x = x0; x <= x1; x += lanes) {
+            const auto inRow = _mm256_cmpgt_epi32(_mm256_set1_epi32(x1 - x + 1), laneIndices);
+            const auto signs = _mm256_or_si256(_mm256_or_si256(values[0], values[1]), values[2]);
+            const auto covered = _mm256_and_si256(inRow, _mm256_cmpgt_epi32(signs, minusOne));
+            if (!_mm256_testz_si256(covered, covered)) {
+                const auto xs = _mm256_add_epi32(_mm256_set1_epi32(x), laneIndices);
+                const auto fx = _mm256_sub_ps(_mm256_add_ps(_mm256_cvtepi32_ps(xs), half), originX);
+                const auto z = _mm256_add_ps(_mm256_add_ps(z0, _mm256_mul_ps(dzdx, fx)), _mm256_mul_ps(dzdy, fy));
+                const auto oldDepth = _mm256_maskload_ps(depth + offset + x, inRow);
+                const auto mask = _mm256_and_si256(covered, _mm256_castps_si256(_mm256_cmp_ps(z, oldDepth, _CMP_LT_OQ)));
+                _mm256_maskstore_ps(depth + offset + x, mask, z);
+                _mm256_maskstore_epi32(ids + offset + x, mask, id);
+            }
+            for (int edge = 0; edge < 3; ++edge)
+                values[edge] = _mm256_add_epi32(values[edge], blockSteps[edge]);
+        }
+        for (int edge = 0; edge < 3; ++edge)
+            rowValues[edge] += stepsY[edge];
+    }
+}
+#endif
+
+void SoftRasterizer::shade(const int *pixelX, const int *pixelY, const int *triangleIds, int count, float *rgb) const
+{
+    Fragments fragments;
+    const MaterialData *materials[lanes];
+
+    // perspective correct attributes, then the material
+    for (int lane = 0; lane < count; ++lane) {
+        const auto &triangle = m_triangles[size_t(triangleIds[lane])];
+        const auto fx = float(pixelX[lane]) + 0.5f - triangle.originX;
+        const auto fy = float(pixelY[lane]) + 0.5f - triangle.originY;
+        const auto l1 = triangle.l1dx * fx + triangle.l1dy * fy;
+        const auto l2 = triangle.l2dx * fx + triangle.l2dy * fy;
+        float weights[] = {(1.0f - l1 - l2) * triangle.inverseW[0], l1 * triangle.inverseW[1],
+                           l2 * triangle.inverseW[2]};
+        const auto sum = weights[0] + weights[1] + weights[2];
+        for (auto &weight: weights)
+            weight /= sum;
+        float attributes[vertexFloats];
+        for (int k = 0; k < vertexFloats; ++k) {
+            attributes[k] = weights[0] * triangle.attributes[0][k] + weights[1] * triangle.attributes[1][k]
+                    + weights[2] * triangle.attributes[2][k];
+        }
+
+        float normal[] = {attributes[3], attributes[4], attributes[5]};
+        normalize(normal);
+        float viewDir[] = {m_viewPos.x() - attributes[0], m_viewPos.y() - attributes[1], m_viewPos.z() - attributes[2]};
+        normalize(viewDir);
+
+        const auto &material = m_materials[size_t(triangle.material)];
+        materials[lane] = &material;
+        float diffuse[3];
+        float specular[3];
+        material.diffuse.sample(attributes[6], attributes[7], diffuse);
+        material.specular.sample(attributes[6], attributes[7], specular);
+        for (int c = 0; c < 3; ++c) {
+            fragments.position[c][lane] = attributes[c];
+            fragments.normal[c][lane] = normal[c];
+            fragments.viewDir[c][lane] = viewDir[c];
+            fragments.diffuse[c][lane] = diffuse[c];
+            fragments.specular[c][lane] = specular[c];
+            fragments.result[c][lane] = 0.0f;
+        }
+        fragments.shininess[lane] = material.shininess;
+    }
+
+    // CalcDirLight, CalcPointLight and CalcSpotLight of fshader.glsl
+    for (const auto &light: m_lights.directional) {
+        float lightDir[] = {-light.direction.x(), -light.direction.y(), -light.direction.z()};
+        normalize(lightDir);
+        for (int lane = 0; lane < count; ++lane) {
+            float diff, spec;
+            phong(fragments, lane, lightDir, diff, spec);
+            accumulate(fragments, lane, light.ambient, light.diffuse, light.specular, diff, spec, 1.0f);
+        }
+    }
+    for (const auto &light: m_lights.point) {
+        for (int lane = 0; lane < count; ++lane) {
+            float lightDir[3];
+            for (int c = 0; c < 3; ++c)
+                lightDir[c] = light.position[c] - fragments.position[c][lane];
+            const auto distance = std::sqrt(dot(lightDir, lightDir));
+            normalize(lightDir);
+            const auto attenuation = 1.0f / (light.constant + light.linear * distance
+                                             + light.quadratic * (distance * distance));
+            float diff, spec;
+            phong(fragments, lane, lightDir, diff, spec);
+            accumulate(fragments, lane, light.ambient, light.diffuse, light.specular, diff, spec, attenuation);
+        }
+    }
+    for (const auto &light: m_lights.spot) {
+        float spotDir[] = {-light.direction.x(), -light.direction.y(), -light.direction.z()};
+        normalize(spotDir);
+        const auto epsilon = light.cutoff - light.outerCutoff;
+        for (int lane = 0; lane < count; ++lane) {
+            float lightDir[3];
+            for (int c = 0; c < 3; ++c)
+                lightDir[c] = light.position[c] - fragments.position[c][lane];
+            normalize(lightDir);
+            const auto theta = dot(lightDir, spotDir);
+            float diff = 0.0f;
+            float spec = 0.0f;
+            float intensity = 0.0f;
+            if (theta > light.outerCutoff) {
+                phong(fragments, lane, lightDir, diff, spec);
+                intensity = std::min(std::max((theta - light.outerCutoff) / epsilon, 0.0f), 1.0f);
+            }
+            // only the diffuse and specular terms fade at the edge
+            accumulate(fragments, lane, light.ambient, {}, {}, 0.0f, 0.0f, 1.0f);
+            accumulate(fragments, lane, {}, light.diffuse, light.specular, diff, spec, intensity);
+        }
+    }
+
+    for (int lane = 0; lane < count; ++lane) {
+        const auto &material = *materials[lane];
+        for (int c = 0; c < 3; ++c)
+            rgb[c * lanes + lane] = material.flat ? material.color[c] : fragments.result[c][lane];
+    }
+}
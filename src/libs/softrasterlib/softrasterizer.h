@@ -0,0 +1,209 @@
+#ifndef SOFTRASTERIZER_H
+#define SOFTRASTERIZER_H
+
+#include <QtGui/QImage>
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QVector3D>
+#include <QtGui/QVector4D>
+
+#include <QtCore/QSize>
+#include <QtCore/QStringList>
+#include <QtCore/QThreadPool>
+
+#include <cstdint>
+#include <vector>
+
+// CPU renderer of the lighting examples for machines without a GPU, also the reference for
+// golden images. Meshes use the examples' vertex layout (position, normal, texture coordinates,
+// 8 floats per vertex, a triangle list) and are shaded like fshader.glsl of 6.multiple_lights:
+// Phong with diffuse and specular maps and any number of directional, point and spot lights,
+// or a flat color like the lamps.
+// render() transforms and clips the queued triangles, bins them into TileSize x TileSize screen
+// tiles and renders the tiles on "--threads <count>" threads (the ideal thread count by
+// default, the calling thread is one of them). A tile first resolves visibility with the depth
+// test, 8 pixels at a time with AVX2 when the CPU has it ("--no-simd" forces the scalar code),
+// then shades every covered pixel once, 8 pixels at a time. Coverage uses fixed point edge
+// functions and a pixel is only written by the thread of its tile, in submission order, so the
+// image doesn't depend on the thread count or the instruction set.
+class SoftRasterizer
+{
+    Q_DISABLE_COPY(SoftRasterizer)
+public:
+    enum class Instructions {
+        Scalar,
+        Avx2
+    };
+
+    static constexpr int TileSize = 64;
+    // keeps the edge functions of a tile in 32 bits
+    static constexpr int MaxSize = 4096;
+
+    // Defaults are the examples' light colors
+    struct DirectionalLight
+    {
+        QVector3D direction {0.0f, -1.0f, 0.0f};
+        QVector3D ambient {0.2f, 0.2f, 0.2f};
+        QVector3D diffuse {0.5f, 0.5f, 0.5f};
+        QVector3D specular {1.0f, 1.0f, 1.0f};
+    };
+
+    struct PointLight
+    {
+        QVector3D position;
+        QVector3D ambient {0.2f, 0.2f, 0.2f};
+        QVector3D diffuse {0.5f, 0.5f, 0.5f};
+        QVector3D specular {1.0f, 1.0f, 1.0f};
+        float constant {1.0f};
+        float linear {0.09f};
+        float quadratic {0.032f};
+    };
+
+    // Not attenuated, like the examples' spot lights
+    struct SpotLight
+    {
+        QVector3D position;
+        QVector3D direction {0.0f, 0.0f, -1.0f};
+        float cutoff {0.976296f};
+        float outerCutoff {0.953717f};
+        QVector3D ambient {0.2f, 0.2f, 0.2f};
+        QVector3D diffuse {0.5f, 0.5f, 0.5f};
+        QVector3D specular {1.0f, 1.0f, 1.0f};
+    };
+
+    struct Lights
+    {
+        std::vector<DirectionalLight> directional;
+        std::vector<PointLight> point;
+        std::vector<SpotLight> spot;
+    };
+
+    // The images as stored in the files, they are sampled like the examples' textures loaded
+    // with TextureLoader::Mirrored (bilinear, repeated, without mipmaps). A material without
+    // a diffuse map is drawn with the flat color.
+    struct Material
+    {
+        QImage diffuse;
+        QImage specular;
+        float shininess {32.0f};
+        QVector3D color {1.0f, 1.0f, 1.0f};
+    };
+
+    explicit SoftRasterizer(const QStringList &arguments);
+    ~SoftRasterizer();
+
+    static Instructions bestInstructions() noexcept;
+    Instructions instructions() const noexcept { return m_instructions; }
+    // Falls back to the best supported instructions
+    void setInstructions(Instructions instructions) noexcept;
+
+    int threadCount() const noexcept { return m_threadCount; }
+    void setThreadCount(int count);
+
+    QSize size() const noexcept { return m_size; }
+    // Clamped to MaxSize
+    void resize(const QSize &size);
+
+    void setClearColor(const QVector3D &color) noexcept { m_clearColor = color; }
+    void setCamera(const QMatrix4x4 &view, const QMatrix4x4 &projection, const QVector3D &position);
+    void setLights(const Lights &lights) { m_lights = lights; }
+
+    // Converts the textures once, returns the id to pass to draw()
+    int addMaterial(const Material &material);
+
+    // Queues vertexCount vertices as a triangle list for every model, the vertices must stay
+    // valid until render()
+    void draw(const float *vertices, int vertexCount, const std::vector<QMatrix4x4> &models, int material);
+
+    // Renders and clears the queued draws
+    QImage render();
+
+private:
+    struct Texture
+    {
+        int width {0};
+        int height {0};
+        std::vector<float> texels; // rgb rows, bottom row first
+
+        void load(const QImage &image);
+        void sample(float u, float v, float *rgb) const noexcept;
+    };
+
+    struct MaterialData
+    {
+        Texture diffuse;
+        Texture specular;
+        float shininess {32.0f};
+        QVector3D color;
+        bool flat {false};
+    };
+
+    struct Draw
+    {
+        const float *vertices {nullptr};
+        int vertexCount {0};
+        std::vector<QMatrix4x4> models;
+        int material {0};
+    };
+
+    struct Vertex
+    {
+        QVector4D clip;
+        float attributes[8]; // world position, world normal, texture coordinates
+    };
+
+    // A clipped screen space triangle
+    struct Triangle
+    {
+        // pixel bounds, inclusive
+        int minX, minY, maxX, maxY;
+        // edge i covers a pixel center p when a*p.x + b*p.y + c >= 0, the ownership bias
+        // (top-left rule) is folded into c
+        int a[3];
+        int b[3];
+        std::int64_t c[3];
+        // window depth and screen space barycentrics of vertices 1 and 2 as planes relative
+        // to vertex 0 in pixels
+        float originX, originY;
+        float z0, dzdx, dzdy;
+        float l1dx, l1dy, l2dx, l2dy;
+        float inverseW[3];
+        float attributes[3][8];
+        int material;
+    };
+
+    template<typename Function>
+    void parallelFor(int tasks, Function function);
+
+    void processGeometry(const Draw &draw, int firstInstance, int lastInstance,
+                         std::vector<Triangle> &triangles) const;
+    void setupTriangle(const Vertex &v0, const Vertex &v1, const Vertex &v2, int material,
+                       std::vector<Triangle> &triangles) const;
+    void rasterizeTile(int tile, float *depth, int *ids, uchar *bits, int bytesPerLine) const;
+    void resolveVisibility(const Triangle &triangle, int triangleId, int x0, int y0, int x1, int y1,
+                           int tileX, int tileY, float *depth, int *ids) const noexcept;
+    void resolveVisibilityAvx2(const Triangle &triangle, int triangleId, int x0, int y0, int x1, int y1,
+                               int tileX, int tileY, float *depth, int *ids) const noexcept;
+    void shade(const int *pixelX, const int *pixelY, const int *triangleIds, int count, float *rgb) const;
+
+private:
+    Instructions m_instructions {bestInstructions()};
+    int m_threadCount {1};
+    QThreadPool m_pool;
+
+    QSize m_size {640, 480};
+    QVector3D m_clearColor {0.1f, 0.1f, 0.1f};
+    QMatrix4x4 m_viewProjection;
+    QVector3D m_viewPos;
+    Lights m_lights;
+
+    std::vector<MaterialData> m_materials;
+    std::vector<Draw> m_draws;
+
+    std::vector<std::vector<Triangle>> m_taskTriangles;
+    std::vector<Triangle> m_triangles;
+    std::vector<std::vector<int>> m_bins;
+    int m_tilesX {0};
+    int m_tilesY {0};
+};
+
+#endif // SOFTRASTERIZER_H
@@ -0,0 +1,187 @@
+#include "streambuffer.h"
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions_3_3_Core>
+
+#include <QtCore/QDebug>
+#include <QtCore/QLoggingCategory>
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+Q_LOGGING_CATEGORY(lcStreamBuffer, "learnopengl.streambuffer", QtInfoMsg)
+
+namespace {
+
+using BufferStorage = void (QOPENGLF_APIENTRYP)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+
+constexpr GLuint64 waitTimeoutNsecs = 1000 * 1000 * 1000;
+
+int alignUp(int value, int alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+BufferStorage bufferStorage(QOpenGLContext *context)
+{
+    const auto version = context->format().version();
+    if (version < qMakePair(4, 4) && !context->hasExtension(QByteArrayLiteral("GL_ARB_buffer_storage")))
+        return nullptr;
+    return reinterpret_cast<BufferStorage>(context->getProcAddress("glBufferStorage"));
+}
+
+} // namespace
+
+StreamBuffer::StreamBuffer(const QStringList &arguments)
+{
+    m_persistentAllowed = !arguments.contains(QStringLiteral("--no-persistent-map"));
+}
+
+StreamBuffer::~StreamBuffer() = default;
+
+void StreamBuffer::create(QOpenGLFunctions_3_3_Core *funcs, int frameBytes, int writesPerFrame)
+{
+    m_funcs = funcs;
+
+    GLint alignment = 0;
+    m_funcs->glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    m_alignment = std::max(1, alignment);
+    m_regionBytes = alignUp(frameBytes + writesPerFrame * (m_alignment - 1), m_alignment);
+    const auto size = GLsizeiptr(m_regionBytes) * FrameCount;
+
+    m_funcs->glGenBuffers(1, &m_buffer);
+    m_funcs->glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+
+    const auto storage = m_persistentAllowed ? bufferStorage(QOpenGLContext::currentContext()) : nullptr;
+    if (storage) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        storage(GL_UNIFORM_BUFFER, size, nullptr, flags);
+        m_mapped = static_cast<char *>(m_funcs->glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags));
+        m_persistent = m_mapped != nullptr;
+        if (!m_persistent) {
+            // immutable storage can't be reallocated, start over with a mutable buffer
+            qWarning() << "Can't map the stream buffer persistently";
+            m_funcs->glDeleteBuffers(1, &m_buffer);
+            m_funcs->glGenBuffers(1, &m_buffer);
+            m_funcs->glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+        }
+    }
+    if (!m_persistent) {
+        m_funcs->glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        m_staging.resize(size_t(m_regionBytes));
+    }
+    m_funcs->glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // the first beginFrame() moves to region 0
+    m_frame = FrameCount - 1;
+
+    qCDebug(lcStreamBuffer) << "Stream buffer:" << int(FrameCount) << "x" << m_regionBytes << "bytes,"
+                            << (m_persistent ? "persistent mapping" : "unsynchronized mapping");
+}
+
+void StreamBuffer::destroy()
+{
+    if (!m_funcs)
+        return;
+
+    for (auto &fence: m_fences) {
+        if (fence)
+            m_funcs->glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (m_persistent) {
+        m_funcs->glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+        m_funcs->glUnmapBuffer(GL_UNIFORM_BUFFER);
+        m_funcs->glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    m_funcs->glDeleteBuffers(1, &m_buffer);
+
+    qCDebug(lcStreamBuffer) << "Stream buffer: waited for the GPU" << m_waitCount << "times";
+
+    m_buffer = 0;
+    m_mapped = nullptr;
+    m_persistent = false;
+    m_funcs = nullptr;
+}
+
+void StreamBuffer::beginFrame()
+{
+    m_frame = (m_frame + 1) % FrameCount;
+    m_head = 0;
+    m_flushed = 0;
+
+    auto &fence = m_fences[size_t(m_frame)];
+    if (!fence)
+        return;
+
+    // the region was last used FrameCount frames ago, usually the GPU is done with it
+    auto status = m_funcs->glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        ++m_waitCount;
+        do {
+            status = m_funcs->glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, waitTimeoutNsecs);
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    if (status == GL_WAIT_FAILED)
+        qWarning() << "Can't wait for the stream buffer's fence";
+
+    m_funcs->glDeleteSync(fence);
+    fence = nullptr;
+}
+
+GLintptr StreamBuffer::write(const void *data, int size)
+{
+    const auto offset = alignUp(m_head, m_alignment);
+    if (offset + size > m_regionBytes) {
+        qWarning() << "Stream buffer region is full," << size << "bytes don't fit";
+        return -1;
+    }
+
+    const auto regionOffset = m_frame * m_regionBytes;
+    if (m_persistent)
+        std::memcpy(m_mapped + regionOffset + offset, data, size_t(size));
+    else
+        std::memcpy(m_staging.data() + offset, data, size_t(size));
+    m_head = offset + size;
+    return regionOffset + offset;
+}
+
+void StreamBuffer::flush()
+{
+    // coherent writes are visible without any calls
+    if (m_persistent || m_flushed == m_head)
+        return;
+
+    // the fence guarantees the GPU is done with the range, so the driver needn't wait or copy
+    const auto size = m_head - m_flushed;
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    m_funcs->glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    const auto pointer = m_funcs->glMapBufferRange(GL_COPY_WRITE_BUFFER, m_frame * m_regionBytes + m_flushed,
+                                                   size, flags);
+    if (pointer) {
+        std::memcpy(pointer, m_staging.data() + m_flushed, size_t(size));
+        m_funcs->glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    } else {
+        qWarning() << "Can't map the stream buffer";
+    }
+    m_funcs->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    m_flushed = m_head;
+}
+
+void StreamBuffer::endFrame()
+{
+    Q_ASSERT_X(m_persistent || m_flushed == m_head, "StreamBuffer", "flush() wasn't called after write()");
+    m_fences[size_t(m_frame)] = m_funcs->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void StreamBuffer::bindRange(GLuint bindingPoint, GLintptr offset, int size)
+{
+    m_funcs->glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, m_buffer, offset, size);
+}
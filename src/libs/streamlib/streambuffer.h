@@ -0,0 +1,75 @@
+#ifndef STREAMBUFFER_H
+#define STREAMBUFFER_H
+
+#include <QtGui/qopengl.h>
+
+#include <QtCore/QStringList>
+
+#include <array>
+#include <vector>
+
+class QOpenGLFunctions_3_3_Core;
+
+// Uniform buffer for data that changes every frame, split into FrameCount regions used in turn.
+// With GL 4.4 or GL_ARB_buffer_storage the buffer is mapped once, persistently and coherently,
+// and write() copies straight into it; otherwise the writes are staged and flush() copies them
+// with a single unsynchronized glMapBufferRange per frame ("--no-persistent-map" forces this).
+// beginFrame() waits for the fence of the region it reuses, so the driver neither copies nor
+// synchronizes the buffer, and waitCount() tells how often the CPU actually had to wait.
+class StreamBuffer
+{
+    Q_DISABLE_COPY(StreamBuffer)
+public:
+    static constexpr int FrameCount = 3;
+
+    explicit StreamBuffer(const QStringList &arguments);
+    ~StreamBuffer();
+
+    // frameBytes is the total size of at most writesPerFrame writes, the padding of every write
+    // to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT is added here
+    void create(QOpenGLFunctions_3_3_Core *funcs, int frameBytes, int writesPerFrame);
+    void destroy();
+
+    bool isPersistent() const noexcept { return m_persistent; }
+    GLuint bufferId() const noexcept { return m_buffer; }
+    int waitCount() const noexcept { return m_waitCount; }
+
+    void beginFrame();
+    // Returns the offset of the data in bufferId() or -1 when the frame's region is full
+    GLintptr write(const void *data, int size);
+    // Writes the block and binds it to the uniform block binding point
+    template<typename Block>
+    GLintptr bind(GLuint bindingPoint, const Block &block);
+    // Makes the writes visible to the following draw calls
+    void flush();
+    void endFrame();
+
+private:
+    void bindRange(GLuint bindingPoint, GLintptr offset, int size);
+
+private:
+    QOpenGLFunctions_3_3_Core *m_funcs {nullptr};
+    bool m_persistentAllowed {true};
+    bool m_persistent {false};
+    GLuint m_buffer {0};
+    char *m_mapped {nullptr};
+    std::vector<char> m_staging;
+    int m_alignment {256};
+    int m_regionBytes {0};
+    int m_frame {0};
+    int m_head {0};
+    int m_flushed {0};
+    std::array<GLsync, FrameCount> m_fences {};
+    int m_waitCount {0};
+};
+
+template<typename Block>
+GLintptr StreamBuffer::bind(GLuint bindingPoint, const Block &block)
+{
+    const auto offset = write(&block, int(sizeof(Block)));
+    if (offset >= 0)
+        bindRange(bindingPoint, offset, int(sizeof(Block)));
+    return offset;
+}
+
+#endif // STREAMBUFFER_H
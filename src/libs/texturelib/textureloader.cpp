@@ -0,0 +1,267 @@
+#include "textureloader.h"
+
+#include <ktxfile.h>
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLTexture>
+
+#include <QtGui/QWindow>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QMutexLocker>
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+Q_LOGGING_CATEGORY(lcTexture, "learnopengl.texture", QtInfoMsg)
+
+TextureLoader::TextureLoader(QWindow *window) :
+    m_window(window),
+    m_waitForImages(QCoreApplication::arguments().contains(QStringLiteral("--golden")))
+{
+}
+
+TextureLoader::~TextureLoader()
+{
+    m_pool.waitForDone();
+}
+
+QOpenGLTexture *TextureLoader::load(const QString &fileName, Options options, QRgb placeholder)
+{
+    KtxFile file;
+    if (file.open(KtxFile::bakedFileName(fileName))) {
+        const bool flipped = file.orientation() == KtxFile::Orientation::Up;
+        if (flipped != bool(options & Mirrored)) {
+            qWarning() << "Baked texture for" << fileName << "has the wrong orientation, decoding the image";
+        } else if (const auto texture = loadBaked(fileName, file)) {
+            return texture;
+        }
+    }
+
+    QImage placeholderImage(1, 1, QImage::Format_RGBA8888);
+    placeholderImage.setPixel(0, 0, placeholder);
+
+    Entry entry;
+    entry.fileName = fileName;
+    entry.options = options;
+    entry.texture = std::make_unique<QOpenGLTexture>(placeholderImage, QOpenGLTexture::DontGenerateMipMaps);
+    entry.timer.start();
+
+    const auto index = m_entries.size();
+    const auto texture = entry.texture.get();
+    m_entries.push_back(std::move(entry));
+    ++m_pending;
+
+    // the image is only decoded here, it's mirrored while it's written into the buffer
+    m_pool.start([this, index, fileName]() {
+        QImage image(fileName);
+        {
+            QMutexLocker locker(&m_mutex);
+            m_decoded.push_back({index, image});
+        }
+        requestUpdate();
+    });
+
+    return texture;
+}
+
+bool TextureLoader::update(QOpenGLFunctions_3_3_Core *funcs)
+{
+    bool changed = false;
+    do {
+        if (m_waitForImages)
+            m_pool.waitForDone();
+
+        std::vector<Written> written;
+        {
+            QMutexLocker locker(&m_mutex);
+            written.swap(m_written);
+            m_waiting.insert(m_waiting.end(), m_decoded.begin(), m_decoded.end());
+            m_decoded.clear();
+        }
+
+        // the written buffers are uploaded first, so their slots are free for the waiting images
+        for (const auto &item: written)
+            upload(funcs, item);
+        changed = changed || !written.empty();
+
+        auto waiting = m_waiting.begin();
+        for (; waiting != m_waiting.end(); ++waiting) {
+            if (waiting->image.isNull()) {
+                qWarning() << "Can't load texture" << m_entries[waiting->entry].fileName;
+                --m_pending;
+                continue;
+            }
+            if (!write(funcs, *waiting))
+                break;
+            changed = true;
+        }
+        m_waiting.erase(m_waiting.begin(), waiting);
+    } while (m_waitForImages && m_pending > 0);
+    return changed;
+}
+
+void TextureLoader::destroy()
+{
+    m_pool.waitForDone();
+    for (auto &entry: m_entries)
+        entry.texture->destroy();
+    for (auto &slot: m_slots)
+        slot.buffer.destroy();
+}
+
+QOpenGLTexture *TextureLoader::loadBaked(const QString &fileName, const KtxFile &file)
+{
+    const auto context = QOpenGLContext::currentContext();
+    if (file.format() == KtxFile::Format::BC1
+            && !context->hasExtension(QByteArrayLiteral("GL_EXT_texture_compression_s3tc"))) {
+        qWarning() << "BC1 textures are not supported, decoding" << fileName;
+        return nullptr;
+    }
+
+    Entry entry;
+    entry.fileName = fileName;
+    entry.texture = std::make_unique<QOpenGLTexture>(QOpenGLTexture::Target2D);
+    entry.timer.start();
+
+    const auto texture = entry.texture.get();
+    texture->create();
+    texture->bind();
+
+    // the levels are passed straight from the mapped file, the driver is the only one copying them
+    const auto funcs = context->functions();
+    funcs->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (int i = 0; i < file.levelCount(); ++i) {
+        const auto level = file.level(i);
+        if (file.format() == KtxFile::Format::BC1) {
+            funcs->glCompressedTexImage2D(GL_TEXTURE_2D, i, GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+                                          level.width, level.height, 0, GLsizei(level.size), level.data);
+        } else {
+            funcs->glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, level.width, level.height, 0,
+                                GL_RGBA, GL_UNSIGNED_BYTE, level.data);
+        }
+    }
+    funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, file.levelCount() - 1);
+    texture->release();
+
+    qCDebug(lcTexture).noquote() << QStringLiteral("Texture %1 (%2x%3, %4 levels) baked, ready after %5 ms")
+                                 .arg(fileName).arg(file.width()).arg(file.height()).arg(file.levelCount())
+                                 .arg(entry.timer.elapsed());
+
+    m_entries.push_back(std::move(entry));
+    return texture;
+}
+
+bool TextureLoader::write(QOpenGLFunctions_3_3_Core *funcs, const Decoded &decoded)
+{
+    const auto slot = std::find_if(m_slots.begin(), m_slots.end(), [](const Slot &slot) { return !slot.busy; });
+    if (slot == m_slots.end())
+        return false;
+
+    // the worker writes RGBA8888 rows, 4-byte aligned without padding
+    const auto size = decoded.image.size();
+    const auto bytes = size.width() * size.height() * 4;
+    auto &buffer = slot->buffer;
+    if (!buffer.isCreated()) {
+        buffer.create();
+        buffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    }
+    buffer.bind();
+    if (slot->capacity < bytes) {
+        buffer.allocate(bytes);
+        slot->capacity = bytes;
+    }
+    // invalidating orphans the storage an earlier upload may still read from, so this doesn't wait
+    const auto data = static_cast<uchar *>(buffer.mapRange(0, bytes, QOpenGLBuffer::RangeWrite
+                                                           | QOpenGLBuffer::RangeInvalidateBuffer));
+    buffer.release();
+    const auto mirrored = bool(m_entries[decoded.entry].options & Mirrored);
+    if (!data) {
+        qWarning() << "Can't map the pixel unpack buffer, uploading" << m_entries[decoded.entry].fileName
+                   << "from memory";
+        auto &entry = m_entries[decoded.entry];
+        auto image = decoded.image.convertToFormat(QImage::Format_RGBA8888);
+        if (mirrored)
+            image = image.mirrored();
+        createStorage(entry, image.size());
+        upload(funcs, entry, image.size(), image.constBits());
+        return true;
+    }
+    slot->busy = true;
+
+    const auto index = int(slot - m_slots.begin());
+    m_pool.start([this, entry = decoded.entry, index, image = decoded.image, data, mirrored]() {
+        const auto converted = image.convertToFormat(QImage::Format_RGBA8888);
+        const auto height = converted.height();
+        const auto lineBytes = size_t(converted.width()) * 4;
+        for (int y = 0; y < height; ++y) {
+            const auto source = converted.constScanLine(mirrored ? height - 1 - y : y);
+            std::memcpy(data + size_t(y) * lineBytes, source, lineBytes);
+        }
+        {
+            QMutexLocker locker(&m_mutex);
+            m_written.push_back({entry, index, converted.size()});
+        }
+        requestUpdate();
+    });
+    return true;
+}
+
+void TextureLoader::upload(QOpenGLFunctions_3_3_Core *funcs, const Written &written)
+{
+    auto &entry = m_entries[written.entry];
+    auto &slot = m_slots[size_t(written.slot)];
+
+    // allocated before the buffer is bound, so the allocation doesn't read from it
+    createStorage(entry, written.size);
+    slot.buffer.bind();
+    if (!slot.buffer.unmap())
+        qWarning() << "The pixel unpack buffer of" << entry.fileName << "was corrupted";
+    // with the buffer bound glTexSubImage2D copies from it on the GPU, pixels is an offset
+    upload(funcs, entry, written.size, nullptr);
+    slot.buffer.release();
+    slot.busy = false;
+}
+
+void TextureLoader::upload(QOpenGLFunctions_3_3_Core *funcs, Entry &entry, const QSize &size, const void *pixels)
+{
+    const auto texture = entry.texture.get();
+    texture->bind();
+    funcs->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    funcs->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    texture->generateMipMaps();
+    texture->release();
+    --m_pending;
+
+    qCDebug(lcTexture).noquote() << QStringLiteral("Texture %1 (%2x%3) ready after %4 ms")
+                                 .arg(entry.fileName).arg(size.width()).arg(size.height())
+                                 .arg(entry.timer.elapsed());
+}
+
+void TextureLoader::createStorage(Entry &entry, const QSize &size)
+{
+    const auto texture = entry.texture.get();
+
+    // the placeholder's storage is immutable, so the texture gets a new GL object of the real size
+    texture->destroy();
+    texture->create();
+    texture->setSize(size.width(), size.height());
+    texture->setFormat(QOpenGLTexture::RGBA8_UNorm);
+    texture->setMipLevels(texture->maximumMipLevels());
+    texture->allocateStorage(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8);
+}
+
+void TextureLoader::requestUpdate()
+{
+    QMetaObject::invokeMethod(this, [this]() {
+        if (m_window)
+            m_window->requestUpdate();
+    }, Qt::QueuedConnection);
+}
@@ -0,0 +1,117 @@
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+
+#include <QOpenGLBuffer>
+
+#include <QtGui/QImage>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QThreadPool>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+class KtxFile;
+class QOpenGLFunctions_3_3_Core;
+class QOpenGLTexture;
+class QWindow;
+
+// Loads textures without blocking the GUI thread: load() returns a 1x1 placeholder texture
+// right away and decodes the image on a thread pool, so several textures decode in parallel.
+// update() must be called with the context current (e.g. at the start of paintGL()): it maps
+// a free buffer of a ring of pixel unpack buffers for every decoded image, a worker converts
+// (and mirrors) the rows straight into the mapping, and a later update() unmaps the buffer and
+// copies it into the texture on the GPU. The real image gets a new GL texture object, so the
+// returned QOpenGLTexture stays the same but its textureId() changes; don't keep the id across
+// frames. The window is asked for a new frame when an image is decoded or written. With "--golden"
+// (see GoldenImage) update() waits for the pending images instead, so the first frame already has
+// the textures.
+// When a baked KTX2 copy of the image exists (see KtxFile::bakedFileName()), it is mapped and
+// uploaded right away with its mip chain, nothing is decoded.
+class TextureLoader : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(TextureLoader)
+public:
+    enum Option {
+        NoOptions = 0x0,
+        Mirrored = 0x1
+    };
+    Q_DECLARE_FLAGS(Options, Option)
+
+    explicit TextureLoader(QWindow *window);
+    TextureLoader(TextureLoader &&) = delete;
+    ~TextureLoader() override;
+
+    TextureLoader &operator=(TextureLoader &&) = delete;
+
+    // The returned texture is owned by the loader
+    QOpenGLTexture *load(const QString &fileName, Options options = NoOptions,
+                         QRgb placeholder = qRgb(128, 128, 128));
+    // Returns true if a buffer was mapped or a texture uploaded, the texture and buffer bindings
+    // have changed then
+    bool update(QOpenGLFunctions_3_3_Core *funcs);
+    void destroy();
+
+    bool isLoading() const noexcept { return m_pending > 0; }
+
+private:
+    static constexpr int PboRingSize = 3;
+
+    struct Entry
+    {
+        QString fileName;
+        Options options;
+        std::unique_ptr<QOpenGLTexture> texture;
+        QElapsedTimer timer;
+    };
+
+    struct Decoded
+    {
+        size_t entry {0};
+        QImage image;
+    };
+
+    // an image written into a mapped buffer of the ring
+    struct Written
+    {
+        size_t entry {0};
+        int slot {0};
+        QSize size;
+    };
+
+    struct Slot
+    {
+        QOpenGLBuffer buffer {QOpenGLBuffer::PixelUnpackBuffer};
+        int capacity {0};
+        bool busy {false};
+    };
+
+    QOpenGLTexture *loadBaked(const QString &fileName, const KtxFile &file);
+    bool write(QOpenGLFunctions_3_3_Core *funcs, const Decoded &decoded);
+    void upload(QOpenGLFunctions_3_3_Core *funcs, const Written &written);
+    void upload(QOpenGLFunctions_3_3_Core *funcs, Entry &entry, const QSize &size, const void *pixels);
+    void createStorage(Entry &entry, const QSize &size);
+    void requestUpdate();
+
+private:
+    QWindow *m_window {nullptr};
+    bool m_waitForImages {false};
+    std::vector<Entry> m_entries;
+    int m_pending {0};
+    std::array<Slot, PboRingSize> m_slots;
+    // decoded images waiting for a free buffer, only used on the GUI thread
+    std::vector<Decoded> m_waiting;
+
+    QMutex m_mutex;
+    std::vector<Decoded> m_decoded;
+    std::vector<Written> m_written;
+    QThreadPool m_pool;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(TextureLoader::Options)
+
+#endif // TEXTURELOADER_H
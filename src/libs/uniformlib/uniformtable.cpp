@@ -0,0 +1,50 @@
+#include "uniformtable.h"
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+
+#include <QtCore/QDebug>
+
+#include <algorithm>
+#include <vector>
+
+bool UniformTable::resolve(QOpenGLShaderProgram *program)
+{
+    m_locations.clear();
+
+    const auto context = QOpenGLContext::currentContext();
+    if (!program || !program->isLinked() || !context) {
+        qWarning() << "Can't resolve uniforms of a program that is not linked";
+        return false;
+    }
+
+    const auto funcs = context->functions();
+    const auto programId = program->programId();
+
+    GLint count = 0;
+    GLint maxLength = 0;
+    funcs->glGetProgramiv(programId, GL_ACTIVE_UNIFORMS, &count);
+    funcs->glGetProgramiv(programId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::vector<char> buffer(size_t(std::max(maxLength, 1)));
+    m_locations.reserve(count);
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        funcs->glGetActiveUniform(programId, GLuint(i), maxLength, &length, &size, &type, buffer.data());
+
+        const auto name = QByteArray(buffer.data(), length);
+        // members of uniform blocks are active too, but have no location
+        const auto location = funcs->glGetUniformLocation(programId, name.constData());
+        if (location == -1)
+            continue;
+
+        m_locations.insert(name, location);
+        if (name.endsWith("[0]"))
+            m_locations.insert(name.left(name.size() - 3), location);
+    }
+
+    return true;
+}
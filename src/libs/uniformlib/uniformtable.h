@@ -0,0 +1,62 @@
+#ifndef UNIFORMTABLE_H
+#define UNIFORMTABLE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+
+#include <array>
+
+class QOpenGLShaderProgram;
+
+// Locations of all active uniforms of a linked program, queried once with glGetActiveUniform.
+// Array uniforms are available both as "name[0]" and "name".
+class UniformTable
+{
+public:
+    UniformTable() = default;
+
+    bool resolve(QOpenGLShaderProgram *program);
+
+    int location(const QByteArray &name) const { return m_locations.value(name, -1); }
+    int count() const noexcept { return m_locations.size(); }
+
+private:
+    QHash<QByteArray, int> m_locations;
+};
+
+// Maps the Key enum to uniform locations, Key must end with a Count enumerator.
+// Use the locations with QOpenGLShaderProgram::setUniformValue(int location, ...) in paintGL
+// instead of the string overloads which call glGetUniformLocation every time.
+template<typename Key>
+class UniformLocations
+{
+public:
+    static constexpr int Count = int(Key::Count);
+    using Names = std::array<const char *, Count>;
+
+    UniformLocations() { m_locations.fill(-1); }
+
+    bool resolve(QOpenGLShaderProgram *program, const Names &names)
+    {
+        UniformTable table;
+        if (!table.resolve(program))
+            return false;
+
+        bool ok = true;
+        for (int i = 0; i < Count; ++i) {
+            m_locations[i] = table.location(names[i]);
+            if (m_locations[i] == -1) {
+                qWarning("Uniform \"%s\" is not active", names[i]);
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    int operator[](Key key) const noexcept { return m_locations[int(key)]; }
+
+private:
+    std::array<int, Count> m_locations;
+};
+
+#endif // UNIFORMTABLE_H
@@ -0,0 +1,111 @@
+#include <cubefield.h>
+#include <examplescene.h>
+#include <goldenimage.h>
+#include <softrasterizer.h>
+
+#include <QtGui/QImage>
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+
+#include <algorithm>
+
+// Renders the first frame of a lighting example (see ExampleScene) with SoftRasterizer, e.g. for
+// reference images on machines without a GPU, and optionally checks it against a reference with
+// GoldenImage.
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Renders a lighting example on the CPU"));
+    parser.addHelpOption();
+    const QCommandLineOption exampleOption(QStringLiteral("example"),
+                                           QStringLiteral("5.1.direct_light, 5.2.point_light, 5.3.spot_light "
+                                                          "or 6.multiple_lights (default)"),
+                                           QStringLiteral("name"), QStringLiteral("6.multiple_lights"));
+    const QCommandLineOption sizeOption(QStringLiteral("size"), QStringLiteral("Image size, 640x480 by default"),
+                                        QStringLiteral("WxH"), QStringLiteral("640x480"));
+    const QCommandLineOption framesOption(QStringLiteral("frames"),
+                                          QStringLiteral("Render <count> times and print the average time"),
+                                          QStringLiteral("count"), QStringLiteral("1"));
+    parser.addOption(exampleOption);
+    parser.addOption(sizeOption);
+    parser.addOption(framesOption);
+    // read by CubeField and SoftRasterizer
+    parser.addOption({QStringLiteral("cubes"), QStringLiteral("Number of cubes, 10 by default"),
+                      QStringLiteral("count")});
+    parser.addOption({QStringLiteral("threads"), QStringLiteral("Number of threads, the ideal count by default"),
+                      QStringLiteral("count")});
+    parser.addOption({QStringLiteral("no-simd"), QStringLiteral("Resolve visibility without AVX2")});
+    // read by GoldenImage
+    parser.addOption({QStringLiteral("golden"), QStringLiteral("Compare the image with a reference"),
+                      QStringLiteral("file")});
+    parser.addOption({QStringLiteral("golden-update"), QStringLiteral("Write the image as the reference")});
+    parser.addOption({QStringLiteral("golden-threshold"),
+                      QStringLiteral("Max difference of a channel of matching pixels, 8 by default"),
+                      QStringLiteral("value")});
+    parser.addOption({QStringLiteral("golden-ssim"), QStringLiteral("Min SSIM of matching images, 0.98 by default"),
+                      QStringLiteral("value")});
+    parser.addPositionalArgument(QStringLiteral("output"), QStringLiteral("Image file"), QStringLiteral("[output]"));
+    parser.process(app);
+
+    const GoldenImage golden(app.arguments());
+    const auto arguments = parser.positionalArguments();
+    if (arguments.size() > 1 || (arguments.isEmpty() && !golden.isEnabled()))
+        parser.showHelp(1);
+
+    const auto name = parser.value(exampleOption);
+    ExampleScene::Example example;
+    if (!ExampleScene::fromName(name, &example)) {
+        qCritical() << "Unknown example" << name;
+        return 1;
+    }
+
+    const auto sizeParts = parser.value(sizeOption).split(QLatin1Char('x'));
+    const QSize size(sizeParts.value(0).toInt(), sizeParts.value(1).toInt());
+    if (size.isEmpty()) {
+        qCritical() << "Invalid size" << parser.value(sizeOption);
+        return 1;
+    }
+    const auto frames = std::max(1, parser.value(framesOption).toInt());
+
+    SoftRasterizer rasterizer(app.arguments());
+    rasterizer.resize(size);
+
+    ExampleScene scene(example);
+    if (!scene.setup(&rasterizer))
+        return 1;
+
+    const CubeField cubeField(app.arguments());
+
+    QImage image;
+    QElapsedTimer timer;
+    timer.start();
+    for (int frame = 0; frame < frames; ++frame) {
+        scene.draw(&rasterizer, cubeField.models());
+        image = rasterizer.render();
+    }
+    const auto elapsed = timer.nsecsElapsed();
+
+    qDebug().noquote() << QStringLiteral("%1, %2x%3, %4 cubes, threads: %5, avx2: %6, %7 ms per frame")
+                          .arg(name)
+                          .arg(rasterizer.size().width())
+                          .arg(rasterizer.size().height())
+                          .arg(cubeField.count())
+                          .arg(rasterizer.threadCount())
+                          .arg(rasterizer.instructions() == SoftRasterizer::Instructions::Avx2
+                               ? QStringLiteral("yes") : QStringLiteral("no"))
+                          .arg(double(elapsed) / 1e6 / frames, 0, 'f', 2);
+
+    if (!arguments.isEmpty() && !image.save(arguments.at(0))) {
+        qCritical() << "Can't write" << arguments.at(0);
+        return 1;
+    }
+    if (golden.isEnabled() && !golden.check(image))
+        return 1;
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include <ktxfile.h>
+
+#include <QtGui/QImage>
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QtEndian>
+
+#include <algorithm>
+#include <array>
+
+// Converts an image into a KTX2 file with the full mip chain, so the examples upload
+// ready-made levels instead of decoding the image and calling glGenerateMipmap at startup.
+
+namespace {
+
+using Color = std::array<int, 3>;
+
+QImage downsample(const QImage &image)
+{
+    const auto width = std::max(image.width() / 2, 1);
+    const auto height = std::max(image.height() / 2, 1);
+    QImage result(width, height, QImage::Format_RGBA8888);
+    for (int y = 0; y < height; ++y) {
+        const auto row0 = image.constScanLine(std::min(2 * y, image.height() - 1));
+        const auto row1 = image.constScanLine(std::min(2 * y + 1, image.height() - 1));
+        auto dst = result.scanLine(y);
+        for (int x = 0; x < width; ++x) {
+            const auto x0 = 4 * std::min(2 * x, image.width() - 1);
+            const auto x1 = 4 * std::min(2 * x + 1, image.width() - 1);
+            for (int c = 0; c < 4; ++c)
+                dst[4 * x + c] = uchar((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+        }
+    }
+    return result;
+}
+
+QByteArray rawData(const QImage &image)
+{
+    QByteArray result;
+    result.reserve(image.width() * image.height() * 4);
+    for (int y = 0; y < image.height(); ++y)
+        result.append(reinterpret_cast<const char *>(image.constScanLine(y)), image.width() * 4);
+    return result;
+}
+
+quint16 pack565(const Color &color)
+{
+    return quint16((color[0] * 31 + 127) / 255 << 11 | (color[1] * 63 + 127) / 255 << 5 | (color[2] * 31 + 127) / 255);
+}
+
+Color unpack565(quint16 value)
+{
+    const auto r = (value >> 11) & 31;
+    const auto g = (value >> 5) & 63;
+    const auto b = value & 31;
+    return {{r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2}};
+}
+
+int distance(const Color &a, const Color &b)
+{
+    int result = 0;
+    for (int c = 0; c < 3; ++c)
+        result += (a[c] - b[c]) * (a[c] - b[c]);
+    return result;
+}
+
+// Endpoints are the corners of the block's color bounding box moved inwards a bit,
+// which is cheap and good enough for the examples' textures.
+void compressBlock(const std::array<Color, 16> &block, uchar *dst)
+{
+    Color min {{255, 255, 255}};
+    Color max {{0, 0, 0}};
+    for (const auto &color: block) {
+        for (int c = 0; c < 3; ++c) {
+            min[c] = std::min(min[c], color[c]);
+            max[c] = std::max(max[c], color[c]);
+        }
+    }
+    for (int c = 0; c < 3; ++c) {
+        const auto inset = (max[c] - min[c]) / 16;
+        min[c] += inset;
+        max[c] -= inset;
+    }
+
+    auto color0 = pack565(max);
+    auto color1 = pack565(min);
+    if (color0 < color1)
+        std::swap(color0, color1);
+
+    quint32 indices = 0;
+    // color0 > color1 selects the 4-color mode, equal endpoints need no indices at all
+    if (color0 != color1) {
+        const auto c0 = unpack565(color0);
+        const auto c1 = unpack565(color1);
+        Color palette[4] = {c0, c1, {}, {}};
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * c0[c] + c1[c]) / 3;
+            palette[3][c] = (c0[c] + 2 * c1[c]) / 3;
+        }
+        for (int i = 0; i < 16; ++i) {
+            quint32 best = 0;
+            for (quint32 p = 1; p < 4; ++p) {
+                if (distance(block[size_t(i)], palette[p]) < distance(block[size_t(i)], palette[best]))
+                    best = p;
+            }
+            indices |= best << (2 * i);
+        }
+    }
+
+    qToLittleEndian(color0, dst);
+    qToLittleEndian(color1, dst + 2);
+    qToLittleEndian(indices, dst + 4);
+}
+
+QByteArray compressBC1(const QImage &image)
+{
+    const auto blocksX = (image.width() + 3) / 4;
+    const auto blocksY = (image.height() + 3) / 4;
+    QByteArray result(blocksX * blocksY * 8, Qt::Uninitialized);
+    auto dst = reinterpret_cast<uchar *>(result.data());
+    for (int by = 0; by < blocksY; ++by) {
+        for (int bx = 0; bx < blocksX; ++bx) {
+            // pixels outside of the image repeat the last row/column
+            std::array<Color, 16> block;
+            for (int i = 0; i < 16; ++i) {
+                const auto x = std::min(bx * 4 + i % 4, image.width() - 1);
+                const auto y = std::min(by * 4 + i / 4, image.height() - 1);
+                const auto pixel = image.constScanLine(y) + 4 * x;
+                block[size_t(i)] = {{pixel[0], pixel[1], pixel[2]}};
+            }
+            compressBlock(block, dst);
+            dst += 8;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Bakes an image into a KTX2 texture with mipmaps"));
+    parser.addHelpOption();
+    parser.addOption({QStringLiteral("flip"),
+                      QStringLiteral("Store the rows bottom to top, as GL expects them")});
+    parser.addOption({QStringLiteral("bc1"),
+                      QStringLiteral("Compress the levels with BC1 (DXT1), the alpha channel is dropped")});
+    parser.addPositionalArgument(QStringLiteral("input"), QStringLiteral("Source image"));
+    parser.addPositionalArgument(QStringLiteral("output"), QStringLiteral("KTX2 file"));
+    parser.process(app);
+
+    const auto arguments = parser.positionalArguments();
+    if (arguments.size() != 2)
+        parser.showHelp(1);
+
+    QImage image(arguments.at(0));
+    if (image.isNull()) {
+        qCritical() << "Can't load image" << arguments.at(0);
+        return 1;
+    }
+    image = image.convertToFormat(QImage::Format_RGBA8888);
+    if (parser.isSet(QStringLiteral("flip")))
+        image = image.mirrored();
+
+    const auto format = parser.isSet(QStringLiteral("bc1")) ? KtxFile::Format::BC1 : KtxFile::Format::RGBA8;
+    const auto orientation = parser.isSet(QStringLiteral("flip")) ? KtxFile::Orientation::Up
+                                                                 : KtxFile::Orientation::Down;
+
+    std::vector<QByteArray> levels;
+    for (auto level = image; ; level = downsample(level)) {
+        levels.push_back(format == KtxFile::Format::BC1 ? compressBC1(level) : rawData(level));
+        if (level.width() == 1 && level.height() == 1)
+            break;
+    }
+
+    QString errorString;
+    if (!KtxFile::write(arguments.at(1), format, orientation, image.width(), image.height(),
+                        levels, &errorString)) {
+        qCritical() << "Can't write" << arguments.at(1) << ":" << errorString;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <cubefield.h>
+#include <examplescene.h>
+#include <imagecomparison.h>
+#include <softrasterizer.h>
+
+#include <QtTest/QtTest>
+
+// Renders the first frame of every example ExampleScene knows with SoftRasterizer and compares
+// it with references/<example>.png, written by "softrender --example <example> <file>". On a
+// mismatch the frame and the diff image are written to the current directory as
+// <example>-actual.png and <example>-diff.png.
+class tst_Golden : public QObject
+{
+    Q_OBJECT
+public:
+    tst_Golden() : m_cubeField(QStringList()) {}
+
+private slots:
+    void render_data();
+    void render();
+
+private:
+    const CubeField m_cubeField;
+};
+
+void tst_Golden::render_data()
+{
+    QTest::addColumn<QString>("name");
+
+    for (const auto &name: ExampleScene::names())
+        QTest::newRow(qPrintable(name)) << name;
+}
+
+void tst_Golden::render()
+{
+    QFETCH(QString, name);
+
+    ExampleScene::Example example;
+    QVERIFY(ExampleScene::fromName(name, &example));
+
+    // softrender's defaults
+    SoftRasterizer rasterizer{QStringList()};
+    rasterizer.resize({640, 480});
+    ExampleScene scene(example);
+    QVERIFY(scene.setup(&rasterizer));
+    scene.draw(&rasterizer, m_cubeField.models());
+    const auto image = rasterizer.render();
+
+    const auto referenceFile = QStringLiteral(REFERENCES_DIR "/%1.png").arg(name);
+    const QImage reference(referenceFile);
+    QVERIFY2(!reference.isNull(), qPrintable(QStringLiteral("Can't load %1").arg(referenceFile)));
+
+    const ImageComparison comparison(image, reference, {});
+    if (!comparison.matches()) {
+        image.save(name + QStringLiteral("-actual.png"));
+        if (!comparison.diffImage().isNull())
+            comparison.diffImage().save(name + QStringLiteral("-diff.png"));
+    }
+    QVERIFY2(comparison.matches(), qPrintable(comparison.summary()));
+}
+
+QTEST_GUILESS_MAIN(tst_Golden)
+
+#include "tst_golden.moc"
@@ -0,0 +1,215 @@
+#include <imagecomparison.h>
+
+#include <QtTest/QtTest>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+constexpr int size = 100;
+
+// 4x4 checkers over a diagonal gradient, so every SSIM window has some structure
+QImage pattern()
+{
+    QImage result(size, size, QImage::Format_RGB32);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            const auto base = (x + y) / 2;
+            const auto checker = ((x / 4) + (y / 4)) % 2 ? 128 : 0;
+            result.setPixel(x, y, qRgb(base + checker, base + checker / 2, 255 - base - checker));
+        }
+    }
+    return result;
+}
+
+// Every channel of every pixel is off by a uniform random value in [-amplitude, amplitude]
+QImage noisy(const QImage &image, int amplitude)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> noise(-amplitude, amplitude);
+    const auto channel = [&](int value) { return qBound(0, value + noise(generator), 255); };
+
+    auto result = image;
+    for (int y = 0; y < result.height(); ++y) {
+        for (int x = 0; x < result.width(); ++x) {
+            const auto pixel = result.pixel(x, y);
+            const auto red = channel(qRed(pixel));
+            const auto green = channel(qGreen(pixel));
+            const auto blue = channel(qBlue(pixel));
+            result.setPixel(x, y, qRgb(red, green, blue));
+        }
+    }
+    return result;
+}
+
+// The first count pixels, row by row, get their red channel off by difference
+QImage changed(const QImage &image, int count, int difference)
+{
+    auto result = image;
+    for (int i = 0; i < count; ++i) {
+        const auto x = i % result.width();
+        const auto y = i / result.width();
+        const auto pixel = result.pixel(x, y);
+        const auto red = qRed(pixel) + difference <= 255 ? qRed(pixel) + difference : qRed(pixel) - difference;
+        result.setPixel(x, y, qRgb(red, qGreen(pixel), qBlue(pixel)));
+    }
+    return result;
+}
+
+} // namespace
+
+class tst_ImageComparison : public QObject
+{
+    Q_OBJECT
+private slots:
+    void identical();
+    void differentSizes();
+    void shifted();
+    void noise_data();
+    void noise();
+    void channelThreshold_data();
+    void channelThreshold();
+    void maxDifferentPixels_data();
+    void maxDifferentPixels();
+    void minSsim();
+};
+
+void tst_ImageComparison::identical()
+{
+    const auto image = pattern();
+    const ImageComparison comparison(image, image, {});
+
+    QVERIFY(comparison.matches());
+    QCOMPARE(comparison.differentPixels(), 0);
+    QCOMPARE(comparison.maxDifference(), 0);
+    QVERIFY(qFuzzyCompare(comparison.ssim(), 1.0));
+    QCOMPARE(comparison.diffImage().size(), image.size());
+    QCOMPARE(comparison.summary(), QStringLiteral("0 pixels differ (max 0), SSIM 1.0000"));
+}
+
+void tst_ImageComparison::differentSizes()
+{
+    const auto image = pattern();
+    const ImageComparison comparison(image, image.copy(0, 0, size - 1, size), {});
+
+    QVERIFY(!comparison.matches());
+    QVERIFY(comparison.diffImage().isNull());
+    QCOMPARE(comparison.summary(), QStringLiteral("image sizes differ"));
+
+    QVERIFY(!ImageComparison(QImage(), QImage(), {}).matches());
+}
+
+void tst_ImageComparison::shifted()
+{
+    const auto image = pattern();
+    // one pixel to the right, the first column repeated
+    QImage shifted(image.size(), image.format());
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x)
+            shifted.setPixel(x, y, image.pixel(std::max(x - 1, 0), y));
+    }
+
+    const ImageComparison comparison(shifted, image, {});
+    QVERIFY(!comparison.matches());
+    // the columns right of the checkers' vertical edges
+    QCOMPARE(comparison.differentPixels(), (size / 4 - 1) * size);
+    QVERIFY(comparison.ssim() < 0.98);
+}
+
+void tst_ImageComparison::noise_data()
+{
+    QTest::addColumn<int>("amplitude");
+    QTest::addColumn<bool>("matches");
+
+    QTest::newRow("driver") << 4 << true;
+    QTest::newRow("at threshold") << 8 << true;
+    QTest::newRow("broken") << 32 << false;
+}
+
+void tst_ImageComparison::noise()
+{
+    QFETCH(int, amplitude);
+    QFETCH(bool, matches);
+
+    const auto image = pattern();
+    const ImageComparison comparison(noisy(image, amplitude), image, {});
+    QCOMPARE(comparison.matches(), matches);
+    QVERIFY(comparison.maxDifference() <= amplitude);
+    if (matches)
+        QCOMPARE(comparison.differentPixels(), 0);
+}
+
+void tst_ImageComparison::channelThreshold_data()
+{
+    QTest::addColumn<int>("difference");
+    QTest::addColumn<int>("differentPixels");
+
+    QTest::newRow("threshold") << 8 << 0;
+    QTest::newRow("threshold + 1") << 9 << size * size;
+}
+
+void tst_ImageComparison::channelThreshold()
+{
+    QFETCH(int, difference);
+    QFETCH(int, differentPixels);
+
+    const auto image = pattern();
+    ImageComparison::Options options;
+    QCOMPARE(options.channelThreshold, 8);
+    const ImageComparison comparison(changed(image, size * size, difference), image, options);
+    QCOMPARE(comparison.maxDifference(), difference);
+    QCOMPARE(comparison.differentPixels(), differentPixels);
+    QCOMPARE(comparison.matches(), differentPixels == 0);
+}
+
+void tst_ImageComparison::maxDifferentPixels_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("matches");
+
+    // 0.1% of 100x100
+    QTest::newRow("max") << 10 << true;
+    QTest::newRow("max + 1") << 11 << false;
+}
+
+void tst_ImageComparison::maxDifferentPixels()
+{
+    QFETCH(int, count);
+    QFETCH(bool, matches);
+
+    const auto image = pattern();
+    ImageComparison::Options options;
+    QCOMPARE(options.maxDifferentPixels, 0.001);
+    // only the pixel count decides
+    options.minSsim = 0.0;
+    const ImageComparison comparison(changed(image, count, 100), image, options);
+    QCOMPARE(comparison.differentPixels(), count);
+    QCOMPARE(comparison.maxDifference(), 100);
+    QCOMPARE(comparison.matches(), matches);
+
+    // the diff image marks exactly the differing pixels
+    const auto &diff = comparison.diffImage();
+    QCOMPARE(diff.pixel(count - 1, 0), qRgb(228, 0, 0));
+    QVERIFY(diff.pixel(count, 0) != qRgb(228, 0, 0));
+}
+
+void tst_ImageComparison::minSsim()
+{
+    const auto image = pattern();
+    const auto actual = noisy(image, 8);
+    ImageComparison::Options options;
+    options.minSsim = 0.0;
+    const auto ssim = ImageComparison(actual, image, options).ssim();
+    QVERIFY(ssim > 0.0 && ssim < 1.0);
+
+    options.minSsim = ssim;
+    QVERIFY(ImageComparison(actual, image, options).matches());
+    options.minSsim = std::nextafter(ssim, 2.0);
+    QVERIFY(!ImageComparison(actual, image, options).matches());
+}
+
+QTEST_GUILESS_MAIN(tst_ImageComparison)
+
+#include "tst_imagecomparison.moc"